@@ -0,0 +1,170 @@
+/*!
+ * A small harness for the microbenchmarks in bench/. Each benchmark is
+ * a function which performs some number of operations; the harness
+ * warms it up, chooses how many times to call it so that a repetition
+ * takes at least Bench_Min_Rep_Seconds, then times Bench_Reps
+ * repetitions. The median and minimum time per operation of each
+ * benchmark are written out as JSON, so that runs from different
+ * commits can be compared (see scripts/bench_compare.py).
+ */
+
+#ifndef __BENCH_H__
+#define __BENCH_H__
+
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <algorithm>
+#include <functional>
+#include <stdexcept>
+#include <cstdlib>
+
+using namespace std;
+
+//! The number of timed repetitions of each benchmark
+#define Bench_Reps 7
+
+//! The shortest time that a repetition should take
+#define Bench_Min_Rep_Seconds 0.05
+
+//! The seed with which every benchmark's inputs are generated
+#define Bench_Seed 4
+
+/*!
+ * Stop the compiler from optimising away the computation of v.
+ */
+template <typename T>
+inline void
+bench_keep (const T& v)
+{
+    asm volatile ("" : : "g"(&v) : "memory");
+}
+
+struct BenchResult
+{
+    string name;
+    //! Operations per call of the benchmark function
+    unsigned long long int ops_per_call;
+    //! Calls per repetition
+    unsigned long long int calls;
+    double median_ns_per_op;
+    double min_ns_per_op;
+};
+
+class BenchRunner
+{
+public:
+    /*!
+     * program names the benchmark program in the output; the config
+     * string describes how it was built (N_Genes etc).
+     */
+    BenchRunner (const string& _program, const string& _config)
+        : program(_program)
+        , config(_config)
+        , reps(Bench_Reps)
+        , min_rep_seconds(Bench_Min_Rep_Seconds)
+    {
+        // For quick checks, e.g. under ctest
+        const char* quick = getenv ("BENCH_QUICK");
+        if (quick && quick[0] != '\0' && quick[0] != '0') {
+            this->reps = 1;
+            this->min_rep_seconds = 0.001;
+        }
+    }
+
+    /*!
+     * Time fn, which performs ops operations per call, and record the
+     * result under name.
+     */
+    void run (const string& name, unsigned long long int ops, function<void()> fn)
+    {
+        // Warm up and calibrate: double the calls until a repetition is long enough
+        unsigned long long int calls = 1;
+        for (;;) {
+            double t = BenchRunner::time (fn, calls);
+            if (t >= this->min_rep_seconds || calls >= (1ULL << 40)) {
+                break;
+            }
+            // Jump most of the way there if the repetition was far too short
+            double scale = (t > 0.0) ? (this->min_rep_seconds / t) : 1024.0;
+            calls *= (scale > 16.0) ? 8 : 2;
+        }
+
+        vector<double> ns;
+        for (unsigned int r = 0; r < this->reps; ++r) {
+            double t = BenchRunner::time (fn, calls);
+            ns.push_back (t * 1e9 / (double)(calls * ops));
+        }
+        sort (ns.begin(), ns.end());
+
+        BenchResult br;
+        br.name = name;
+        br.ops_per_call = ops;
+        br.calls = calls;
+        br.median_ns_per_op = ns[ns.size()/2];
+        br.min_ns_per_op = ns[0];
+        this->results.push_back (br);
+        cerr << this->program << " " << name << ": " << br.median_ns_per_op << " ns/op" << endl;
+    }
+
+    //! Write the results as JSON
+    void write (ostream& os) const
+    {
+        os << "{\n  \"program\": \"" << this->program << "\",\n"
+           << "  \"config\": \"" << this->config << "\",\n"
+           << "  \"seed\": " << Bench_Seed << ",\n"
+           << "  \"reps\": " << this->reps << ",\n"
+           << "  \"results\": [\n";
+        for (size_t i = 0; i < this->results.size(); ++i) {
+            const BenchResult& br = this->results[i];
+            os << "    { \"name\": \"" << br.name << "\""
+               << ", \"ops_per_call\": " << br.ops_per_call
+               << ", \"calls\": " << br.calls
+               << ", \"median_ns_per_op\": " << br.median_ns_per_op
+               << ", \"min_ns_per_op\": " << br.min_ns_per_op << " }"
+               << (i + 1 < this->results.size() ? ",\n" : "\n");
+        }
+        os << "  ]\n}\n";
+    }
+
+    /*!
+     * Write the results to the file named by argv[1] if there is one,
+     * otherwise to stdout. Returns non-zero on failure, for main().
+     */
+    int finish (int argc, char** argv) const
+    {
+        if (argc > 1) {
+            ofstream f (argv[1], ios::out|ios::trunc);
+            if (!f.is_open()) {
+                cerr << "Failed to open " << argv[1] << endl;
+                return 1;
+            }
+            this->write (f);
+        } else {
+            this->write (cout);
+        }
+        return 0;
+    }
+
+private:
+    //! The time, in seconds, for calls calls of fn
+    static double time (function<void()>& fn, unsigned long long int calls)
+    {
+        chrono::steady_clock::time_point t0 = chrono::steady_clock::now();
+        for (unsigned long long int c = 0; c < calls; ++c) {
+            fn();
+        }
+        chrono::steady_clock::time_point t1 = chrono::steady_clock::now();
+        return chrono::duration<double>(t1 - t0).count();
+    }
+
+    string program;
+    string config;
+    unsigned int reps;
+    double min_rep_seconds;
+    vector<BenchResult> results;
+};
+
+#endif // __BENCH_H__
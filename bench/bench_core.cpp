@@ -0,0 +1,121 @@
+/*
+ * Microbenchmarks of the simulator's core operations: development
+ * (compute_next), mutation, random genomes, Hamming distances, basins
+ * of attraction and Quine-McCluskey complexity. Writes JSON to the file
+ * given on the command line, or to stdout.
+ */
+
+#include <iostream>
+#include <sstream>
+#include <vector>
+#include <set>
+#include <array>
+
+using namespace std;
+
+#ifndef N_Genes
+# define N_Genes 5
+#endif
+
+#include "lib.h"
+#include "basins.h"
+#include "quine.h"
+#include "bench.h"
+
+//! The number of genomes that each benchmark cycles through
+#define Bench_Genomes 256
+
+int main (int argc, char** argv)
+{
+    srand (Bench_Seed);
+    rngDataInit (&rd);
+    zigset (&rd, DUMMYARG);
+    rd.seed = Bench_Seed;
+    masks_init();
+    pOn = 0.05;
+
+    stringstream cfg;
+    cfg << "N_Genes=" << N_Genes << " N_Ins=" << N_Ins;
+    BenchRunner br ("bench_core", cfg.str());
+
+    vector<array<genosect_t, N_Genes> > genomes (Bench_Genomes);
+    for (unsigned int g = 0; g < Bench_Genomes; ++g) {
+        random_genome (genomes[g], &rd);
+    }
+    unsigned int gi = 0;
+    const unsigned int nstates = 1 << N_Genes;
+
+    // Develop every state once with each genome in turn
+    br.run ("compute_next", nstates, [&]() {
+        const array<genosect_t, N_Genes>& g = genomes[gi++ % Bench_Genomes];
+        for (unsigned int s = 0; s < nstates; ++s) {
+            state_t st = (state_t)s;
+            compute_next (g, st);
+            bench_keep (st);
+        }
+    });
+
+    br.run ("compute_next_async", nstates, [&]() {
+        const array<genosect_t, N_Genes>& g = genomes[gi++ % Bench_Genomes];
+        for (unsigned int s = 0; s < nstates; ++s) {
+            state_t st = (state_t)s;
+            compute_next_async (g, st);
+            bench_keep (st);
+        }
+    });
+
+    array<genosect_t, N_Genes> m = genomes[0];
+    br.run ("evolve_genome_pOn", 1, [&]() {
+        evolve_genome (m);
+        bench_keep (m);
+    });
+
+    br.run ("evolve_genome_1bit", 1, [&]() {
+        evolve_genome (m, 1);
+        bench_keep (m);
+    });
+
+    br.run ("evolve_genome_8bits", 1, [&]() {
+        evolve_genome (m, 8);
+        bench_keep (m);
+    });
+
+    br.run ("random_genome", 1, [&]() {
+        random_genome (m, &rd);
+        bench_keep (m);
+    });
+
+    br.run ("compute_hamming_state", nstates, [&]() {
+        state_t t = (state_t)(gi++ % nstates);
+        unsigned int h = 0;
+        for (unsigned int s = 0; s < nstates; ++s) {
+            h += compute_hamming ((state_t)s, t);
+        }
+        bench_keep (h);
+    });
+
+    br.run ("compute_hamming_genome", 1, [&]() {
+        unsigned int h = compute_hamming (genomes[gi % Bench_Genomes], genomes[(gi + 1) % Bench_Genomes]);
+        ++gi;
+        bench_keep (h);
+    });
+
+    br.run ("find_basins_of_attraction", 1, [&]() {
+        vector<BasinOfAttraction> basins;
+        find_basins_of_attraction (genomes[gi++ % Bench_Genomes], basins);
+        bench_keep (basins);
+    });
+
+#if Genosect_Words == 1 // Quine takes the truth table as one 64 bit word
+    br.run ("quine_complexity", 1, [&]() {
+        const array<genosect_t, N_Genes>& g = genomes[gi++ % Bench_Genomes];
+        Quine Q(N_Ins);
+        Q.setFunction (static_cast<unsigned long long int>(g[gi % N_Genes]));
+        Q.go();
+        double c = Q.complexity();
+        bench_keep (c);
+    });
+#endif
+
+    return br.finish (argc, argv);
+}
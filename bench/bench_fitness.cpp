@@ -0,0 +1,80 @@
+/*
+ * Microbenchmarks of a fitness function (chosen with USE_FITNESS_N,
+ * as for the simulations): evaluate_fitness(), evaluate_fitness_batch()
+ * for blocks of 8 and 16 genomes (timed per genome) and, for the
+ * fitness functions which have one, evaluate_one(). Writes JSON to the
+ * file given on the command line, or to stdout.
+ */
+
+#include <iostream>
+#include <sstream>
+#include <vector>
+#include <set>
+#include <array>
+
+using namespace std;
+
+#ifndef N_Genes
+# define N_Genes 5
+#endif
+
+#include "lib.h"
+#include "fitness.h"
+#include "bench.h"
+
+//! The number of genomes that each benchmark cycles through
+#define Bench_Genomes 256
+
+int main (int argc, char** argv)
+{
+    srand (Bench_Seed);
+    rngDataInit (&rd);
+    zigset (&rd, DUMMYARG);
+    rd.seed = Bench_Seed;
+    masks_init();
+
+    stringstream prog;
+    prog << "bench_" << FF_NAME;
+    stringstream cfg;
+    cfg << "N_Genes=" << N_Genes << " N_Ins=" << N_Ins;
+    BenchRunner br (prog.str(), cfg.str());
+
+    vector<array<genosect_t, N_Genes> > genomes (Bench_Genomes);
+    for (unsigned int g = 0; g < Bench_Genomes; ++g) {
+        random_genome (genomes[g], &rd);
+    }
+    unsigned int gi = 0;
+
+    br.run ("evaluate_fitness", 1, [&]() {
+        double f = evaluate_fitness (genomes[gi++ % Bench_Genomes]);
+        bench_keep (f);
+    });
+
+    vector<GenomeBlock<8> > blocks8 (Bench_Genomes / 8);
+    vector<GenomeBlock<16> > blocks16 (Bench_Genomes / 16);
+    for (unsigned int g = 0; g < Bench_Genomes; ++g) {
+        blocks8[g / 8].set (g % 8, genomes[g]);
+        blocks16[g / 16].set (g % 16, genomes[g]);
+    }
+    double fb[16];
+    unsigned int bi = 0;
+
+    br.run ("evaluate_fitness_batch8", 8, [&]() {
+        evaluate_fitness_batch (blocks8[bi++ % blocks8.size()], fb);
+        bench_keep (fb[0]);
+    });
+
+    br.run ("evaluate_fitness_batch16", 16, [&]() {
+        evaluate_fitness_batch (blocks16[bi++ % blocks16.size()], fb);
+        bench_keep (fb[0]);
+    });
+
+#if defined USE_FITNESS_4 || defined USE_FITNESS_5 || defined USE_FITNESS_6 || defined USE_FITNESS_7
+    br.run ("evaluate_one", 1, [&]() {
+        double f = evaluate_one (genomes[gi++ % Bench_Genomes], initial_ant, target_ant);
+        bench_keep (f);
+    });
+#endif
+
+    return br.finish (argc, argv);
+}
@@ -0,0 +1,76 @@
+// Time the factorial algorithms against each other, and check that
+// they agree. Usage: benchfac [n [n ...]]
+
+#include <iostream>
+#include <chrono>
+#include <cstdlib>
+#include <vector>
+
+#include "lmp.h"
+#include "xmath.h"
+#include "primeswing.h"
+
+using std::cout;
+using std::endl;
+
+typedef void (*FacFn)(Xint, ulong);
+
+// Xmath::NaiveFactorial only goes up to 20!, so carry on multiplying from there.
+void Naive(Xint res, ulong n)
+{
+    Xmath::NaiveFactorial(res, n < 20 ? n : 20);
+    for (ulong j = 21; j <= n; ++j) { lmp::MulUi(res, res, j); }
+}
+
+// Returns the time taken in seconds to compute n! with f, leaving it in res.
+double Time(FacFn f, Xint res, ulong n)
+{
+    std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+    f(res, n);
+    std::chrono::steady_clock::time_point t1 = std::chrono::steady_clock::now();
+    return std::chrono::duration<double>(t1 - t0).count();
+}
+
+int main(int argc, char** argv)
+{
+    std::vector<ulong> ns;
+    for (int a = 1; a < argc; ++a) { ns.push_back((ulong)atol(argv[a])); }
+    if (ns.empty()) {
+        ns.push_back(1000);
+        ns.push_back(10000);
+        ns.push_back(100000);
+        ns.push_back(1000000);
+    }
+
+    const char* names[] = { "naive", "PrimeSwing::Factorial",
+                            "PrimeSwing::ParallelFactorial", "mpz_fac_ui" };
+    FacFn fns[] = { Naive, PrimeSwing::Factorial, PrimeSwing::ParallelFactorial, lmp::FacUi };
+    const unsigned int nfns = 4;
+
+    int rtn = 0;
+    Xint ref, res;
+    lmp::Init(ref);
+    lmp::Init(res);
+    cout << "n";
+    for (unsigned int f = 0; f < nfns; ++f) { cout << "," << names[f]; }
+    cout << endl;
+    for (size_t i = 0; i < ns.size(); ++i) {
+        cout << ns[i];
+        lmp::FacUi(ref, ns[i]);
+        for (unsigned int f = 0; f < nfns; ++f) {
+            // The naive product is too slow to be worth timing for large n
+            if (f == 0 && ns[i] > 200000) { cout << ",-"; continue; }
+            double t = Time(fns[f], res, ns[i]);
+            cout << "," << t;
+            if (lmp::Cmp(res, ref) != 0) {
+                cout << " (WRONG)";
+                rtn = 1;
+            }
+        }
+        cout << endl;
+    }
+    lmp::Clear(ref);
+    lmp::Clear(res);
+
+    return rtn;
+}
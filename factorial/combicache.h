@@ -0,0 +1,206 @@
+// A memoizing cache of factorials and binomial coefficients, for the
+// combinatorics programs (compute_pnot0, h_m). Exact values are held
+// as Xints and may be read as long doubles (correctly rounded) or as
+// natural logarithms. One cache may be shared between threads.
+
+#ifndef COMBICACHE_H_
+#define COMBICACHE_H_
+
+#include <map>
+#include <utility>
+#include <mutex>
+#include <cfloat>
+#include <math.h>
+#include "lmp.h"
+
+class CombiCache {
+public:
+
+    CombiCache() {}
+
+    ~CombiCache()
+    {
+        for (std::map<ulong, __mpz_struct>::iterator i = this->facs.begin(); i != this->facs.end(); ++i) {
+            mpz_clear(&i->second);
+        }
+        for (std::map<std::pair<ulong, ulong>, __mpz_struct>::iterator i = this->bins.begin();
+             i != this->bins.end(); ++i) {
+            mpz_clear(&i->second);
+        }
+    }
+
+    // Returns n!. The value stays valid for the life of the cache.
+    mpz_srcptr Factorial(ulong n)
+    {
+        std::lock_guard<std::mutex> lock(this->m);
+        return this->factorial(n);
+    }
+
+    // Returns n choose k (0 if k > n). The value stays valid for the
+    // life of the cache.
+    mpz_srcptr Binomial(ulong n, ulong k)
+    {
+        std::lock_guard<std::mutex> lock(this->m);
+        return this->binomial(n, k);
+    }
+
+    // n choose k as a long double. A missing value is computed without
+    // holding the lock, so that threads can fill the cache concurrently.
+    long double BinomialLD(ulong n, ulong k)
+    {
+        std::pair<ulong, ulong> key(n, (k <= n && k > n - k) ? n - k : k);
+        {
+            std::lock_guard<std::mutex> lock(this->m);
+            std::map<std::pair<ulong, ulong>, long double>::iterator i = this->bins_ld.find(key);
+            if (i != this->bins_ld.end()) { return i->second; }
+        }
+        long double b = 0.0L;
+        if (k <= n) {
+            Xint x; lmp::Init(x);
+            mpz_bin_uiui(x, n, key.second);
+            b = CombiCache::ToLongDouble(x);
+            lmp::Clear(x);
+        }
+        std::lock_guard<std::mutex> lock(this->m);
+        this->bins_ld[key] = b;
+        return b;
+    }
+
+    // ln(n!)
+    static long double LogFactorial(ulong n)
+    {
+        return lgammal((long double)n + 1.0L);
+    }
+
+    // ln(n choose k); -infinity if k > n.
+    static long double LogBinomial(ulong n, ulong k)
+    {
+        if (k > n) { return -HUGE_VALL; }
+        return LogFactorial(n) - LogFactorial(k) - LogFactorial(n - k);
+    }
+
+    // Convert x to the nearest long double (ties to even), which is
+    // what reading it back through a stringstream used to give.
+    static long double ToLongDouble(mpz_srcptr x)
+    {
+        int sgn = mpz_sgn(x);
+        if (sgn == 0) { return 0.0L; }
+
+        Xint a; lmp::Init(a);
+        mpz_abs(a, x);
+        const int mant = LDBL_MANT_DIG < 64 ? LDBL_MANT_DIG : 64;
+        size_t bits = mpz_sizeinbase(a, 2);
+        long double r;
+        if (bits <= (size_t)mant) {
+            r = (long double)mpz_get_ui(a);
+        } else {
+            ulong shift = bits - mant;
+            // Round half to even on the bits shifted out
+            bool half = mpz_tstbit(a, shift - 1);
+            bool rest = (mpz_scan1(a, 0) < shift - 1);
+            mpz_tdiv_q_2exp(a, a, shift);
+            if (half && (rest || mpz_odd_p(a))) {
+                mpz_add_ui(a, a, 1);
+            }
+            // The increment may have carried into a new top bit
+            if (mpz_sizeinbase(a, 2) > (size_t)mant) {
+                mpz_tdiv_q_2exp(a, a, 1);
+                ++shift;
+            }
+            r = ldexpl((long double)mpz_get_ui(a), (int)shift);
+        }
+        lmp::Clear(a);
+        return sgn < 0 ? -r : r;
+    }
+
+    // num/den as a long double, accurate even where num and den are
+    // both too large to be long doubles themselves. Both must be positive.
+    static long double Ratio(mpz_srcptr num, mpz_srcptr den)
+    {
+        // Scale so that the integer quotient has 80 or so significant bits
+        slong shift = (slong)mpz_sizeinbase(den, 2) - (slong)mpz_sizeinbase(num, 2) + 80;
+        Xint q; lmp::Init(q);
+        if (shift >= 0) {
+            mpz_mul_2exp(q, num, shift);
+            mpz_tdiv_q(q, q, den);
+        } else {
+            mpz_tdiv_q(q, num, den);
+            shift = 0;
+        }
+        long double r = ldexpl(CombiCache::ToLongDouble(q), -(int)shift);
+        lmp::Clear(q);
+        return r;
+    }
+
+private:
+
+    // The largest gap, from a cached factorial, which is multiplied up
+    // rather than computed afresh.
+    static const ulong FACSTEP = 512;
+
+    mpz_srcptr factorial(ulong n)
+    {
+        std::map<ulong, __mpz_struct>::iterator i = this->facs.find(n);
+        if (i != this->facs.end()) { return &i->second; }
+
+        __mpz_struct& f = this->facs[n];
+        mpz_init(&f);
+
+        // Start from the nearest smaller or larger factorial, if it's close enough
+        std::map<ulong, __mpz_struct>::iterator below = this->facs.find(n);
+        std::map<ulong, __mpz_struct>::iterator above = below;
+        ++above;
+        if (below != this->facs.begin()) {
+            --below;
+            if (n - below->first <= FACSTEP) {
+                mpz_set(&f, &below->second);
+                for (ulong j = below->first + 1; j <= n; ++j) {
+                    mpz_mul_ui(&f, &f, j);
+                }
+                return &f;
+            }
+        }
+        if (above != this->facs.end() && above->first - n <= FACSTEP) {
+            mpz_set(&f, &above->second);
+            for (ulong j = above->first; j > n; --j) {
+                mpz_divexact_ui(&f, &f, j);
+            }
+            return &f;
+        }
+        mpz_fac_ui(&f, n);
+        return &f;
+    }
+
+    mpz_srcptr binomial(ulong n, ulong k)
+    {
+        if (k <= n && k > n - k) { k = n - k; }
+        std::pair<ulong, ulong> key(n, k);
+        std::map<std::pair<ulong, ulong>, __mpz_struct>::iterator i = this->bins.find(key);
+        if (i != this->bins.end()) { return &i->second; }
+
+        __mpz_struct& b = this->bins[key];
+        mpz_init(&b);
+
+        if (k > n) {
+            mpz_set_ui(&b, 0);
+            return &b;
+        }
+        // C(n,k) = C(n,k-1) * (n-k+1) / k, if C(n,k-1) is known
+        std::map<std::pair<ulong, ulong>, __mpz_struct>::iterator prev
+            = (k > 0) ? this->bins.find(std::pair<ulong, ulong>(n, k - 1)) : this->bins.end();
+        if (prev != this->bins.end()) {
+            mpz_mul_ui(&b, &prev->second, n - k + 1);
+            mpz_divexact_ui(&b, &b, k);
+        } else {
+            mpz_bin_uiui(&b, n, k);
+        }
+        return &b;
+    }
+
+    std::mutex m;
+    std::map<ulong, __mpz_struct> facs;
+    std::map<std::pair<ulong, ulong>, __mpz_struct> bins;
+    std::map<std::pair<ulong, ulong>, long double> bins_ld;
+};
+
+#endif // COMBICACHE_H_
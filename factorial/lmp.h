@@ -33,13 +33,25 @@ public:
     static void InitSetUi(Xint res, ulong n) {
         mpz_init_set_ui(res, n);
     }
+    static void Set(Xint res, mpz_srcptr op) {
+        mpz_set(res, op);
+    }
+    static void Add(Xint res, Xint op1, Xint op2) {
+        mpz_add(res, op1, op2);
+    }
+    static void Sub(Xint res, Xint op1, Xint op2) {
+        mpz_sub(res, op1, op2);
+    }
+    static void PowUiUi(Xint res, ulong bas, ulong exp) {
+        mpz_ui_pow_ui(res, bas, exp);
+    }
     static void MulUi(Xint res, Xint op1, ulong op2) {
         mpz_mul_ui(res, op1, op2);
     }
-    static void Mul(Xint res, Xint op1, Xint op2) {
+    static void Mul(Xint res, mpz_srcptr op1, mpz_srcptr op2) {
         mpz_mul(res, op1, op2);
     }
-    static void Div(Xint res, Xint op1, Xint op2) {
+    static void Div(Xint res, mpz_srcptr op1, mpz_srcptr op2) {
         mpz_cdiv_q(res, op1, op2);
     }
     // Assuming that mul detects the special case of squaring.
@@ -59,7 +71,7 @@ public:
     static void ZimmermannFacUi2(mpz_ptr res, ulong n) {
         mpz_fac_ui2 (res, n);
     }
-    static slong Cmp(Xint op1, Xint op2) {
+    static slong Cmp(mpz_srcptr op1, mpz_srcptr op2) {
         return mpz_cmp(op1, op2);
     }
     static void Clear(Xint b) {
@@ -2,19 +2,91 @@
 // Created: 2010-01-15
 // License: LGPL version 2.1 or (at your option)
 // Creative Commons Attribution-ShareAlike 3.0
+//
+// Reworked to run on a thread pool: the swing products are all
+// independent, so each is computed as a balanced product tree whose
+// subtrees are tasks on the pool. The swings are then combined by
+// binary splitting, fact = F(1, iterLen) where
+// F(a, b) = F(a, m)^(2^(b-m)) * F(m, b) and F(i, i+1) = swing(iter[i]).
 
 #include <string.h>
+#include <vector>
 #include "primeswing.h"
 #include "xmath.h"
+#include "threadpool.h"
+
+namespace {
+
+// Products of fewer factors than this are computed in one task.
+const slong PRODUCT_GRAIN = 512;
+
+ThreadPool& FactorialPool()
+{
+    static ThreadPool pool;
+    return pool;
+}
+
+// result = a[start] * ... * a[start+len-1], with the halves of the
+// product tree shared out over the pool.
+void PoolProduct(ThreadPool& pool, mpz_ptr result, const ulong* a, slong start, slong len)
+{
+    if (len < PRODUCT_GRAIN)
+    {
+        if (len == 0) { lmp::SetUi(result, 1); return; }
+        Xmath::Product(result, const_cast<ulong*>(a), start, len);
+        return;
+    }
+
+    slong halfLen = len / 2;
+    Xint temp1; lmp::Init(temp1);
+    mpz_ptr t1 = temp1;
+
+    std::future<void> left = pool.Submit([&pool, t1, a, start, halfLen]() {
+        PoolProduct(pool, t1, a, start, halfLen);
+    });
+    PoolProduct(pool, result, a, start + halfLen, len - halfLen);
+    pool.Wait(left);
+    lmp::Mul(result, result, temp1);
+
+    lmp::Clear(temp1);
+}
+
+// result = F(a, b), the swings a to b-1 combined as in the loop of
+// PrimeSwing::Factorial.
+void CombineSwings(ThreadPool& pool, mpz_ptr result, const std::vector<__mpz_struct>& swings, ulong a, ulong b)
+{
+    if (b - a == 1)
+    {
+        lmp::Set(result, &swings[a]);
+        return;
+    }
+
+    ulong m = a + (b - a) / 2;
+    Xint temp1; lmp::Init(temp1);
+    mpz_ptr t1 = temp1;
+
+    std::future<void> left = pool.Submit([&pool, t1, &swings, a, m]() {
+        CombineSwings(pool, t1, swings, a, m);
+    });
+    CombineSwings(pool, result, swings, m, b);
+    pool.Wait(left);
+
+    mpz_pow_ui(temp1, temp1, 1UL << (b - m));
+    lmp::Mul(result, result, temp1);
+
+    lmp::Clear(temp1);
+}
+
+} // namespace
 
 void PrimeSwing::ParallelFactorial(Xint fact, ulong n)
 {
     if (n < THRESHOLD) { Xmath::NaiveFactorial(fact, n); return; }
-    lmp::SetUi(fact, 1);
+
+    ThreadPool& pool = FactorialPool();
 
     ulong* primes;
     ulong piN = Xmath::PrimeSieve(&primes, n);
-    ulong* factors = lmp::MallocUi(piN);
     ulong iterLen = 0; ulong i = n;
     slong m = n; while (m > 0) { m >>= 1; iterLen++; }
     ulong* iter = lmp::MallocUi(iterLen);
@@ -22,70 +94,70 @@ void PrimeSwing::ParallelFactorial(Xint fact, ulong n)
     m = n; i = iterLen;
     while (m > 0) { iter[--i] = m; m >>= 1; }
 
-    Xint primorial; lmp::Init(primorial);
-    Xint swing; lmp::Init(swing);
-
     lim[0] = 0;
     for (i = 1; i < iterLen; i++)
         lim[i] = iter[i] < SOSLEN / 2 ?  0 :
         GetIndexOf(primes, iter[i], lim[i-1], piN);
 
+    // The prime factors of each swing, then the swings themselves,
+    // all computed at once.
+    std::vector<std::vector<ulong> > factors(iterLen);
+    std::vector<__mpz_struct> swings(iterLen);
+    std::vector<std::future<void> > pending;
     for (i = 1; i < iterLen; i++)
     {
         ulong N = iter[i];
+        mpz_init(&swings[i]);
 
         if (N < SOSLEN)
         {
-            lmp::Pow2(fact, fact);
-            lmp::SetUi(swing, smallOddSwing[N]);
+            lmp::SetUi(&swings[i], smallOddSwing[N]);
+            continue;
         }
-        else
-        {
-            std::thread pow(lmp::Pow2, fact, fact);
 
-            ulong prime = 3;
-            slong pi = 2, fi = 0;
-            ulong max = Xmath::Sqrt(N);
+        std::vector<ulong>& f = factors[i];
+        ulong prime = 3;
+        slong pi = 2;
+        ulong max = Xmath::Sqrt(N);
 
-            while (prime <= max)
+        while (prime <= max)
+        {
+            ulong q = N, p = 1;
+            while ((q /= prime) > 0)
             {
-                ulong q = N, p = 1;
-                while ((q /= prime) > 0)
-                {
-                    if ((q & 1) == 1) { p *= prime; }
-                }
-
-                if (p > 1) { factors[fi++] = p; }
-                prime = primes[pi++];
+                if ((q & 1) == 1) { p *= prime; }
             }
 
-            max = N / 3;
-            while (prime <= max)
+            if (p > 1) { f.push_back(p); }
+            prime = primes[pi++];
+        }
+
+        max = N / 3;
+        while (prime <= max)
+        {
+            if (((N / prime) & 1) == 1)
             {
-                if (((N / prime) & 1) == 1)
-                {
-                    factors[fi++] = prime;
-                }
-                prime = primes[pi++];
+                f.push_back(prime);
             }
-
-            pi = lim[i] - lim[i-1];
-            memcpy(factors + fi, primes + lim[i-1], pi * sizeof(ulong));
-
-            Xmath::Product(swing, factors, 0, fi + pi);
-            pow.join();
+            prime = primes[pi++];
         }
 
-        lmp::Mul(fact, fact, swing);
+        f.insert(f.end(), primes + lim[i-1], primes + lim[i]);
+
+        mpz_ptr s = &swings[i];
+        const ulong* fp = f.data();
+        slong flen = (slong)f.size();
+        pending.push_back(pool.Submit([&pool, s, fp, flen]() {
+            PoolProduct(pool, s, fp, 0, flen);
+        }));
     }
+    for (i = 0; i < pending.size(); i++) { pool.Wait(pending[i]); }
 
+    CombineSwings(pool, fact, swings, 1, iterLen);
     lmp::Mul2Exp(fact, fact, n - Xmath::BitCount(n));
 
-    lmp::Clear(swing);
-    lmp::Clear(primorial);
+    for (i = 1; i < iterLen; i++) { mpz_clear(&swings[i]); }
     lmp::FreeUi(primes, piN);
-    lmp::FreeUi(factors, piN);
     lmp::FreeUi(iter, iterLen);
     lmp::FreeUi(lim, iterLen);
 }
-
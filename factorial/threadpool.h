@@ -0,0 +1,108 @@
+// A small pool of worker threads, for the parallel factorial. Tasks
+// may submit further tasks and wait for them; a thread which waits
+// runs queued tasks in the meantime, so the pool can't deadlock with
+// every worker waiting.
+
+#ifndef THREADPOOL_H_
+#define THREADPOOL_H_
+
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <future>
+#include <functional>
+#include <chrono>
+
+class ThreadPool {
+public:
+
+    // Start nthreads workers; if 0, one per hardware thread.
+    ThreadPool(unsigned int nthreads = 0)
+        : stopping(false)
+    {
+        if (nthreads == 0) { nthreads = std::thread::hardware_concurrency(); }
+        if (nthreads == 0) { nthreads = 1; }
+        for (unsigned int i = 0; i < nthreads; ++i) {
+            this->workers.push_back(std::thread(&ThreadPool::Work, this));
+        }
+    }
+
+    ~ThreadPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(this->m);
+            this->stopping = true;
+        }
+        this->cv.notify_all();
+        for (size_t i = 0; i < this->workers.size(); ++i) {
+            this->workers[i].join();
+        }
+    }
+
+    unsigned int Size() const { return (unsigned int)this->workers.size(); }
+
+    // Queue task to be run by the pool.
+    std::future<void> Submit(std::function<void()> task)
+    {
+        std::packaged_task<void()> pt(task);
+        std::future<void> f = pt.get_future();
+        {
+            std::lock_guard<std::mutex> lock(this->m);
+            this->tasks.push_back(std::move(pt));
+        }
+        this->cv.notify_one();
+        return f;
+    }
+
+    // Wait for f to be ready, running queued tasks meanwhile.
+    void Wait(std::future<void>& f)
+    {
+        while (f.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+            if (!this->RunOne()) {
+                f.wait_for(std::chrono::microseconds(100));
+            }
+        }
+        f.get();
+    }
+
+private:
+
+    // Run one queued task, if there is one. Returns false if not.
+    bool RunOne()
+    {
+        std::packaged_task<void()> pt;
+        {
+            std::lock_guard<std::mutex> lock(this->m);
+            if (this->tasks.empty()) { return false; }
+            pt = std::move(this->tasks.front());
+            this->tasks.pop_front();
+        }
+        pt();
+        return true;
+    }
+
+    void Work()
+    {
+        for (;;) {
+            std::packaged_task<void()> pt;
+            {
+                std::unique_lock<std::mutex> lock(this->m);
+                this->cv.wait(lock, [this] { return this->stopping || !this->tasks.empty(); });
+                if (this->tasks.empty()) { return; } // stopping
+                pt = std::move(this->tasks.front());
+                this->tasks.pop_front();
+            }
+            pt();
+        }
+    }
+
+    std::vector<std::thread> workers;
+    std::deque<std::packaged_task<void()> > tasks;
+    std::mutex m;
+    std::condition_variable cv;
+    bool stopping;
+};
+
+#endif // THREADPOOL_H_
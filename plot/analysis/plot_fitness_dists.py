@@ -7,31 +7,34 @@ import numpy as np
 import matplotlib
 matplotlib.use ('TKAgg', warn=False, force=True)
 import matplotlib.pyplot as plt
-import csv
+import json
 import sys
 sys.path.insert(0,'../include')
 import sebcolour
 col = sebcolour.Colour
-from scipy import stats
 
-# Read csv files with gen/fitness data in
+# Read the summary written by estimate_fitness_dist_ffN
 
 def doPlot (ff, f1):
 
-    D = np.loadtxt('../../data/fitness_dist_{0}_n10000000.csv'.format(ff), delimiter=',')
+    with open('../../data/fitness_dist_{0}_n10000000.json'.format(ff)) as fp:
+        S = json.load(fp)['fitness']
 
-    # Prepare data for the histograms
+    # The log binned histogram of the non-zero fitnesses; F=0 and F=1 are counted exactly
+    H = S['log_histogram']
+    edges = np.array(H['edges'])
+    counts = np.array(H['counts'], dtype=float)
+    centres = np.sqrt(edges[:-1]*edges[1:])
+    nz = counts > 0
+    f1.plot (centres[nz], np.log(counts[nz]))
+    f1.set_xscale ('log')
 
-    bin_means, bin_edges, binnumber = stats.binned_statistic (D[:,0], D[:,1], statistic='mean', bins=100)
-
-    #f1.scatter (D[:,0], np.log(D[:,1]))
-    print(np.size(bin_edges))
-    print(np.size(bin_means))
-    f1.plot (bin_edges[:-1], np.log(bin_means))
+    print ('{0}: {1} genomes, {2} with F=0, {3} with F=1, median {4}'
+           .format(ff, S['n'], S['n_zero'], S['n_one'], S['sketch']['quantiles'][S['sketch']['q'].index(0.5)]))
 
     f1.set_xlabel('Fitness');
     f1.set_ylabel('log(Count)');
-    f1.set_title ('{0}'.format(ff))
+    f1.set_title ('{0} (F=0: {1}, F=1: {2} of {3})'.format(ff, S['n_zero'], S['n_one'], S['n']))
 
 # Font size for plotting
 fs2=14 # for axes tick labels
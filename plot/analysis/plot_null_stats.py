@@ -2,7 +2,7 @@ import numpy as np
 import matplotlib
 matplotlib.use ('TKAgg', warn=False, force=True)
 import matplotlib.pyplot as plt
-import csv
+import json
 import sys
 sys.path.insert(0, '../include')
 import sebcolour
@@ -18,129 +18,59 @@ F1 = plt.figure (figsize=(8,8))
 
 FF_NAME = 'ff4'
 
-# NB: Run plot_null_stats_load.py first to generate nullstats_A.npy
-A = np.load ('nullstats_A' + FF_NAME + '.npy')
-# Could replace above with:
-#A2 = np.loadtxt ('../data/null_withf_a21_p10_'+FF_NAME+'_100000_fitness_0.csv', delimiter=',')
-#print ('shapes: {0}, {1}'.format(np.shape(A), np.shape(A2)))
+# Run ./build/sim_supp/nullmodel_withf to generate the summary
+with open ('../../data/null_withf_a21_p10_'+FF_NAME+'_100000_fitness_0.json') as fp:
+    S = json.load(fp)
 
+nbins = S['linear_bins']
+bin_lo = np.linspace(0, 1.0, nbins+1)[:-1]
+
+# Fitness quantiles in each block of generations
 f1 = F1.add_subplot(2,2,1)
-f1.plot (A[:,0]/10000,A[:,1],marker='o',linestyle='None',linewidth=2,color=col.darkviolet)
+bg = S['block_gens']
+blocks = S['blocks']
+gens = np.arange(len(blocks))*bg/10000
+qs = blocks[0]['sketch']['q']
+for q, colr in [(0.5, col.darkviolet), (0.99, col.maroon1)]:
+    qi = qs.index(q)
+    f1.plot (gens, [b['sketch']['quantiles'][qi] for b in blocks], marker='o', linewidth=2, color=colr, label='q={0}'.format(q))
+f1.plot (gens, [b['max'] for b in blocks], marker='o', linestyle='None', color=col.crimson, label='max')
+f1.legend()
 f1.set_xlabel('10K generations');
 f1.set_ylabel('fitness');
 
-# Num basin vs fitness
-f2 = F1.add_subplot(2,2,2)
-nbins = 34
-X, Y = np.meshgrid(np.linspace(0,32,33), np.linspace(0,1.0,100))
-Z = np.zeros([33,100])
-fitness = A[:,1]
-numcyc = A[:,2]
-for mlc in range (0,33): # mean limit cycle (size)
-    print ('mlc={0}'.format(mlc))
-    print ('fitness: {0}'.format(fitness))
-    # a if condition else b
-    fitsel = fitness[(numcyc >= mlc) & (numcyc < mlc+1)]
-    print ('fitsel.shape(): {0} .size(): {1} Number not 0.5: {2}'
-           .format(np.shape(fitsel), np.size(fitsel), np.size(fitsel[fitsel!=0.5])))
-    print ('FITSEL: {0}'.format(fitsel))
-    bins = np.linspace(0, 1.0, 101)
-    h, b = np.histogram (fitsel, bins)
-    print ('h shape: {0}'.format(np.shape(h)))
-    Z[int(mlc),:] = np.log(h)
-#f2.plot (A[:,2],A[:,1],marker='o',linestyle='None',linewidth=2,color=col.maroon1)
-Z[Z==-np.inf]=0
-f2.contourf(X,Y,Z.T)
-f2.set_ylabel('fitness');
-f2.set_xlabel('Num limit cycles in system');
-f2.set_ylim([0,0.2])
-
-# Mean limit cycle length
-f3 = F1.add_subplot(2,2,3)
-
-nbins = 34
-X, Y = np.meshgrid(np.linspace(0,32,33), np.linspace(0,1.0,100))
-Z = np.zeros([33,100])
-fitness = A[:,1]
-meanlim = A[:,3]
-for mlc in range (0,33): # mean limit cycle (size)
-    print ('mlc={0}'.format(mlc))
-    print ('fitness: {0}'.format(fitness))
-    # a if condition else b
-    fitsel = fitness[(meanlim >= mlc) & (meanlim < mlc+1)]
-    print ('fitsel.shape(): {0} .size(): {1} Number not 0.5: {2}'
-           .format(np.shape(fitsel), np.size(fitsel), np.size(fitsel[fitsel!=0.5])))
-    print ('FITSEL: {0}'.format(fitsel))
-    bins = np.linspace(0, 1.0, 101)
-    h, b = np.histogram (fitsel, bins)
-    print ('h shape: {0}'.format(np.shape(h)))
-    Z[int(mlc),:] = np.log(h)
-#f3.plot (A[:,3],A[:,1],marker='.',markersize=0.5,linestyle='None',linewidth=2,color=col.violetred)
-Z[Z==-np.inf]=0
-f3.contourf(X,Y,Z.T)
-f3.set_ylabel('fitness');
-f3.set_xlabel('Mean limit cycle size');
-f3.set_ylim([0,0.2])
+# Fitness histograms by key (num basins, mean limit cycle size, max limit cycle size)
+def keyedPlot (f, key, xlabel):
+    Z = np.log(np.array(S[key], dtype=float))
+    Z[Z==-np.inf]=0
+    nkeys = np.shape(Z)[0]
+    X, Y = np.meshgrid(np.arange(nkeys), bin_lo)
+    f.contourf(X,Y,Z.T)
+    f.set_ylabel('fitness');
+    f.set_xlabel(xlabel);
+    f.set_ylim([0,0.2])
 
-# Max limit cycle length
-f4 = F1.add_subplot(2,2,4)
-
-nbins = 34
-X, Y = np.meshgrid(np.linspace(0,32,33), np.linspace(0,1.0,100))
-Z = np.zeros([33,100])
-#fitness = A[:,1]
-maxlim = A[:,4]
-for mlc in range (0,33): # mean limit cycle (size)
-    print ('mlc={0}'.format(mlc))
-    print ('fitness: {0}'.format(fitness))
-    # a if condition else b
-    fitsel = fitness[(maxlim >= mlc) & (maxlim < mlc+1)]
-    print ('fitsel.shape(): {0} .size(): {1} Number not 0.5: {2}'
-           .format(np.shape(fitsel), np.size(fitsel), np.size(fitsel[fitsel!=0.5])))
-    print ('FITSEL: {0}'.format(fitsel))
-    bins = np.linspace(0, 1.0, 101)
-    h, b = np.histogram (fitsel, bins)
-    print ('h shape: {0}'.format(np.shape(h)))
-    Z[int(mlc),:] = np.log(h)
-#f4.plot (A[:,4],A[:,1],marker='o',linestyle='None',linewidth=2,color=col.crimson)
-Z[Z==-np.inf]=0
-f4.contourf(X,Y,Z.T)
-f4.set_ylabel('fitness');
-f4.set_xlabel('Max limit cycle size');
-f4.set_ylim([0,0.2])
+keyedPlot (F1.add_subplot(2,2,2), 'by_num_basins', 'Num limit cycles in system')
+keyedPlot (F1.add_subplot(2,2,3), 'by_mean_limit_cycle', 'Mean limit cycle size')
+keyedPlot (F1.add_subplot(2,2,4), 'by_max_limit_cycle', 'Max limit cycle size')
 
 #f1.set_xlim([-1, 0.01])
 F1.tight_layout()
 plt.savefig ('figures/null_model_stats_' + FF_NAME + '.png')
 
 F2 = plt.figure (figsize=(12,8))
-# For each unique value in A[:,2] (number of limit cycles), do a
-# histogram of the fitnesses in A[:,1]
-print ('A col 2 has length {0}'.format(len(A[:,2])))
-lcs = np.unique(A[:,2])
-
-print ('{0} unique values in A[:,2]: {1}'.format(len(lcs), lcs))
+# For each number of limit cycles which occurred, plot the histogram of fitness
+C = np.array(S['by_num_basins'])
+lcs = np.where(C.sum(axis=1) > 0)[0]
+print ('{0} numbers of limit cycles occurred: {1}'.format(len(lcs), lcs))
 a1 = []
 gcount = 0
-nbins = 20
-for lc in lcs:
-    print ('{0}'.format(lc))
-    print ('A shape {0}'.format(np.shape(A)))
-    AA = A[np.where(A[:,2]==lc)]
-    print ('AA shape {0}'.format(np.shape(AA)))
-    D = AA[:,1]
-    print ('D shape {0} max {1} min {2}'.format(np.shape(D), max(D), min(D)))
-    unq, cnts = np.unique(D, return_counts=True)
-    print ('unq: {0}'.format(unq))
-    print ('{0}'.format(D))
-    bins = np.linspace (min(D), max(D), num=nbins)
-    h,b = np.histogram (D, bins)
+for lc in lcs[:10]:
+    h = C[lc,:]
+    nzb = np.where(h > 0)[0]
     ax = F2.add_subplot (2,5,gcount+1)
     a1.append(ax)
-    print (b[:-1])
-    print (h)
-    a1[gcount].plot (b[:-1], h, color='r')
-    #a1[gcount].plot (np.log(unq), np.log(cnts), '.', color='r', marker='o')
+    a1[gcount].plot (bin_lo[nzb[0]:nzb[-1]+1], h[nzb[0]:nzb[-1]+1], color='r')
     a1[gcount].set_title('LC size {0}'.format(lc))
     gcount = gcount + 1
 
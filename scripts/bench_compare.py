@@ -0,0 +1,40 @@
+# Compare two sets of microbenchmark results (the JSON files written
+# by the bench/ programs, e.g. by "make run_bench").
+#
+# Usage: python3 bench_compare.py before_dir after_dir
+#    or: python3 bench_compare.py before.json after.json
+#
+# Prints the median ns per operation of each benchmark in both, and
+# the speedup (before/after).
+import json
+import os
+import sys
+
+def load (path):
+    files = []
+    if os.path.isdir (path):
+        files = [os.path.join (path, f) for f in sorted (os.listdir (path)) if f.endswith ('.json')]
+    else:
+        files = [path]
+    results = {}
+    for f in files:
+        with open (f) as fh:
+            d = json.load (fh)
+        for r in d['results']:
+            key = '{0} [{1}] {2}'.format (d['program'], d['config'], r['name'])
+            results[key] = r['median_ns_per_op']
+    return results
+
+if len(sys.argv) != 3:
+    print ('Usage: python3 {0} before after (JSON files or directories of them)'.format (sys.argv[0]))
+    sys.exit (1)
+
+before = load (sys.argv[1])
+after = load (sys.argv[2])
+print ('{0:<60} {1:>12} {2:>12} {3:>8}'.format ('benchmark', 'before ns', 'after ns', 'speedup'))
+for key in sorted (before):
+    if key in after:
+        b = before[key]
+        a = after[key]
+        speedup = (b / a) if a > 0 else float('inf')
+        print ('{0:<60} {1:>12.2f} {2:>12.2f} {3:>8.2f}'.format (key, b, a, speedup))
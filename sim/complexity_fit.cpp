@@ -1,6 +1,10 @@
 /*
  * Find the proportion of fit genomes which are canalyzing functions.
  *
+ * The genomes are evolved afresh (and saved in the genome archive
+ * ./data/complexity_fit.bng), unless an archive of genomes to analyse
+ * is given on the command line.
+ *
  * Author: S James
  * Date: September 2019.
  */
@@ -29,7 +33,8 @@ using namespace std;
 
 // Common code
 #include "lib.h"
-#include "quine.h"
+#include "functables.h"
+#include "genome_archive.h"
 #include "basins.h"
 
 // The fitness function used here
@@ -57,6 +62,9 @@ int main (int argc, char** argv)
     // Initialise masks
     masks_init();
 
+    // Tabulated (or cached) complexity and canalysingness of each genosect
+    functables.init (FunctionTables::defaultPath());
+
     // To store the results of this program
     map<unsigned int, unsigned int> canalvalues;
     double complexity = 0.0;
@@ -68,6 +76,22 @@ int main (int argc, char** argv)
 
     array<genosect_t, N_Genes > genome;
 
+    // Either read the genomes from an archive or save the evolved ones to one
+    GenomeArchiveReader archive_in;
+    GenomeArchiveWriter archive_out;
+    try {
+        if (argc > 1) {
+            archive_in.open (argv[1]);
+            ntrials = archive_in.size();
+            LOG ("Analysing the " << ntrials << " genomes in " << argv[1]);
+        } else {
+            archive_out.open ("./data/complexity_fit.bng", true);
+        }
+    } catch (const exception& e) {
+        cerr << e.what() << endl;
+        return -1;
+    }
+
     ofstream fout;
     fout.open ("./data/complexity_fit.csv", ios::out|ios::trunc);
     if (!fout.is_open()) {
@@ -80,8 +104,13 @@ int main (int argc, char** argv)
 
     for (unsigned int i = 0; i < ntrials; ++i) {
         //cout << "+" << flush;
-        genome = evolve_new_genome ();
-        random_genome (genome);
+        if (argc > 1) {
+            archive_in.get (i, genome);
+        } else {
+            genome = evolve_new_genome ();
+            random_genome (genome);
+            archive_out.append (genome);
+        }
         unsigned int c = canalyzingness(genome);
         if (c > 0) {
             cout << "." << flush;
@@ -95,14 +124,7 @@ int main (int argc, char** argv)
         // Determine complexity (Quine-McCluskey algorithm)
         double cmplx = 0.0;
         for (unsigned int i = 0; i < N_Genes; ++i) {
-            Quine Q(N_Genes);
-            for (unsigned int j = 0; j<(1<<N_Genes); ++j) {
-                if ((genome[i]>>j)&0x1) {
-                    Q.addMinterm(j);
-                }
-            }
-            Q.go();
-            cmplx += Q.complexity();
+            cmplx += functables.complexity (genome[i]);
         }
         cmplx /= (double)N_Genes; // mean complexity per gene
         complexity += cmplx;
@@ -127,6 +149,7 @@ int main (int argc, char** argv)
     meanAttractorLen /= (double)ntrials;
 
     fout.close();
+    archive_out.close();
 
     // Output results
     cout << "Number of fit genomes tested: " << ntrials << endl;
@@ -36,7 +36,7 @@ using namespace std;
 
 // Common code
 #include "lib.h"
-#include "quine.h"
+#include "functables.h"
 #include "basins.h"
 
 #include <climits>
@@ -54,6 +54,9 @@ int main (int argc, char** argv)
     // Initialise masks
     masks_init();
 
+    // Tabulated (or cached) complexity and canalysingness of each genosect
+    functables.init (FunctionTables::defaultPath());
+
     // Unused, but set, in this program.
     pOn = 0.5;
 
@@ -95,14 +98,7 @@ int main (int argc, char** argv)
         // Determine complexity (Quine-McCluskey algorithm)
         double cmplx = 0.0;
         for (unsigned int i = 0; i < N_Genes; ++i) {
-            Quine Q(N_Genes);
-            for (unsigned int j = 0; j<(1<<N_Genes); ++j) {
-                if ((genome[i]>>j)&0x1) {
-                    Q.addMinterm(j);
-                }
-            }
-            Q.go();
-            cmplx += Q.complexity();
+            cmplx += functables.complexity (genome[i]);
         }
         cmplx /= (double)N_Genes; // mean complexity per gene
         complexity += cmplx;
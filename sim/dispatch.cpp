@@ -0,0 +1,18 @@
+/*
+ * The main() of evolve_onegen, evolve_fit_genome and proprandom, each of
+ * which is compiled once for each network size that it serves (see
+ * dispatch.h and sim/CMakeLists.txt). The number of genes is given by
+ * the first option, -n N (default 5), which is removed before the rest
+ * of the command line is passed on to the compilation for N genes.
+ *
+ * Author: S James
+ * Date: October 2026.
+ */
+
+#include "dispatch.h"
+
+int main (int argc, char** argv)
+{
+    unsigned int nGenes = genes_option (argc, argv, 5);
+    return dispatch_main (nGenes, false, argc, argv);
+}
@@ -2,7 +2,8 @@
  * Evolves genome repeatedly according to the fitness function described in the paper associated
  * with this code.
  *
- * This version of the program takes parameter info from a JSON file.
+ * This version of the program takes parameter info from a JSON file. It is compiled once for each
+ * network size, and evolve_dispatch.cpp runs the compilation for the size given in the JSON.
  *
  * Additionally, this version of the program (will be) is able to evolve towards any number of
  * target state contexts. The original version (including the standalone version) was constrained
@@ -52,12 +53,15 @@ using namespace std;
 
 #ifdef RECORD_ALL_FITNESS
 # include "basins.h"
+# include "genome_archive.h"
 # include <algorithm>
 #endif
 
 // The fitness function used here
 #include "fitness.h"
 
+SIM_NAMESPACE_BEGIN
+
 struct geninfo {
     geninfo (unsigned long long int _gen, unsigned long long int _gen_0, double _fit)
         : gen(_gen)
@@ -71,7 +75,7 @@ struct geninfo {
 
 // Perform a loop N_Generations long during which an initially randomly selected genome is evolved
 // until a maximally fit state is achieved.
-int main (int argc, char** argv)
+int sim_main (int argc, char** argv)
 {
     // Seed the system RNG.
     unsigned int seed = mix(clock(), time(NULL), getpid());
@@ -182,6 +186,12 @@ int main (int argc, char** argv)
     // Should we append data to the given file, rather than overwriting?
     const bool append_data = root.get ("append_data", false).asBool();
 
+#ifdef RECORD_ALL_FITNESS
+    // Whether to also save the genomes of each fitness trace in a genome archive (with the same
+    // name as the trace's .csv file, but .bng), one record per row of the .csv file
+    const bool save_genome_archive = root.get ("save_genome_archive", false).asBool();
+#endif
+
     // Done getting params
     LOG ("pOn: " << pOn);
     LOG ("Initial states:");
@@ -478,6 +488,21 @@ int main (int argc, char** argv)
                 return 1;
             }
 
+            // The Dan string of each genome is written from here
+            char gstr[Genome_Str_Len];
+
+            GenomeArchiveWriter archive;
+            if (save_genome_archive) {
+                string apath = pathss2.str();
+                apath.replace (apath.size() - 4, 4, ".bng");
+                try {
+                    archive.open (apath, !append_data);
+                } catch (const exception& e) {
+                    cerr << e.what() << endl;
+                    return 1;
+                }
+            }
+
             // Output into the file. First we add the "pre-padding" so that all fitness traces
             // stored in this file have the same length.
             if (netinfo[i].back().generation < (unsigned int)maxevol) {
@@ -485,8 +510,11 @@ int main (int argc, char** argv)
                 // Output a dummy point at -maxevol
                 f << -maxevol
                   << "," << netinfo[i][0].fitness
-                  << "," << genome2str(netinfo[i][0].ab.genome)
-                  << "," << netinfo[i][0].ab.getNumBasins()
+                  << ",";
+                genome2chars (netinfo[i][0].ab.genome, gstr);
+                f.write (gstr, Genome_Str_Len);
+                if (save_genome_archive) { archive.append (netinfo[i][0].ab.genome); }
+                f << "," << netinfo[i][0].ab.getNumBasins()
                   << "," << netinfo[i][0].ab.meanAttractorLength()
                   << "," << netinfo[i][0].ab.maxAttractorLength()
                   << "," << netinfo[i][0].numChangedTransitions
@@ -500,8 +528,11 @@ int main (int argc, char** argv)
             for (unsigned int j = 0; j < netinfo[i].size(); ++j) {
                 f << ((long long int)netinfo[i][j].generation - lgen)
                   << "," << netinfo[i][j].fitness
-                  << "," << genome2str(netinfo[i][j].ab.genome)
-                  << "," << netinfo[i][j].ab.getNumBasins()
+                  << ",";
+                genome2chars (netinfo[i][j].ab.genome, gstr);
+                f.write (gstr, Genome_Str_Len);
+                if (save_genome_archive) { archive.append (netinfo[i][j].ab.genome); }
+                f << "," << netinfo[i][j].ab.getNumBasins()
                   << "," << netinfo[i][j].ab.meanAttractorLength()
                   << "," << netinfo[i][j].ab.maxAttractorLength()
                   << "," << netinfo[i][j].numChangedTransitions
@@ -517,3 +548,10 @@ int main (int argc, char** argv)
 
     return 0;
 }
+
+SIM_NAMESPACE_END
+
+#ifndef SIM_NAMESPACE
+// Compiled on its own, for the one network size given by N_Genes
+int main (int argc, char** argv) { return sim_main (argc, argv); }
+#endif
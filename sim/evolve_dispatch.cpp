@@ -0,0 +1,56 @@
+/*
+ * The main() of the evolve program. evolve.cpp is compiled once for each network size that we
+ * study (see dispatch.h and sim/CMakeLists.txt), each compilation fully specialised for its
+ * N_Genes and k. This reads the network size from the JSON config and runs the matching
+ * compilation.
+ *
+ * The number of genes is given by "nGenes" in the config or, failing that, by the length of the
+ * first "initial" state. Set "kEqualsNMinus1": true for the k=n-1 networks.
+ *
+ * Author: S James
+ * Date: October 2026.
+ */
+
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <json/json.h>
+
+#include "dispatch.h"
+
+using namespace std;
+
+int main (int argc, char** argv)
+{
+    if (argc < 2) {
+        cerr << "Usage: " << argv[0] << " /path/to/params.json [pOn]" << endl;
+        cerr << "Networks of 3 to 10 genes with k=n, or of 7 or 8 genes with k=n-1" << endl;
+        return 1;
+    }
+
+    // Read just enough of the config to choose the compilation. The compilation reports
+    // any other problem with the file.
+    ifstream jsonfile (argv[1], ifstream::binary);
+    if (!jsonfile.is_open()) {
+        cerr << "json config file " << argv[1] << " not found." << endl;
+        return 1;
+    }
+    Json::Value root;
+    string errs;
+    Json::CharReaderBuilder rbuilder;
+    rbuilder["collectComments"] = false;
+    if (!Json::parseFromStream (rbuilder, jsonfile, &root, &errs)) {
+        cerr << "Failed to parse JSON: " << errs;
+        return 1;
+    }
+
+    unsigned int nGenes = 5;
+    const Json::Value I = root["initial"];
+    if (I.isArray() && I.size() > 0) {
+        nGenes = I[0].asString().size();
+    }
+    nGenes = root.get ("nGenes", nGenes).asUInt();
+    const bool kEqualsNMinus1 = root.get ("kEqualsNMinus1", false).asBool();
+
+    return dispatch_main (nGenes, kEqualsNMinus1, argc, argv);
+}
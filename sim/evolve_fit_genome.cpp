@@ -1,6 +1,8 @@
 /*
  * Evolve from a random genome into a fit genome once only.
  *
+ * Usage: evolve_fit_genome [-n N] [pOn], N being 5 or 6 (see dispatch.cpp).
+ *
  * Author: S James
  * Date: October 2018.
  */
@@ -35,7 +37,9 @@ using namespace std;
 #include "fitness.h"
 #include "mutation.h"
 
-int main (int argc, char** argv)
+SIM_NAMESPACE_BEGIN
+
+int sim_main (int argc, char** argv)
 {
     // Seed the RNG
 #define PROPERLY_RANDOM_SEED
@@ -76,3 +80,10 @@ int main (int argc, char** argv)
     LOG ("1s and 0s representation: " << genome2str (genome));
     return 0;
 }
+
+SIM_NAMESPACE_END
+
+#ifndef SIM_NAMESPACE
+// Compiled on its own, for the one network size given by N_Genes
+int main (int argc, char** argv) { return sim_main (argc, argv); }
+#endif
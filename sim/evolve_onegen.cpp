@@ -1,6 +1,8 @@
 /*
  * Evolve a genome once. See how many bits flip.
  *
+ * Usage: evolve_onegen [-n N] [pOn], N being 5 or 6 (see dispatch.cpp).
+ *
  * Author: S James
  * Date: October 2018.
  */
@@ -34,7 +36,9 @@ using namespace std;
 // The fitness function used here
 #include "fitness.h"
 
-int main (int argc, char** argv)
+SIM_NAMESPACE_BEGIN
+
+int sim_main (int argc, char** argv)
 {
     // Set the global target states:
     target_ant = 0x15; // 10101 or 21 dec
@@ -82,3 +86,10 @@ int main (int argc, char** argv)
     show_genome (genome);
     return 0;
 }
+
+SIM_NAMESPACE_END
+
+#ifndef SIM_NAMESPACE
+// Compiled on its own, for the one network size given by N_Genes
+int main (int argc, char** argv) { return sim_main (argc, argv); }
+#endif
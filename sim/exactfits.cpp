@@ -0,0 +1,78 @@
+/*
+ * Compute the exact number of genomes with F>0 and with F=1 under
+ * fitness function 4, for k=n, without enumerating the genome
+ * space. See exactcount.h for the method. This gives the exact
+ * versions of the proportions which proprandom -n 5 and -n 6 can
+ * only estimate by sampling.
+ *
+ * For N_Genes <= 4, the number of genomes with each fitness value is
+ * also output, one "numerator,denominator,genomes" line per value.
+ *
+ * This defaults to N_Genes=5, but N_Genes can be defined on the
+ * compiler command line to find the results for other values.
+ *
+ * Author: S James
+ * Date: October 2026.
+ */
+
+#include <iostream>
+#include <vector>
+#include <set>
+#include <stdlib.h>
+#include <sstream>
+#include <string>
+#include <math.h>
+
+using namespace std;
+
+// Number of genes in a state is set at compile time.
+#ifndef N_Genes
+# define N_Genes 5
+#endif
+
+// Common code
+#include "lib.h"
+
+// The fitness function used here
+#include "fitness.h"
+
+#include "lmp.h"
+#include "exactcount.h"
+
+int main (int argc, char** argv)
+{
+    // Initialise masks
+    masks_init();
+
+    Xint numfit, numperfect, ngenomes;
+    lmp::Init (numfit);
+    lmp::Init (numperfect);
+    lmp::Init (ngenomes);
+
+    // There are (2^N_Genes)^(2^N_Genes) genomes
+    lmp::PowUiUi (ngenomes, 1 << N_Genes, 1 << N_Genes);
+
+    exact_fitness_counts (numfit, numperfect);
+
+    cout << ngenomes << "," << numfit << "," << numperfect << endl;
+
+#if N_Genes <= 4
+    FitnessHistogram hist;
+    exact_fitness_histogram (hist);
+    map<pair<unsigned long long int, unsigned long long int>, __mpz_struct>::const_iterator hi;
+    for (hi = hist.counts.begin(); hi != hist.counts.end(); ++hi) {
+        cout << hi->first.first << "," << hi->first.second << "," << &hi->second << endl;
+    }
+#endif
+
+    LOG ("For " << N_Genes << " genes, there are " << numfit << " fit genomes out of " << ngenomes
+         << " of which " << numperfect << " have F=1");
+    LOG ("That's " << mpz_get_d (numfit) / mpz_get_d (ngenomes) << " and "
+         << mpz_get_d (numperfect) / mpz_get_d (ngenomes) << " as proportions.");
+
+    lmp::Clear (numfit);
+    lmp::Clear (numperfect);
+    lmp::Clear (ngenomes);
+
+    return 0;
+}
@@ -8,17 +8,14 @@
 #include <map>
 #include <set>
 #include <vector>
+#include <bitset>
 
 #include "endpoint.h"
+#include "sim_namespace.h"
 
 using namespace std;
 
-/*!
- * When working with states in a graph of nodes, it may be necessary
- * to use one bit to refer to the state as being unset; this is the
- * bit to use. This precludes the use of N_Genes==8.
- */
-#define state_t_unset 0x80
+SIM_NAMESPACE_BEGIN
 
 /*!
  * To make a graph of states, we need a state node object which has
@@ -205,7 +202,8 @@ void
 find_basins_of_attraction (array<genosect_t, N_Genes>& genome,
                            vector<BasinOfAttraction>& basins)
 {
-    for (state_t s = 0; s < (1<<N_Genes); ++s) {
+    // s is an unsigned int, as a state_t can't count past the last state when N_Genes=8
+    for (unsigned int s = 0; s < (1<<N_Genes); ++s) {
 
         // First check if s is in any of the basins we already computed.
         bool s_encountered = false;
@@ -225,8 +223,9 @@ find_basins_of_attraction (array<genosect_t, N_Genes>& genome,
         BasinOfAttraction basin;
         // A copy of starting point s.
         state_t st = s;
-        state_t next_st = state_t_unset;
-        state_t last_st = state_t_unset;
+        state_t next_st = st;
+        state_t last_st = st;
+        bool have_last = false;
 
         unsigned int saw_flags = 0x0;
 
@@ -246,7 +245,7 @@ find_basins_of_attraction (array<genosect_t, N_Genes>& genome,
             // Create state node
             StateNode stnode(st); // node for current state.
             stnode.child = next_st; // Mark the child state
-            if (last_st != state_t_unset) {
+            if (have_last) {
                 stnode.parents.insert (last_st);
             }
 
@@ -291,6 +290,7 @@ find_basins_of_attraction (array<genosect_t, N_Genes>& genome,
 
             // Update last_st and st
             last_st = st;
+            have_last = true;
             st = next_st;
         }
 
@@ -333,11 +333,15 @@ public:
         this->attractorSizes.clear();
         this->transitions.clear();
         find_basins_of_attraction (this->genome, this->basins);
+        this->basinOf.assign (1 << N_Genes, -1);
         vector<BasinOfAttraction>::const_iterator i = this->basins.begin();
         while (i != basins.end()) {
             set<unsigned int> tset = i->getTransitionSet();
             this->transitions.insert(tset.begin(), tset.end());
             this->attractorSizes.push_back(i->limitCycle.size());
+            for (auto& n : i->nodes) {
+                this->basinOf[n.first] = static_cast<int>(i - this->basins.begin());
+            }
             ++i;
         }
     }
@@ -374,19 +378,28 @@ public:
     }
 
     /*!
-     * Return the basin of attraction which contains the state st.
+     * Return the basin of attraction which contains the state st, or an
+     * empty basin (with endpoint ENDPOINT_UNKNOWN) if there is none.
      */
-    BasinOfAttraction find (state_t& st) {
-        for (auto b : this->basins) {
-            try {
-                StateNode sn = b.nodes.at(st);
-                return b;
-            } catch (const std::out_of_range& e) {
-                // st in not in b.
-            }
-        }
-        BasinOfAttraction nullbasin;
-        return nullbasin;
+    const BasinOfAttraction& find (state_t st) const {
+        static const BasinOfAttraction nullbasin;
+        int bi = this->basinIndex (st);
+        return bi < 0 ? nullbasin : this->basins[bi];
+    }
+
+    /*!
+     * The index in basins of the basin which contains the state st, or
+     * -1 if there is none. As basins with the same attractor are
+     * merged, this identifies the attractor that st ends on.
+     */
+    int basinIndex (state_t st) const {
+        return (size_t)st < this->basinOf.size() ? this->basinOf[st] : -1;
+    }
+
+    //! Do the states a and b end on the same attractor?
+    bool sameAttractor (state_t a, state_t b) const {
+        int ba = this->basinIndex (a);
+        return ba >= 0 && ba == this->basinIndex (b);
     }
 
     /*!
@@ -395,8 +408,61 @@ public:
      * genes in each unsigned int; 2*16=32).
      */
     set<unsigned int> transitions;
+
+private:
+    //! For each state, the index in basins of its basin, built by update().
+    vector<int> basinOf;
 };
 
+/*!
+ * Do the trajectories from the states a and b end on the same
+ * attractor? Develops only the states on the two trajectories, without
+ * building any basins: every state on a's trajectory leads to a's
+ * attractor, so b shares it if and only if b's trajectory meets a's
+ * before it repeats itself.
+ */
+bool
+shared_termination (const array<genosect_t, N_Genes>& genome, state_t a, state_t b)
+{
+    bitset<(1 << N_Genes)> on_a;
+    while (!on_a.test (a)) {
+        on_a.set (a);
+        compute_next (genome, a);
+    }
+    bitset<(1 << N_Genes)> on_b;
+    while (!on_a.test (b)) {
+        if (on_b.test (b)) {
+            return false;
+        }
+        on_b.set (b);
+        compute_next (genome, b);
+    }
+    return true;
+}
+
+/*!
+ * shared_termination() for the network with the state transition
+ * table succ (which has 1<<N_Genes entries).
+ */
+bool
+shared_termination_table (const state_t* succ, state_t a, state_t b)
+{
+    bitset<(1 << N_Genes)> on_a;
+    while (!on_a.test (a)) {
+        on_a.set (a);
+        a = succ[a];
+    }
+    bitset<(1 << N_Genes)> on_b;
+    while (!on_a.test (b)) {
+        if (on_b.test (b)) {
+            return false;
+        }
+        on_b.set (b);
+        b = succ[b];
+    }
+    return true;
+}
+
 /*!
  * A class to hold information about one network and its comparison
  * with any other networks.
@@ -426,4 +492,6 @@ public:
     unsigned int numChangedTransitions = 0;
 };
 
+SIM_NAMESPACE_END
+
 #endif // __BASINS_H__
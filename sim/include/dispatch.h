@@ -0,0 +1,141 @@
+/*!
+ * Runs one of the compilations of a program, chosen by network size at
+ * runtime.
+ *
+ * evolve.cpp, evolve_onegen.cpp, evolve_fit_genome.cpp and
+ * proprandomfits.cpp are compiled once for each network size that
+ * they serve, each compilation with its own N_Genes (and
+ * k_equals_n_minus_1) and inside its own namespace (SIM_NAMESPACE, see
+ * sim_namespace.h). The namespaces are n3 to n10 for k=n and n7k6 and
+ * n8k7 for k=n-1, and each holds the program's entry point,
+ * sim_main(). sim/CMakeLists.txt defines SIM_HAVE_<namespace> for each
+ * compilation linked into the program.
+ *
+ * This is included by the program's main() (evolve_dispatch.cpp or
+ * dispatch.cpp), so unlike the other headers here, it is not inside
+ * SIM_NAMESPACE.
+ */
+
+#ifndef __DISPATCH_H__
+#define __DISPATCH_H__
+
+#include <iostream>
+#include <cstdlib>
+#include <cstring>
+
+using namespace std;
+
+#ifdef SIM_HAVE_n3
+namespace n3 { int sim_main (int argc, char** argv); }
+#endif
+#ifdef SIM_HAVE_n4
+namespace n4 { int sim_main (int argc, char** argv); }
+#endif
+#ifdef SIM_HAVE_n5
+namespace n5 { int sim_main (int argc, char** argv); }
+#endif
+#ifdef SIM_HAVE_n6
+namespace n6 { int sim_main (int argc, char** argv); }
+#endif
+#ifdef SIM_HAVE_n7
+namespace n7 { int sim_main (int argc, char** argv); }
+#endif
+#ifdef SIM_HAVE_n8
+namespace n8 { int sim_main (int argc, char** argv); }
+#endif
+#ifdef SIM_HAVE_n9
+namespace n9 { int sim_main (int argc, char** argv); }
+#endif
+#ifdef SIM_HAVE_n10
+namespace n10 { int sim_main (int argc, char** argv); }
+#endif
+#ifdef SIM_HAVE_n7k6
+namespace n7k6 { int sim_main (int argc, char** argv); }
+#endif
+#ifdef SIM_HAVE_n8k7
+namespace n8k7 { int sim_main (int argc, char** argv); }
+#endif
+
+/*!
+ * Run the compilation for networks of nGenes genes with k=n (or k=n-1
+ * if kEqualsNMinus1), passing on argc and argv, and return what it
+ * returns. Returns 1 if the program has no compilation for that size.
+ */
+int
+dispatch_main (unsigned int nGenes, bool kEqualsNMinus1, int argc, char** argv)
+{
+    int (*entry)(int, char**) = 0;
+    if (kEqualsNMinus1) {
+        switch (nGenes) {
+#ifdef SIM_HAVE_n7k6
+        case 7: entry = n7k6::sim_main; break;
+#endif
+#ifdef SIM_HAVE_n8k7
+        case 8: entry = n8k7::sim_main; break;
+#endif
+        default: break;
+        }
+    } else {
+        switch (nGenes) {
+#ifdef SIM_HAVE_n3
+        case 3: entry = n3::sim_main; break;
+#endif
+#ifdef SIM_HAVE_n4
+        case 4: entry = n4::sim_main; break;
+#endif
+#ifdef SIM_HAVE_n5
+        case 5: entry = n5::sim_main; break;
+#endif
+#ifdef SIM_HAVE_n6
+        case 6: entry = n6::sim_main; break;
+#endif
+#ifdef SIM_HAVE_n7
+        case 7: entry = n7::sim_main; break;
+#endif
+#ifdef SIM_HAVE_n8
+        case 8: entry = n8::sim_main; break;
+#endif
+#ifdef SIM_HAVE_n9
+        case 9: entry = n9::sim_main; break;
+#endif
+#ifdef SIM_HAVE_n10
+        case 10: entry = n10::sim_main; break;
+#endif
+        default: break;
+        }
+    }
+
+    if (entry == 0) {
+        cerr << argv[0] << " has no compilation for networks of " << nGenes << " genes with k="
+             << (kEqualsNMinus1 ? "n-1" : "n") << endl;
+        return 1;
+    }
+    return entry (argc, argv);
+}
+
+/*!
+ * If the first argument is the option "-n N", remove it from argc and
+ * argv and return N (0 if N is missing or not a number). Otherwise
+ * return dflt.
+ */
+unsigned int
+genes_option (int& argc, char** argv, unsigned int dflt)
+{
+    if (argc < 2 || strcmp (argv[1], "-n") != 0) {
+        return dflt;
+    }
+    unsigned int nGenes = 0;
+    if (argc > 2) {
+        char* end = 0;
+        nGenes = strtoul (argv[2], &end, 10);
+        if (*end != '\0') { nGenes = 0; }
+    }
+    int shift = (argc > 2) ? 2 : 1;
+    for (int i = 1 + shift; i <= argc; ++i) {
+        argv[i - shift] = argv[i];
+    }
+    argc -= shift;
+    return nGenes;
+}
+
+#endif // __DISPATCH_H__
@@ -0,0 +1,155 @@
+/*!
+ * The drift algorithm: a genome is mutated every generation (each bit
+ * flipping with probability p), whatever its fitness, until it is
+ * found to have fitness 1, whereupon the number of generations taken
+ * (the hitting time) is recorded and the walk starts again from a new
+ * random genome.
+ *
+ * Many independent walkers can be run in parallel, each with its own
+ * stream of random numbers, so the results for a given seed don't
+ * depend on the number of threads. Mutation jumps from one flipped bit
+ * to the next (the gaps are geometrically distributed), which is the
+ * same as testing every bit against p but costs only as many random
+ * numbers as there are flips. A genome which no bit flips in is not
+ * re-evaluated.
+ */
+
+#ifndef __DRIFT_H__
+#define __DRIFT_H__
+
+#include <vector>
+#include <array>
+#include <math.h>
+#ifdef _OPENMP
+# include <omp.h>
+#endif
+#include "sim_namespace.h"
+
+using namespace std;
+
+SIM_NAMESPACE_BEGIN
+
+#ifndef __LIB_H__
+#error "#include lib.h before #including drift.h"
+#endif
+#ifndef __FITNESS_H__
+#error "#include fitness.h before #including drift.h"
+#endif
+
+//! A walker passes on its hitting times in batches of this many
+#define DRIFT_BATCH 4096
+
+/*!
+ * Flip each bit of genome with probability p, using the RNG _rd.
+ * Returns the number of bits flipped. (This is flip_genome_bits() of
+ * lib.h, which evolve_genome() also uses.)
+ */
+unsigned int
+drift_mutate (array<genosect_t, N_Genes>& genome, double p, RngData* _rd)
+{
+    return flip_genome_bits (genome, p, _rd);
+}
+
+/*!
+ * A do-nothing observer of each generation of a walk, for drift_walk().
+ */
+struct DriftNoObserver
+{
+    void operator() (const array<genosect_t, N_Genes>&, unsigned long long int, double, bool) {}
+};
+
+/*!
+ * Run one walker for ngens generations with mutation probability p and
+ * RNG _rd. on_hit(t) is called with each hitting time t: the number of
+ * genomes evaluated from a new random genome to the one with fitness
+ * 1, inclusive. on_gen(genome, gen, f, hit) is called for every
+ * generation. A walk unfinished at the end isn't reported.
+ */
+template <typename OnHit, typename OnGeneration>
+void
+drift_walk (RngData* _rd, double p, unsigned long long int ngens, OnHit& on_hit, OnGeneration& on_gen)
+{
+    array<genosect_t, N_Genes> genome;
+    unsigned long long int start = 0;
+    bool need_new_genome = true;
+    bool changed = true;
+    double f = 0.0;
+    for (unsigned long long int gen = 0; gen < ngens; ++gen) {
+        if (need_new_genome) {
+            random_genome (genome, _rd);
+            start = gen;
+            need_new_genome = false;
+            changed = true;
+        }
+        // The fitness of a genome which hasn't changed is still f (< 1)
+        if (changed) {
+            f = evaluate_fitness (genome);
+        }
+        bool hit = (f == 1.0);
+        on_gen (genome, gen, f, hit);
+        if (hit) {
+            on_hit (gen - start + 1);
+            need_new_genome = true;
+        } else {
+            changed = drift_mutate (genome, p, _rd) > 0;
+        }
+    }
+}
+
+/*!
+ * Collects a walker's hitting times, passing them on to a shared sink
+ * a batch at a time.
+ */
+template <typename Sink>
+struct DriftBatcher
+{
+    DriftBatcher (Sink& _sink) : sink(_sink) { this->times.reserve (DRIFT_BATCH); }
+    void operator() (unsigned long long int t)
+    {
+        this->times.push_back (t);
+        if (this->times.size() == DRIFT_BATCH) { this->flush(); }
+    }
+    void flush (void)
+    {
+        if (this->times.empty()) { return; }
+#pragma omp critical (drift_sink)
+        {
+            this->sink (this->times);
+        }
+        this->times.clear();
+    }
+    Sink& sink;
+    vector<unsigned long long int> times;
+};
+
+/*!
+ * Run nwalkers independent walkers for gens_per_walker generations
+ * each, in parallel, with mutation probability p. Each walker has its
+ * own RNG stream, seeded from the global rd. The hitting times are
+ * passed to sink(const vector<unsigned long long int>&) in batches,
+ * one call at a time. Returns the total number of hitting times.
+ */
+template <typename Sink>
+unsigned long long int
+drift_walkers (unsigned int nwalkers, double p, unsigned long long int gens_per_walker, Sink& sink)
+{
+    vector<RngData> rds;
+    rngDataInitStreams (rds, nwalkers);
+    unsigned long long int nhits = 0;
+
+#pragma omp parallel for schedule(dynamic,1) reduction(+:nhits)
+    for (int w = 0; w < (int)nwalkers; ++w) {
+        DriftBatcher<Sink> batcher (sink);
+        unsigned long long int whits = 0;
+        auto on_hit = [&batcher, &whits](unsigned long long int t) { batcher (t); ++whits; };
+        DriftNoObserver no_obs;
+        drift_walk (&rds[w], p, gens_per_walker, on_hit, no_obs);
+        batcher.flush();
+        nhits += whits;
+    }
+    return nhits;
+}
+
+SIM_NAMESPACE_END
+
+#endif // __DRIFT_H__
@@ -1,6 +1,10 @@
 #ifndef _ENDPOINT_H_
 #define _ENDPOINT_H_
 
+#include "sim_namespace.h"
+
+SIM_NAMESPACE_BEGIN
+
 /*!
  * For fitness debugging.
  */
@@ -20,4 +24,6 @@ enum endpoint_t {
     ENDPOINT_N
 };
 
+SIM_NAMESPACE_END
+
 #endif // _ENDPOINT_H_
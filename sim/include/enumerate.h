@@ -0,0 +1,234 @@
+/*!
+ * Exhaustive enumeration of the genome space. Each genome is
+ * identified by a linear index into the 2^(N_Genes * 2^N_Ins) genomes
+ * and the index range is split into chunks which are shared out
+ * between OpenMP threads. Progress can be checkpointed to a file after
+ * each batch of chunks, so that a long search may be stopped and
+ * resumed.
+ *
+ * This is only possible where the number of genomes fits in a 64 bit
+ * unsigned integer (N_Genes * 2^N_Ins < 64), which means N_Genes=3
+ * (either k) and N_Genes=4, k=n-1. The latter is 2^32 genomes.
+ */
+
+#ifndef __ENUMERATE_H__
+#define __ENUMERATE_H__
+
+#include <array>
+#include <vector>
+#include <string>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <cstdio>
+#ifdef _OPENMP
+# include <omp.h>
+#endif
+#include "sim_namespace.h"
+
+using namespace std;
+
+SIM_NAMESPACE_BEGIN
+
+#ifndef __FITNESS_FUNCTION__
+#error "#include a fitness.h before #including enumerate.h to ensure evaluate_fitness() is available"
+#endif
+
+/*!
+ * The default number of genomes in a chunk.
+ */
+#define ENUMERATE_CHUNK (1ULL << 20)
+
+/*!
+ * The number of chunks per thread to evaluate between checkpoints.
+ */
+#define ENUMERATE_CHUNKS_PER_BATCH 16
+
+class GenomeSpaceEnumerator
+{
+public:
+    GenomeSpaceEnumerator (unsigned long long int _chunk_len = ENUMERATE_CHUNK)
+        : chunk_len(_chunk_len)
+    {
+        unsigned int l_genome = N_Genes * (1 << N_Ins);
+        if (l_genome >= 64) {
+            throw runtime_error ("GenomeSpaceEnumerator: genome space doesn't fit in 64 bits");
+        }
+        if (this->chunk_len == 0) {
+            throw runtime_error ("GenomeSpaceEnumerator: chunk length must be non-zero");
+        }
+        this->size = 1ULL << l_genome;
+        this->reset();
+    }
+
+    //! Start again from genome 0, with zeroed counts.
+    void reset (void)
+    {
+        this->next = 0;
+        this->numfit = 0;
+        this->numfit_and_canalysing = 0;
+        this->numperfect = 0;
+        this->numperfect_and_canalysing = 0;
+    }
+
+    /*!
+     * Set genome to the genome with index idx. The last genosect is
+     * the least significant, so that consecutive indices increment
+     * genome[N_Genes-1] as proprandomfits used to.
+     */
+    static void index2genome (unsigned long long int idx, array<genosect_t, N_Genes>& genome)
+    {
+        // Genosects are never 64 bits wide here, but the masks are written so as to compile for any N_Genes.
+        unsigned int w = (1 << N_Ins) & 63;
+        unsigned long long int sect_mask = (1ULL << w) - 1ULL;
+        for (unsigned int i = 0; i < N_Genes; ++i) {
+            genome[N_Genes-1-i] = static_cast<genosect_t>(idx & sect_mask);
+            idx >>= w;
+        }
+    }
+
+    /*!
+     * Evaluate the genomes from this->next onwards, until the whole
+     * space has been evaluated or (if max_genomes is non-zero) at least
+     * max_genomes more genomes have been evaluated. If checkpoint_path
+     * is non-empty, then the progress is written to it after each
+     * batch. Progress is reported on stderr, so that stdout holds only
+     * the caller's results. Returns true if the whole space has been
+     * evaluated.
+     */
+    bool run (const string& checkpoint_path = "", unsigned long long int max_genomes = 0)
+    {
+#ifdef _OPENMP
+        unsigned long long int nthreads = omp_get_max_threads();
+#else
+        unsigned long long int nthreads = 1;
+#endif
+        unsigned long long int stop_at = this->size;
+        if (max_genomes > 0 && max_genomes < this->size - this->next) {
+            stop_at = this->next + max_genomes;
+        }
+
+        while (this->next < stop_at) {
+
+            // The genomes in this batch
+            unsigned long long int batch_end = stop_at;
+            unsigned long long int batch_len = nthreads * ENUMERATE_CHUNKS_PER_BATCH * this->chunk_len;
+            if (batch_len < stop_at - this->next) {
+                batch_end = this->next + batch_len;
+            }
+            long long int n_chunks = static_cast<long long int>((batch_end - this->next + this->chunk_len - 1)
+                                                                / this->chunk_len);
+
+            unsigned long long int _numfit = 0;
+            unsigned long long int _numfit_and_canalysing = 0;
+            unsigned long long int _numperfect = 0;
+            unsigned long long int _numperfect_and_canalysing = 0;
+
+            unsigned long long int batch_start = this->next;
+#pragma omp parallel for schedule(dynamic) reduction(+:_numfit,_numfit_and_canalysing,_numperfect,_numperfect_and_canalysing)
+            for (long long int c = 0; c < n_chunks; ++c) {
+                unsigned long long int first = batch_start + c * this->chunk_len;
+                unsigned long long int last = first + this->chunk_len;
+                if (last > batch_end) { last = batch_end; }
+                array<genosect_t, N_Genes> genome;
+                // The fit genomes in this chunk, which are then tested for canalysingness all together
+                vector<array<genosect_t, N_Genes> > fit_genomes;
+                vector<bool> fit_perfect;
+                for (unsigned long long int g = first; g < last; ++g) {
+                    GenomeSpaceEnumerator::index2genome (g, genome);
+                    double f = evaluate_fitness (genome);
+                    if (f > 0.0) {
+                        fit_genomes.push_back (genome);
+                        fit_perfect.push_back (f == 1.0);
+                    }
+                }
+                vector<unsigned int> canal (fit_genomes.size());
+                canalyzingness_batch (fit_genomes.data(), canal.data(), fit_genomes.size());
+                for (size_t k = 0; k < fit_genomes.size(); ++k) {
+                    ++_numfit;
+                    if (canal[k]) { ++_numfit_and_canalysing; }
+                    if (fit_perfect[k]) {
+                        ++_numperfect;
+                        if (canal[k]) { ++_numperfect_and_canalysing; }
+                    }
+                }
+            }
+
+            this->numfit += _numfit;
+            this->numfit_and_canalysing += _numfit_and_canalysing;
+            this->numperfect += _numperfect;
+            this->numperfect_and_canalysing += _numperfect_and_canalysing;
+            this->next = batch_end;
+
+            cerr << "Evaluated " << this->next << " of " << this->size << " genomes: "
+                 << this->numfit << " with F>0, " << this->numperfect << " with F=1" << endl;
+            if (!checkpoint_path.empty()) {
+                this->saveCheckpoint (checkpoint_path);
+            }
+        }
+
+        return this->next == this->size;
+    }
+
+    /*!
+     * Write the progress to the file at path. The file records
+     * N_Genes, N_Ins, the index of the next genome and the counts.
+     */
+    void saveCheckpoint (const string& path) const
+    {
+        // Write to a temporary file, then rename, so that an interrupted write can't lose progress.
+        string tmppath = path + ".tmp";
+        ofstream f;
+        f.open (tmppath.c_str(), ios::out|ios::trunc);
+        if (!f.is_open()) {
+            throw runtime_error ("GenomeSpaceEnumerator: failed to open checkpoint file " + tmppath);
+        }
+        f << N_Genes << " " << N_Ins << " " << this->next << " "
+          << this->numfit << " " << this->numfit_and_canalysing << " "
+          << this->numperfect << " " << this->numperfect_and_canalysing << endl;
+        f.close();
+        if (rename (tmppath.c_str(), path.c_str()) != 0) {
+            throw runtime_error ("GenomeSpaceEnumerator: failed to write checkpoint file " + path);
+        }
+    }
+
+    /*!
+     * Read the progress from the file at path, if it exists. Returns
+     * true if progress was read.
+     */
+    bool loadCheckpoint (const string& path)
+    {
+        ifstream f;
+        f.open (path.c_str(), ios::in);
+        if (!f.is_open()) {
+            return false;
+        }
+        unsigned int ng = 0, ni = 0;
+        f >> ng >> ni >> this->next
+          >> this->numfit >> this->numfit_and_canalysing
+          >> this->numperfect >> this->numperfect_and_canalysing;
+        if (f.fail() || ng != N_Genes || ni != N_Ins || this->next > this->size) {
+            this->reset();
+            throw runtime_error ("GenomeSpaceEnumerator: checkpoint file " + path + " is not for this genome space");
+        }
+        return true;
+    }
+
+    //! The number of genomes in each chunk
+    unsigned long long int chunk_len;
+    //! The number of genomes in the space
+    unsigned long long int size;
+    //! The index of the next genome to evaluate
+    unsigned long long int next;
+
+    //@{ The results so far
+    unsigned long long int numfit;
+    unsigned long long int numfit_and_canalysing;
+    unsigned long long int numperfect;
+    unsigned long long int numperfect_and_canalysing;
+    //@}
+};
+
+SIM_NAMESPACE_END
+
+#endif // __ENUMERATE_H__
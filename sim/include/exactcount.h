@@ -0,0 +1,514 @@
+/*!
+ * Exact counts of the number of genomes which have F>0 and F=1 under
+ * fitness function 4, without enumerating the genome space.
+ *
+ * For k=n, every state addresses its own bit in each genosect, so a
+ * genome is exactly a choice of successor for each of the n=2^N_Genes
+ * states, and there are n^n genomes. FF4 depends only on the limit
+ * cycles reached from initial_ant (x) and initial_pos (y):
+ *
+ * F=1 when the cycle from x is the point attractor target_ant and the
+ * cycle from y is the point attractor target_pos.
+ *
+ * F>0 when, for each gene j, some state on the cycle from x has bit j
+ * equal to that of target_ant (and likewise for y and target_pos). If
+ * B_j is the set of states with the wrong bit j, then by
+ * inclusion-exclusion over the sets of genes S and T,
+ *
+ * numfit = sum_S sum_T (-1)^(|S|+|T|) count(B_S, B_T)
+ *
+ * where B_S is the intersection of the B_j for j in S and
+ * count(A, B) is the number of successor functions for which the
+ * cycle from x lies in A and the cycle from y lies in B. count() is
+ * computed by summing over the shapes of the two trajectories (see
+ * FunctionCounter::count()); it depends only on the sizes of A, B and
+ * A&B and on where x and y lie, so there are few distinct values.
+ *
+ * The whole distribution of fitness values depends on exactly which
+ * states are on each cycle, not just on how many lie in some set, so
+ * exact_fitness_histogram() enumerates the pairs of cycles, weighting
+ * each by the number of functions which give it
+ * (FunctionCounter::separate() and FunctionCounter::shared()). There
+ * are 3^(2^N_Genes) such pairs, so the histogram is limited to
+ * N_Genes <= 4.
+ *
+ * Only the two-context system and k=n are covered. The histogram for
+ * N_Genes = 5 and 6 and the counts for more than two contexts are
+ * open; see "exactfits.cpp" in sim/README.md.
+ */
+
+#ifndef __EXACTCOUNT_H__
+#define __EXACTCOUNT_H__
+
+#include <vector>
+#include <map>
+#include <stdexcept>
+#include "lmp.h"
+#include "sim_namespace.h"
+
+using namespace std;
+
+SIM_NAMESPACE_BEGIN
+
+/*!
+ * Counts successor functions on n states (numbered 0 to n-1), by the
+ * location of the cycles reached from the two starting states, x and
+ * y.
+ */
+class FunctionCounter
+{
+public:
+    FunctionCounter (unsigned int _n)
+        : n(_n)
+    {
+        if (this->n < 2) {
+            throw runtime_error ("FunctionCounter: need at least two states");
+        }
+        unsigned int n1 = this->n + 1;
+        this->tables.resize (n1 + 2*n1*n1 + 3*n1);
+        for (size_t i = 0; i < this->tables.size(); ++i) {
+            lmp::Init (&this->tables[i]);
+        }
+
+        // Powers of n
+        for (unsigned int e = 0; e <= this->n; ++e) {
+            lmp::PowUiUi (this->pw(e), this->n, e);
+        }
+        // Falling factorials P(r,t) = r!/(r-t)! and binomial coefficients
+        for (unsigned int r = 0; r <= this->n; ++r) {
+            lmp::SetUi (this->P(r, 0), 1);
+            for (unsigned int t = 1; t <= this->n; ++t) {
+                lmp::MulUi (this->P(r, t), this->P(r, t-1), (t <= r) ? (r-t+1) : 0);
+            }
+            for (unsigned int t = 0; t <= this->n; ++t) {
+                lmp::BinomialUiUi (this->C(r, t), r, t);
+            }
+        }
+
+        // tailsum(f, M): the ways to choose the tails of the two
+        // trajectories, where f of the two have a tail, and M states
+        // other than x and y are on the cycles.
+        Xint term;
+        lmp::Init (term);
+        for (unsigned int f = 0; f < 3; ++f) {
+            for (unsigned int M = 0; M + 2 <= this->n; ++M) {
+                lmp::SetUi (this->tailsum(f, M), 0);
+                unsigned int r = this->n - 2 - M;
+                for (unsigned int T = 0; T <= r; ++T) {
+                    if (f == 0 && T > 0) { break; }
+                    lmp::Mul (term, this->P(r, T), this->pw(r - T));
+                    if (f == 2) { lmp::MulUi (term, term, T + 1); }
+                    lmp::Add (this->tailsum(f, M), this->tailsum(f, M), term);
+                }
+            }
+        }
+        lmp::Clear (term);
+    }
+
+    ~FunctionCounter()
+    {
+        for (size_t i = 0; i < this->tables.size(); ++i) {
+            lmp::Clear (&this->tables[i]);
+        }
+        map<unsigned long long int, __mpz_struct>::iterator mi = this->memo.begin();
+        while (mi != this->memo.end()) {
+            lmp::Clear (&mi->second);
+            ++mi;
+        }
+    }
+
+    /*!
+     * Set res to the number of functions for which the cycle reached
+     * from x lies within A and the cycle reached from y lies within B.
+     *
+     * a, b and c are the sizes of A, B and A&B, not counting x and y
+     * themselves, whose membership is given by xA, xB, yA and yB.
+     */
+    void count (Xint res, unsigned int a, unsigned int b, unsigned int c,
+                bool xA, bool xB, bool yA, bool yB)
+    {
+        if (c > a || c > b || a + b - c + 2 > this->n) {
+            throw runtime_error ("FunctionCounter::count: inconsistent set sizes");
+        }
+
+        unsigned long long int key = (static_cast<unsigned long long int>(a) << 36)
+            | (static_cast<unsigned long long int>(b) << 22)
+            | (static_cast<unsigned long long int>(c) << 8)
+            | (xA ? 0x1 : 0) | (xB ? 0x2 : 0) | (yA ? 0x4 : 0) | (yB ? 0x8 : 0);
+        if (this->memo.count (key)) {
+            lmp::Set (res, &this->memo[key]);
+            return;
+        }
+
+        Xint sum, term, per;
+        lmp::InitSetUi (sum, 0);
+        lmp::Init (term);
+        lmp::Init (per);
+
+        // 1. Separate cycles; neither trajectory touches the other. The
+        // cycle from x has m1 states (other than x) from A and the cycle
+        // from y, m2 from B, of which i in total are shared with A&B. If
+        // x (y) is on its own cycle (h1, h2) then it has no tail.
+        for (unsigned int h1 = 0; h1 < 2; ++h1) {
+            if (h1 && !xA) { continue; }
+            for (unsigned int h2 = 0; h2 < 2; ++h2) {
+                if (h2 && !yB) { continue; }
+                for (unsigned int m1 = (h1 ? 0 : 1); m1 <= a; ++m1) {
+                    for (unsigned int m2 = (h2 ? 0 : 1); m2 <= b && m1 + m2 + 2 <= this->n; ++m2) {
+                        this->separate (per, m1, h1, m2, h2);
+                        unsigned int imin = (m1 > a - c) ? m1 - (a - c) : 0;
+                        for (unsigned int i = imin; i <= c && i <= m1; ++i) {
+                            if (m2 > b - i) { break; }
+                            lmp::Mul (term, this->C(c, i), this->C(a - c, m1 - i));
+                            lmp::Mul (term, term, this->C(b - i, m2));
+                            lmp::Mul (term, term, per);
+                            lmp::Add (sum, sum, term);
+                        }
+                    }
+                }
+            }
+        }
+
+        // 2. A shared cycle, which must lie in A&B. The cycle has m states
+        // from A&B other than x and y, and x and y may be on it too.
+        bool xAB = xA && xB;
+        bool yAB = yA && yB;
+        for (unsigned int m = 0; m + 2 <= this->n && m <= c; ++m) {
+            for (unsigned int xon = 0; xon < 2; ++xon) {
+                if (xon && !xAB) { continue; }
+                for (unsigned int yon = 0; yon < 2; ++yon) {
+                    if (yon && !yAB) { continue; }
+                    this->shared (per, m, xon, yon);
+                    lmp::Mul (term, this->C(c, m), per);
+                    lmp::Add (sum, sum, term);
+                }
+            }
+        }
+
+        lmp::Set (res, sum);
+        lmp::Init (&this->memo[key]);
+        lmp::Set (&this->memo[key], sum);
+
+        lmp::Clear (sum);
+        lmp::Clear (term);
+        lmp::Clear (per);
+    }
+
+    /*!
+     * Set res to the number of functions for which the cycles from x
+     * and from y are separate, given cycles, and neither trajectory
+     * touches the other. The cycle from x is made of m1 given states
+     * other than x and y, plus x itself if h1; likewise the cycle from
+     * y is m2 given states, plus y if h2.
+     */
+    void separate (Xint res, unsigned int m1, bool h1, unsigned int m2, bool h2)
+    {
+        if ((m1 == 0 && !h1) || (m2 == 0 && !h2) || m1 + m2 + 2 > this->n) {
+            lmp::SetUi (res, 0);
+            return;
+        }
+        // The orders of the states around each cycle (and where a
+        // trajectory with a tail joins its cycle), times the tails.
+        unsigned int f = (h1 ? 0 : 1) + (h2 ? 0 : 1);
+        lmp::Mul (res, this->P(m1, m1), this->P(m2, m2));
+        lmp::Mul (res, res, this->tailsum(f, m1 + m2));
+    }
+
+    /*!
+     * Set res to the number of functions for which x and y reach the
+     * same, given cycle. The cycle is made of m given states other
+     * than x and y, plus x if xon and y if yon.
+     */
+    void shared (Xint res, unsigned int m, bool xon, bool yon)
+    {
+        if ((m == 0 && !xon && !yon) || m + 2 > this->n) {
+            lmp::SetUi (res, 0);
+            return;
+        }
+        if (xon || yon) {
+            // Order the cycle's other states after x (or y), then place
+            // y (or x) at one of m+1 places on the cycle or let its
+            // trajectory join the cycle at one of those m+1 states.
+            lmp::MulUi (res, this->P(m, m), m + 1);
+            lmp::Mul (res, res, this->tailsum((xon && yon) ? 0 : 1, m));
+            return;
+        }
+
+        // Neither on the cycle. Either y is on x's tail, which has t
+        // states other than y (tailsum(2, m)) or y's trajectory has u
+        // states of its own and then joins x's trajectory, whose tail
+        // has t states, at one of its 1+m+t states. With s = t+u:
+        Xint term;
+        lmp::Init (term);
+        lmp::Set (res, this->tailsum(2, m));
+        unsigned int r = this->n - 2 - m;
+        for (unsigned int s = 0; s <= r; ++s) {
+            lmp::Mul (term, this->P(r, s), this->pw(r - s));
+            lmp::MulUi (term, term, (s + 1) * (1 + m) + s * (s + 1) / 2);
+            lmp::Add (res, res, term);
+        }
+        lmp::Mul (res, res, this->P(m, m));
+        lmp::Clear (term);
+    }
+
+private:
+    //! The number of states
+    unsigned int n;
+
+    //! Storage for pw, P, C and tailsum
+    vector<__mpz_struct> tables;
+
+    //@{ Accessors for the precomputed tables
+    mpz_ptr pw (unsigned int e) { return &this->tables[e]; }
+    mpz_ptr P (unsigned int r, unsigned int t) { return &this->tables[(this->n+1) + r*(this->n+1) + t]; }
+    mpz_ptr C (unsigned int r, unsigned int t) {
+        return &this->tables[(this->n+1) * (this->n+2) + r*(this->n+1) + t];
+    }
+    mpz_ptr tailsum (unsigned int f, unsigned int M) {
+        return &this->tables[(this->n+1) * (2*this->n+3) + f*(this->n+1) + M];
+    }
+    //@}
+
+    //! Results of count(), keyed on its arguments
+    map<unsigned long long int, __mpz_struct> memo;
+};
+
+#ifdef __LIB_H__
+# ifdef N_Ins_EQUALS_N_Genes
+/*!
+ * Compute the exact number of genomes with F>0 (numfit) and with F=1
+ * (numperfect) for fitness function 4, with the global initial and
+ * target states.
+ */
+void
+exact_fitness_counts (Xint numfit, Xint numperfect)
+{
+    unsigned int n = 1 << N_Genes;
+    FunctionCounter fc (n);
+
+    state_t x = initial_ant;
+    state_t y = initial_pos;
+
+    // Count the states in A, B and A&B other than x and y.
+    unsigned int a = 0, b = 0, c = 0;
+
+    // numperfect: A = {target_ant}, B = {target_pos}
+    a = (target_ant != x && target_ant != y) ? 1 : 0;
+    b = (target_pos != x && target_pos != y) ? 1 : 0;
+    c = (target_ant == target_pos && a) ? 1 : 0;
+    fc.count (numperfect, a, b, c, x == target_ant, x == target_pos, y == target_ant, y == target_pos);
+
+    // numfit, by inclusion-exclusion
+    Xint term;
+    lmp::Init (term);
+    lmp::SetUi (numfit, 0);
+    for (unsigned int S = 0; S < (1U << N_Genes); ++S) {
+        for (unsigned int T = 0; T < (1U << N_Genes); ++T) {
+            // A holds states whose bits in S all differ from target_ant; similarly B.
+            a = 0; b = 0; c = 0;
+            bool xA = false, xB = false, yA = false, yB = false;
+            for (unsigned int s = 0; s < n; ++s) {
+                bool inA = (((s ^ target_ant) & S) == S);
+                bool inB = (((s ^ target_pos) & T) == T);
+                if (s == x) {
+                    xA = inA; xB = inB;
+                } else if (s == y) {
+                    yA = inA; yB = inB;
+                } else {
+                    a += inA ? 1 : 0;
+                    b += inB ? 1 : 0;
+                    c += (inA && inB) ? 1 : 0;
+                }
+            }
+            fc.count (term, a, b, c, xA, xB, yA, yB);
+            bool negative = ((bitset<N_Genes>(S).count() + bitset<N_Genes>(T).count()) % 2 == 1);
+            if (negative) {
+                lmp::Sub (numfit, numfit, term);
+            } else {
+                lmp::Add (numfit, numfit, term);
+            }
+        }
+    }
+    lmp::Clear (term);
+}
+
+/*!
+ * The number of genomes with each value of the fitness. Fitness values
+ * are held exactly, as fractions (numerator, denominator) in lowest
+ * terms.
+ */
+struct FitnessHistogram
+{
+    FitnessHistogram() {}
+    FitnessHistogram (const FitnessHistogram&) = delete;
+    FitnessHistogram& operator= (const FitnessHistogram&) = delete;
+
+    ~FitnessHistogram()
+    {
+        map<pair<unsigned long long int, unsigned long long int>, __mpz_struct>::iterator ci;
+        for (ci = this->counts.begin(); ci != this->counts.end(); ++ci) {
+            lmp::Clear (&ci->second);
+        }
+    }
+
+    //! Add num genomes with the fitness fnum/fden (not necessarily in lowest terms)
+    void add (unsigned long long int fnum, unsigned long long int fden, Xint num)
+    {
+        unsigned long long int g = fnum, h = fden;
+        while (h != 0) { unsigned long long int t = g % h; g = h; h = t; }
+        pair<unsigned long long int, unsigned long long int> f (fnum / g, fden / g);
+        if (!this->counts.count (f)) {
+            lmp::InitSetUi (&this->counts[f], 0);
+        }
+        lmp::Add (&this->counts[f], &this->counts[f], num);
+    }
+
+    //! The number of genomes for each fitness
+    map<pair<unsigned long long int, unsigned long long int>, __mpz_struct> counts;
+};
+
+#  if N_Genes <= 4
+/*!
+ * Compute the number of genomes with each value of fitness function
+ * 4, with the global initial and target states.
+ *
+ * The fitness depends on exactly which states are on the two cycles,
+ * so every possible pair of cycles is enumerated, each weighted by the
+ * number of functions which give it (FunctionCounter::separate() and
+ * shared()). That is 3^(2^N_Genes) pairs of cycles, so this is limited
+ * to N_Genes <= 4.
+ */
+void
+exact_fitness_histogram (FitnessHistogram& hist)
+{
+    const unsigned int n = 1 << N_Genes;
+    FunctionCounter fc (n);
+
+    const state_t x = initial_ant;
+    const state_t y = initial_pos;
+
+    // For every set of states (a bit mask) the product over the genes of
+    // the number of states that match the target in that gene, for
+    // each context. The score of a cycle is this over its length^N_Genes.
+    vector<unsigned int> prod_ant (1 << n), prod_pos (1 << n);
+    for (unsigned int cyc = 0; cyc < (1U << n); ++cyc) {
+        array<unsigned int, N_Genes> ma, mp;
+        ma.fill (0);
+        mp.fill (0);
+        for (unsigned int s = 0; s < n; ++s) {
+            if (!(cyc & (1U << s))) { continue; }
+            for (unsigned int j = 0; j < N_Genes; ++j) {
+                ma[j] += ((s ^ ~target_ant) >> j) & 0x1;
+                mp[j] += ((s ^ ~target_pos) >> j) & 0x1;
+            }
+        }
+        prod_ant[cyc] = 1;
+        prod_pos[cyc] = 1;
+        for (unsigned int j = 0; j < N_Genes; ++j) {
+            prod_ant[cyc] *= ma[j];
+            prod_pos[cyc] *= mp[j];
+        }
+    }
+
+    // The states other than x and y, whose subsets make up the cycles
+    // along with x and y themselves. full[sub] is the set of states of
+    // the subset sub.
+    const unsigned int nothers = n - 2;
+    const unsigned int all = (1U << nothers) - 1;
+    vector<unsigned int> full (1U << nothers, 0);
+    for (unsigned int sub = 0; sub <= all; ++sub) {
+        unsigned int i = 0;
+        for (unsigned int s = 0; s < n; ++s) {
+            if (s == x || s == y) { continue; }
+            if (sub & (1U << i++)) { full[sub] |= (1U << s); }
+        }
+    }
+
+    // Tally the pairs of cycles with F>0 by their lengths, whether x and
+    // y lie on them, and their scores, which is all that their counts
+    // and fitness depend on. Bits 0-16 and 17-33 of a key hold the
+    // products, then come the numbers of other states on the cycles
+    // (4 bits each) and the flags for x and y being on them.
+    map<unsigned long long int, unsigned long long int> sep, shr;
+    for (unsigned int sub1 = 0; sub1 <= all; ++sub1) {
+        unsigned int m1 = bitset<32>(sub1).count();
+        unsigned int rest = all & ~sub1;
+        for (unsigned int h1 = 0; h1 < 2; ++h1) {
+            unsigned int c1 = full[sub1] | (h1 ? (1U << x) : 0);
+            unsigned long long int p1 = prod_ant[c1];
+            if (c1 == 0 || p1 == 0) { continue; }
+            // Every subset of the states which are not on the first cycle
+            unsigned int sub2 = rest;
+            for (;;) {
+                unsigned int m2 = bitset<32>(sub2).count();
+                for (unsigned int h2 = 0; h2 < 2; ++h2) {
+                    unsigned int c2 = full[sub2] | (h2 ? (1U << y) : 0);
+                    unsigned long long int p2 = prod_pos[c2];
+                    if (c2 == 0 || p2 == 0) { continue; }
+                    ++sep[p1 | (p2 << 17) | ((unsigned long long int)m1 << 34)
+                          | ((unsigned long long int)m2 << 38)
+                          | ((unsigned long long int)h1 << 42) | ((unsigned long long int)h2 << 43)];
+                }
+                if (sub2 == 0) { break; }
+                sub2 = (sub2 - 1) & rest;
+            }
+        }
+        for (unsigned int xon = 0; xon < 2; ++xon) {
+            for (unsigned int yon = 0; yon < 2; ++yon) {
+                unsigned int cyc = full[sub1] | (xon ? (1U << x) : 0) | (yon ? (1U << y) : 0);
+                unsigned long long int p1 = prod_ant[cyc];
+                unsigned long long int p2 = prod_pos[cyc];
+                if (cyc == 0 || p1 == 0 || p2 == 0) { continue; }
+                ++shr[p1 | (p2 << 17) | ((unsigned long long int)m1 << 34)
+                      | ((unsigned long long int)xon << 42) | ((unsigned long long int)yon << 43)];
+            }
+        }
+    }
+
+    // Weight each tally by the number of functions per pair of cycles.
+    // The F=0 genomes are the rest.
+    Xint per, num, nzero;
+    lmp::Init (per);
+    lmp::Init (num);
+    lmp::Init (nzero);
+    lmp::PowUiUi (nzero, n, n);
+    for (unsigned int shared = 0; shared < 2; ++shared) {
+        map<unsigned long long int, unsigned long long int>& tally = shared ? shr : sep;
+        map<unsigned long long int, unsigned long long int>::const_iterator ti;
+        for (ti = tally.begin(); ti != tally.end(); ++ti) {
+            unsigned long long int p1 = ti->first & 0x1ffff;
+            unsigned long long int p2 = (ti->first >> 17) & 0x1ffff;
+            unsigned int m1 = (ti->first >> 34) & 0xf;
+            unsigned int m2 = (ti->first >> 38) & 0xf;
+            bool h1 = (ti->first >> 42) & 0x1;
+            bool h2 = (ti->first >> 43) & 0x1;
+            // The lengths of the cycles
+            unsigned long long int l1, l2;
+            if (shared) {
+                fc.shared (per, m1, h1, h2);
+                l1 = l2 = m1 + (h1 ? 1 : 0) + (h2 ? 1 : 0);
+            } else {
+                fc.separate (per, m1, h1, m2, h2);
+                l1 = m1 + (h1 ? 1 : 0);
+                l2 = m2 + (h2 ? 1 : 0);
+            }
+            lmp::MulUi (num, per, ti->second);
+            unsigned long long int den = 1;
+            for (unsigned int j = 0; j < N_Genes; ++j) { den *= l1 * l2; }
+            hist.add (p1 * p2, den, num);
+            lmp::Sub (nzero, nzero, num);
+        }
+    }
+    hist.add (0, 1, nzero);
+
+    lmp::Clear (per);
+    lmp::Clear (num);
+    lmp::Clear (nzero);
+}
+#  endif
+# endif
+#endif
+
+SIM_NAMESPACE_END
+
+#endif // __EXACTCOUNT_H__
@@ -7,6 +7,7 @@
 #define __FITNESS_H__
 
 #include "endpoint.h"
+#include "sim_namespace.h"
 
 // The default is fitness1.h; pass -DUSE_FITNESS_0 in compiler command
 // line to select fitness0.h.
@@ -57,4 +58,25 @@
 # error "When you include fitness.h you have to make sure to define USE_FITNESS_N"
 #endif
 
+SIM_NAMESPACE_BEGIN
+
+#ifndef FF_HAS_BATCH_EVALUATION
+/*!
+ * For the fitness functions which can't evaluate a block of genomes together, evaluate the L
+ * genomes in block one at a time, writing the fitness of lane l to f[l].
+ */
+template <unsigned int L>
+void
+evaluate_fitness_batch (const GenomeBlock<L>& block, double* f)
+{
+    array<genosect_t, N_Genes> genome;
+    for (unsigned int l = 0; l < L; ++l) {
+        block.get (l, genome);
+        f[l] = evaluate_fitness (genome);
+    }
+}
+#endif
+
+SIM_NAMESPACE_END
+
 #endif // __FITNESS_FUNCTION__
@@ -16,6 +16,9 @@ using namespace std;
 #define FF_NAME "ff0"
 
 #include "basins.h"
+#include "sim_namespace.h"
+
+SIM_NAMESPACE_BEGIN
 
 /*!
  * For the passed-in genome, find its final state, starting from the
@@ -153,4 +156,6 @@ evaluate_fitness (array<genosect_t, N_Genes>& genome)
     return fitness;
 }
 
+SIM_NAMESPACE_END
+
 #endif // __FITNESS_FUNCTION__
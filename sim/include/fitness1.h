@@ -6,9 +6,18 @@
 #define __FITNESS_FUNCTION__
 
 #include <math.h>
+#include "sim_namespace.h"
+
+SIM_NAMESPACE_BEGIN
 
 #define FF_NAME "ff1"
 
+/*!
+ * The fitness depends only on the trajectories from initial_ant and
+ * initial_pos (see neighbourhood.h).
+ */
+#define FF_SCORES_TRAJECTORIES_ONLY 1
+
 /*!
  * For the passed-in genome, find its final state, starting from the
  * anterior state state_ant and the posterior state state_pos. Return
@@ -160,4 +169,6 @@ evaluate_fitness (array<genosect_t, N_Genes>& genome)
     DBGF ("Fitness: " << fitness);
     return fitness;
 }
+SIM_NAMESPACE_END
+
 #endif // __FITNESS_FUNCTION__
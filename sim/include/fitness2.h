@@ -7,18 +7,30 @@
 #define __FITNESS_FUNCTION__
 
 #include <set>
+#include "sim_namespace.h"
 
 using namespace std;
 
+SIM_NAMESPACE_BEGIN
+
 /*!
  * When working with states in a graph of nodes, it may be necessary
  * to use one bit to refer to the state as being unset; this is the
  * bit to use.
  */
 #define state_t_unset 0x80
+#if N_Genes > 7
+# error "state_t_unset (0x80) is a real state when N_Genes > 7, so this fitness function needs N_Genes <= 7"
+#endif
 
 #define FF_NAME "ff2"
 
+/*!
+ * The fitness depends only on the trajectories from initial_ant and
+ * initial_pos (see neighbourhood.h).
+ */
+#define FF_SCORES_TRAJECTORIES_ONLY 1
+
 /*!
  * For the passed-in genome, find its final state, starting from the
  * anterior state initial_ant and the posterior state initial_pos
@@ -319,4 +331,6 @@ evaluate_fitness (array<genosect_t, N_Genes>& genome)
     return fitness;
 }
 
+SIM_NAMESPACE_END
+
 #endif // __FITNESS_FUNCTION__
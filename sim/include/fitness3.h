@@ -8,9 +8,12 @@
 
 #include <set>
 #include "basins.h"
+#include "sim_namespace.h"
 
 using namespace std;
 
+SIM_NAMESPACE_BEGIN
+
 #define FF_NAME "ff3"
 
 /*!
@@ -156,4 +159,6 @@ evaluate_fitness (array<genosect_t, N_Genes>& genome)
     return fitness;
 }
 
+SIM_NAMESPACE_END
+
 #endif // __FITNESS_FUNCTION__
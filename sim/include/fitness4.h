@@ -11,18 +11,21 @@
 
 #include <set>
 #include <array>
+#include <bitset>
+#include "sim_namespace.h"
 
 using namespace std;
 
-/*!
- * When working with states in a graph of nodes, it may be necessary
- * to use one bit to refer to the state as being unset; this is the
- * bit to use.
- */
-#define state_t_unset 0x80
+SIM_NAMESPACE_BEGIN
 
 #define FF_NAME "ff4"
 
+/*!
+ * The fitness depends only on the trajectories from initial_ant and
+ * initial_pos (see neighbourhood.h).
+ */
+#define FF_SCORES_TRAJECTORIES_ONLY 1
+
 double
 evaluate_one_async (array<genosect_t, N_Genes>& genome, state_t state, state_t target)
 {
@@ -56,65 +59,46 @@ evaluate_one_async (array<genosect_t, N_Genes>& genome, state_t state, state_t t
 
 /*!
  * Evaluates the fitness of one context (anterior or posterior in the 2-context system).
+ *
+ * The states visited are marked in a bitset with a bit for every state, so no state value has to
+ * be set aside to mean "unset" (every value of state_t is a state when N_Genes=8).
  */
 double
 evaluate_one (array<genosect_t, N_Genes>& genome, state_t state, state_t target)
 {
-    double score = 0.0;
-
-    state_t state_last = state_t_unset;
-    set<state_t> visited;
-    visited.insert (state); // insert starting state
-    for (;;) {
-        state_last = state;
+    // Develop the state until it revisits one; that state is on the attractor.
+    bitset<(1 << N_Genes)> visited;
+    while (!visited.test (state)) {
+        visited.set (state);
         compute_next (genome, state);
+    }
 
-        if (visited.count (state)) {
-
-            // Already visited this state so it's a limit cycle or point attractor
-
-            if (state == state_last) { // Point attractor
-
-                score = (state == target) ? 1.0 : score; // score is 0
-
-            } else { // Limit cycle
-
-                // Determine the states in the limit cycle by going around it once more.
-                set<state_t> lc;
-                unsigned int lc_len = 0;
-                while (lc.count (state) == 0) {
-                    // Check if we have one or both target states on this limit cycle
-                    lc.insert (state);
-                    lc_len++;
-                    // DBGF ("Limit cycle contains: " << state_str (state));
-                    compute_next (genome, state);
-                }
-
-                // Now have the set lc; can work out its score.
-
-                // For tabulating the scores
-                array<double, N_Genes> sc;
-                for (unsigned int j = 0; j < N_Genes; ++j) { sc[j] = 0.0; }
-
-                set<state_t>::const_iterator i = lc.begin();
-                while (i != lc.end()) {
-                    state_t a = ((*i) ^ ~target) & state_mask;
-                    for (unsigned int j = 0; j < N_Genes; ++j) {
-                        sc[j] += static_cast<double>( (a >> j) & 0x1 );
-                    }
-                    ++i;
-                }
+    state_t next = state;
+    compute_next (genome, next);
+    if (next == state) { // Point attractor
+        return (state == target) ? 1.0 : 0.0;
+    }
 
-                score = pow(static_cast<double>(lc_len), -N_Genes);
-                for (unsigned int j = 0; j < N_Genes; ++j) {
-                    score *= sc[j];
-                }
-            }
-            break;
+    // Limit cycle. Go around it once, tabulating the scores.
+    array<double, N_Genes> sc;
+    for (unsigned int j = 0; j < N_Genes; ++j) { sc[j] = 0.0; }
+    unsigned int lc_len = 0;
+    const state_t lc_start = state;
+    do {
+        // DBGF ("Limit cycle contains: " << state_str (state));
+        state_t a = (state ^ ~target) & state_mask;
+        for (unsigned int j = 0; j < N_Genes; ++j) {
+            sc[j] += static_cast<double>( (a >> j) & 0x1 );
         }
-        visited.insert (state);
-    }
+        lc_len++;
+        state = next;
+        compute_next (genome, next);
+    } while (state != lc_start);
 
+    double score = pow(static_cast<double>(lc_len), -N_Genes);
+    for (unsigned int j = 0; j < N_Genes; ++j) {
+        score *= sc[j];
+    }
     return score;
 }
 
@@ -166,6 +150,166 @@ evaluate_fitness (array<genosect_t, N_Genes>& genome)
     return fitness;
 }
 
+/*!
+ * FF4 can be evaluated from a state transition table as well as from
+ * the genome (see neighbourhood.h).
+ */
+#define FF_HAS_TABLE_EVALUATION 1
+
+/*!
+ * As evaluate_one(), but develops the state by looking up its
+ * successor in the transition table succ (which has 1<<N_Genes
+ * entries) rather than by calling compute_next().
+ */
+double
+evaluate_one_table (const state_t* succ, state_t state, state_t target)
+{
+    // Walk the trajectory until a state is revisited
+    bitset<(1 << N_Genes)> visited;
+    while (!visited.test (state)) {
+        visited.set (state);
+        state = succ[state];
+    }
+
+    if (succ[state] == state) { // Point attractor
+        return (state == target) ? 1.0 : 0.0;
+    }
+
+    // Limit cycle. Go around it once, tabulating the scores.
+    array<double, N_Genes> sc;
+    for (unsigned int j = 0; j < N_Genes; ++j) { sc[j] = 0.0; }
+    unsigned int lc_len = 0;
+    state_t lc_start = state;
+    do {
+        state_t a = (state ^ ~target) & state_mask;
+        for (unsigned int j = 0; j < N_Genes; ++j) {
+            sc[j] += static_cast<double>( (a >> j) & 0x1 );
+        }
+        lc_len++;
+        state = succ[state];
+    } while (state != lc_start);
+
+    double score = pow(static_cast<double>(lc_len), -N_Genes);
+    for (unsigned int j = 0; j < N_Genes; ++j) {
+        score *= sc[j];
+    }
+    return score;
+}
+
+/*!
+ * evaluate_fitness() for the network with the transition table succ.
+ */
+double
+evaluate_fitness_table (const state_t* succ)
+{
+    return evaluate_one_table (succ, initial_ant, target_ant)
+        * evaluate_one_table (succ, initial_pos, target_pos);
+}
+
+/*!
+ * evaluate_one() for each of the L genomes in block, all starting from state, writing the score
+ * of lane l to score[l]. The lanes are developed in lockstep with compute_next_batch(). A lane
+ * stops (its state is held) once it has found its attractor, and the block stops once every
+ * lane has, first while looking for a revisited state and then while going around the limit
+ * cycles. The scores are the same, to the bit, as those of evaluate_one().
+ */
+template <unsigned int L>
+void
+evaluate_one_batch (const GenomeBlock<L>& block, state_t state, state_t target, double* score)
+{
+    // The states visited by each lane, a bit for each state; one word per lane for N_Genes <= 6
+    const unsigned int vwords = ((1 << N_Genes) + 63) / 64;
+    unsigned long long int visited[L][vwords];
+    unsigned int st[L];
+    unsigned int next[L];
+    unsigned int active[L];
+    for (unsigned int l = 0; l < L; ++l) {
+        for (unsigned int w = 0; w < vwords; ++w) { visited[l][w] = 0ULL; }
+        st[l] = state;
+        active[l] = 1;
+    }
+
+    // Develop until each lane revisits a state; that state is on the lane's attractor.
+    for (;;) {
+        unsigned int nactive = 0;
+#pragma omp simd reduction(+:nactive)
+        for (unsigned int l = 0; l < L; ++l) {
+            unsigned long long int bit = 1ULL << (st[l] & 63);
+            unsigned int w = (vwords == 1) ? 0 : (st[l] >> 6);
+            active[l] &= (visited[l][w] & bit) ? 0 : 1;
+            visited[l][w] |= bit;
+            nactive += active[l];
+        }
+        if (nactive == 0) { break; }
+        for (unsigned int l = 0; l < L; ++l) { next[l] = st[l]; }
+        compute_next_batch (block, next);
+#pragma omp simd
+        for (unsigned int l = 0; l < L; ++l) { st[l] = active[l] ? next[l] : st[l]; }
+    }
+
+    // Go around each limit cycle once, tabulating the scores. A point attractor is a cycle of
+    // length 1, which scores 1 if it's the target, 0 otherwise, as in evaluate_one().
+    unsigned int lc_start[L];
+    unsigned int lc_len[L];
+    unsigned int sc[N_Genes][L];
+    for (unsigned int l = 0; l < L; ++l) {
+        lc_start[l] = st[l];
+        lc_len[l] = 0;
+        active[l] = 1;
+        for (unsigned int j = 0; j < N_Genes; ++j) { sc[j][l] = 0; }
+    }
+    const unsigned int nottarget = ~target & state_mask;
+    unsigned int nactive = L;
+    while (nactive > 0) {
+#pragma omp simd
+        for (unsigned int l = 0; l < L; ++l) {
+            unsigned int a = st[l] ^ nottarget;
+            for (unsigned int j = 0; j < N_Genes; ++j) {
+                sc[j][l] += active[l] & (a >> j);
+            }
+            lc_len[l] += active[l];
+            next[l] = st[l];
+        }
+        compute_next_batch (block, next);
+        nactive = 0;
+#pragma omp simd reduction(+:nactive)
+        for (unsigned int l = 0; l < L; ++l) {
+            st[l] = active[l] ? next[l] : st[l];
+            active[l] &= (st[l] != lc_start[l]) ? 1 : 0;
+            nactive += active[l];
+        }
+    }
+
+    for (unsigned int l = 0; l < L; ++l) {
+        score[l] = pow(static_cast<double>(lc_len[l]), -N_Genes);
+        for (unsigned int j = 0; j < N_Genes; ++j) {
+            score[l] *= static_cast<double>(sc[j][l]);
+        }
+    }
+}
+
+#if Genosect_Words == 1
+/*!
+ * FF4 can be evaluated for a block of genomes at once. The lanes of a block of WideGenosects
+ * can't be looked up with one vector operation, so those genomes are faster evaluated one at a
+ * time, by the evaluate_fitness_batch() in fitness.h.
+ */
+# define FF_HAS_BATCH_EVALUATION 1
+
+/*!
+ * evaluate_fitness() for each of the L genomes in block, writing the fitness of lane l to f[l].
+ */
+template <unsigned int L>
+void
+evaluate_fitness_batch (const GenomeBlock<L>& block, double* f)
+{
+    double pos_score[L];
+    evaluate_one_batch (block, initial_ant, target_ant, f);
+    evaluate_one_batch (block, initial_pos, target_pos, pos_score);
+    for (unsigned int l = 0; l < L; ++l) { f[l] *= pos_score[l]; }
+}
+#endif // Genosect_Words == 1
+
 /*
  * A version of evaluate_fitness which takes vectors of initial and target states and computes a
  * fitness score.
@@ -192,4 +336,6 @@ evaluate_fitness (array<genosect_t, N_Genes>& genome,
     return fitness;
 }
 
+SIM_NAMESPACE_END
+
 #endif // __FITNESS_FUNCTION__
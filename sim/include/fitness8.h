@@ -7,18 +7,30 @@
 
 #include <set>
 #include <array>
+#include "sim_namespace.h"
 
 using namespace std;
 
+SIM_NAMESPACE_BEGIN
+
 /*!
  * When working with states in a graph of nodes, it may be necessary
  * to use one bit to refer to the state as being unset; this is the
  * bit to use.
  */
 #define state_t_unset 0x80
+#if N_Genes > 7
+# error "state_t_unset (0x80) is a real state when N_Genes > 7, so this fitness function needs N_Genes <= 7"
+#endif
 
 #define FF_NAME "ff8"
 
+/*!
+ * The fitness depends only on the trajectories from initial_ant and
+ * initial_pos (see neighbourhood.h).
+ */
+#define FF_SCORES_TRAJECTORIES_ONLY 1
+
 // Evaluate the expression level of the limit cycle and return in the
 // array.
 array<double, N_Genes>
@@ -199,4 +211,6 @@ evaluate_fitness (array<genosect_t, N_Genes>& genome)
     return fitness;
 }
 
+SIM_NAMESPACE_END
+
 #endif // __FITNESS_FUNCTION__
@@ -0,0 +1,355 @@
+/*!
+ * Lookup tables of the Quine-McCluskey complexity and the canalysing
+ * value (from isCanalyzing()) of every possible genosect.
+ *
+ * For N_Ins <= 4 there are at most 65536 genosects, so both values are
+ * tabulated, one byte each. The tables can be saved to a file, which
+ * is memory-mapped when it's loaded again. By default the file is kept
+ * in the directory named by the environment variable FUNCTABLES_DIR,
+ * or else in a per-user cache directory (see defaultPath()). Once the
+ * tables are set up,
+ * canalyzingness() uses them too (via canal_table in lib.h).
+ *
+ * For N_Ins = 5 there are 2^32 genosects, which is too many to
+ * tabulate; instead, the complexity of each genosect is remembered in
+ * a fixed size, direct-mapped cache as it's computed. The cache may be
+ * shared between threads.
+ */
+
+#ifndef __FUNCTABLES_H__
+#define __FUNCTABLES_H__
+
+#include <string>
+#include <sstream>
+#include <vector>
+#include <atomic>
+#include <memory>
+#include <stdexcept>
+#include <cstring>
+#include <cstdio>
+#include <cstdlib>
+#include <cerrno>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include "quine.h"
+#include "sim_namespace.h"
+
+using namespace std;
+
+SIM_NAMESPACE_BEGIN
+
+#ifndef __LIB_H__
+#error "#include lib.h before #including functables.h so that genosect_t and isCanalyzing() are defined"
+#endif
+
+//! The largest N_Ins for which the tables are made
+#define FUNCTABLES_MAX_INS 4
+
+//! The cache has 2^FUNCTABLES_CACHE_BITS entries (for N_Ins = 5)
+#define FUNCTABLES_CACHE_BITS 20
+
+//! Identifies a function tables file. The last character is a version number, to be changed
+//! whenever the tabulated values would change.
+#define FUNCTABLES_MAGIC "BNFUNCT2"
+
+/*!
+ * The start of a function tables file. It's followed by the
+ * n_functions cover sizes, then the n_functions canalysing values.
+ */
+struct FunctionTablesHeader
+{
+    char magic[8];
+    unsigned int n_ins;
+    unsigned int n_functions;
+};
+
+class FunctionTables
+{
+public:
+    FunctionTables()
+        : n_functions(0)
+        , cover(0)
+        , canal(0)
+        , mapped(0)
+        , maplen(0)
+    {
+#if N_Ins <= FUNCTABLES_MAX_INS
+        this->n_functions = 1U << (1 << N_Ins);
+#endif
+    }
+
+    //! The tables may be memory-mapped, and canal_table may point into them, so they aren't copied
+    FunctionTables (const FunctionTables&) = delete;
+    FunctionTables& operator= (const FunctionTables&) = delete;
+
+    ~FunctionTables()
+    {
+        this->unmap();
+    }
+
+    /*!
+     * Set up the tables for use. For N_Ins <= 4, load them from the
+     * file at path if it exists, otherwise generate them and try to
+     * save them there (it doesn't matter if that fails). A file which
+     * can't be loaded (it's truncated, say, or for another N_Ins) is
+     * overwritten with the generated tables. For N_Ins = 5, allocate
+     * the cache.
+     */
+    void init (const string& path)
+    {
+#if N_Ins <= FUNCTABLES_MAX_INS
+        bool loaded = false;
+        try {
+            loaded = this->load (path);
+        } catch (const exception& e) {
+            LOG (e.what() << "; regenerating the function tables");
+        }
+        if (!loaded) {
+            this->generate();
+            try {
+                this->save (path);
+            } catch (const exception& e) {
+                DBG ("Not saving function tables: " << e.what());
+            }
+        }
+        canal_table = this->canal;
+#elif N_Ins == 5
+        if (!this->cache) {
+            this->cache.reset (new atomic<unsigned long long int>[1 << FUNCTABLES_CACHE_BITS]);
+            for (unsigned int i = 0; i < (1 << FUNCTABLES_CACHE_BITS); ++i) {
+                this->cache[i].store (0);
+            }
+        }
+#endif
+    }
+
+    /*!
+     * The default location of the tables file, which depends on N_Ins:
+     * in $FUNCTABLES_DIR if that's set, otherwise in
+     * $XDG_CACHE_HOME/boolnets or ~/.cache/boolnets, or failing those
+     * in /tmp. The directory needn't exist; save() makes it.
+     */
+    static string defaultPath (void)
+    {
+        string dir = "/tmp";
+        const char* e = getenv ("FUNCTABLES_DIR");
+        const char* xdg = getenv ("XDG_CACHE_HOME");
+        const char* home = getenv ("HOME");
+        if (e != (const char*)0 && e[0] != '\0') {
+            dir = e;
+        } else if (xdg != (const char*)0 && xdg[0] != '\0') {
+            dir = string(xdg) + "/boolnets";
+        } else if (home != (const char*)0 && home[0] != '\0') {
+            dir = string(home) + "/.cache/boolnets";
+        }
+        stringstream ss;
+        ss << dir << "/functables_k" << N_Ins << ".bin";
+        return ss.str();
+    }
+
+    //! Compute the tables (in memory)
+    void generate (void)
+    {
+        if (this->n_functions == 0) {
+            throw runtime_error ("FunctionTables: there are too many genosects to tabulate");
+        }
+        this->unmap();
+        if (canal_table == this->canal) {
+            canal_table = (const unsigned char*)0;
+        }
+        this->storage.resize (2 * this->n_functions);
+        for (unsigned int f = 0; f < this->n_functions; ++f) {
+            Quine Q(N_Ins);
+            Q.setFunction (f);
+            Q.go();
+            this->storage[f] = static_cast<unsigned char>(Q.coverSize());
+            this->storage[this->n_functions + f] = static_cast<unsigned char>(isCanalyzing (static_cast<genosect_t>(f)));
+        }
+        this->cover = &this->storage[0];
+        this->canal = &this->storage[this->n_functions];
+    }
+
+    /*!
+     * Write the tables to the file at path, making its directory if
+     * need be. They're written to a temporary file which is then
+     * renamed, so that another process which has the old file mapped
+     * keeps a valid mapping.
+     */
+    void save (const string& path) const
+    {
+        if (!this->cover) {
+            throw runtime_error ("FunctionTables: no tables to save");
+        }
+        FunctionTablesHeader hdr;
+        memcpy (hdr.magic, FUNCTABLES_MAGIC, 8);
+        hdr.n_ins = N_Ins;
+        hdr.n_functions = this->n_functions;
+
+        FunctionTables::makeDirs (path.substr (0, path.find_last_of ('/') + 1));
+        stringstream tss;
+        tss << path << ".tmp" << getpid();
+        string tmp = tss.str();
+        FILE* f = fopen (tmp.c_str(), "wb");
+        if (f == (FILE*)0) {
+            throw runtime_error ("FunctionTables: failed to open " + tmp + " for writing");
+        }
+        bool ok = (fwrite (&hdr, sizeof(hdr), 1, f) == 1
+                   && fwrite (this->cover, 1, this->n_functions, f) == this->n_functions
+                   && fwrite (this->canal, 1, this->n_functions, f) == this->n_functions);
+        ok = (fclose (f) == 0) && ok;
+        if (!ok || rename (tmp.c_str(), path.c_str()) != 0) {
+            remove (tmp.c_str());
+            throw runtime_error ("FunctionTables: failed to write " + path);
+        }
+    }
+
+    /*!
+     * Memory-map the tables from the file at path. Returns false if
+     * the file doesn't exist or was made by another version of this
+     * code; throws if it isn't a tables file for this N_Ins.
+     */
+    bool load (const string& path)
+    {
+        if (this->n_functions == 0) {
+            return false;
+        }
+        int fd = open (path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            return false;
+        }
+        struct stat st;
+        size_t len = sizeof(FunctionTablesHeader) + 2 * this->n_functions;
+        if (fstat (fd, &st) != 0 || static_cast<size_t>(st.st_size) != len) {
+            close (fd);
+            throw runtime_error ("FunctionTables: " + path + " is the wrong size");
+        }
+        void* m = mmap (0, len, PROT_READ, MAP_SHARED, fd, 0);
+        close (fd);
+        if (m == MAP_FAILED) {
+            throw runtime_error ("FunctionTables: failed to map " + path);
+        }
+        const FunctionTablesHeader* hdr = static_cast<const FunctionTablesHeader*>(m);
+        if (memcmp (hdr->magic, FUNCTABLES_MAGIC, 7) == 0 && memcmp (hdr->magic, FUNCTABLES_MAGIC, 8) != 0) {
+            // Made by another version of this code, so ignore it (and init() will overwrite it)
+            munmap (m, len);
+            return false;
+        }
+        if (memcmp (hdr->magic, FUNCTABLES_MAGIC, 8) != 0
+            || hdr->n_ins != N_Ins || hdr->n_functions != this->n_functions) {
+            munmap (m, len);
+            throw runtime_error ("FunctionTables: " + path + " is not a function tables file for this N_Ins");
+        }
+
+        this->unmap();
+        this->storage.clear();
+        this->mapped = m;
+        this->maplen = len;
+        this->cover = static_cast<const unsigned char*>(m) + sizeof(FunctionTablesHeader);
+        this->canal = this->cover + this->n_functions;
+        return true;
+    }
+
+    /*!
+     * The number of prime implicants in a minimal sum of products for
+     * the genosect gs.
+     */
+    unsigned int coverSize (genosect_t gs)
+    {
+        if (this->cover) {
+            return this->cover[gs];
+        }
+#if N_Ins == 5
+        if (this->cache) {
+            // An entry holds the genosect in the upper 32 bits, then the cover size plus one.
+            unsigned long long int key = static_cast<unsigned long long int>(gs);
+            unsigned int slot = static_cast<unsigned int>((key * 0x9e3779b97f4a7c15ULL) >> (64 - FUNCTABLES_CACHE_BITS));
+            unsigned long long int entry = this->cache[slot].load (memory_order_relaxed);
+            if ((entry >> 32) == key && (entry & 0xff) != 0) {
+                return static_cast<unsigned int>(entry & 0xff) - 1;
+            }
+            unsigned int c = FunctionTables::computeCoverSize (gs);
+            this->cache[slot].store ((key << 32) | (c + 1), memory_order_relaxed);
+            return c;
+        }
+#endif
+        return FunctionTables::computeCoverSize (gs);
+    }
+
+    /*!
+     * The complexity of the genosect gs, as given by Quine::complexity()
+     * for the function of N_Genes variables which complexity_random has
+     * always used (for k=n-1, the extra input is fixed at 0, which
+     * doesn't change the number of prime implicants).
+     */
+    double complexity (genosect_t gs)
+    {
+        return (double)this->coverSize (gs) / (double)(1 << N_Genes);
+    }
+
+    //! The canalysing value of gs, as returned by isCanalyzing()
+    unsigned int canalyzing (genosect_t gs) const
+    {
+        return this->canal ? this->canal[gs] : isCanalyzing (gs);
+    }
+
+private:
+    //! Make the directory dir and any of its parents which don't exist
+    static void makeDirs (const string& dir)
+    {
+        for (size_t i = 1; i <= dir.size(); ++i) {
+            if (i == dir.size() || dir[i] == '/') {
+                string d = dir.substr (0, i);
+                if (mkdir (d.c_str(), 0755) != 0 && errno != EEXIST) {
+                    throw runtime_error ("FunctionTables: failed to make the directory " + d);
+                }
+            }
+        }
+    }
+
+    static unsigned int computeCoverSize (genosect_t gs)
+    {
+        Quine Q(N_Ins);
+        Q.setFunction (static_cast<unsigned long long int>(gs));
+        Q.go();
+        return Q.coverSize();
+    }
+
+    void unmap (void)
+    {
+        if (this->mapped) {
+            if (canal_table == this->canal) {
+                canal_table = (const unsigned char*)0;
+            }
+            munmap (this->mapped, this->maplen);
+            this->mapped = 0;
+            this->maplen = 0;
+            this->cover = 0;
+            this->canal = 0;
+        }
+    }
+
+    //! The number of genosects in the tables (0 if they're not tabulated)
+    unsigned int n_functions;
+
+    //! The tables, either in storage or in the mapped file
+    const unsigned char* cover;
+    const unsigned char* canal;
+    vector<unsigned char> storage;
+    void* mapped;
+    size_t maplen;
+
+    //! The cache, for N_Ins = 5
+    unique_ptr<atomic<unsigned long long int>[]> cache;
+};
+
+/*!
+ * The tables; call functables.init() before use.
+ */
+FunctionTables functables;
+
+SIM_NAMESPACE_END
+
+#endif // __FUNCTABLES_H__
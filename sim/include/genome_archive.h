@@ -0,0 +1,373 @@
+/*!
+ * A packed binary file format for collections of genomes, which is a
+ * fraction of the size of the Dan strings or genome_ids and can be
+ * read at random.
+ *
+ * A genome archive (by convention, a .bng file) is a header, recording
+ * N_Genes, N_Ins and the length of a record, followed by one record per
+ * genome. A record is the Genome_Packed_Len bytes written by
+ * genome2packed(), so genome i starts at byte
+ * sizeof(GenomeArchiveHeader) + i * Genome_Packed_Len. The number of
+ * genomes isn't stored; it follows from the size of the file, so that
+ * appending is just writing more records to the end.
+ *
+ * GenomeArchiveReader memory-maps an archive, giving each genome in
+ * constant time. GenomeArchiveWriter creates or appends to one. Each
+ * owns its mapping or open file, so they may be moved but not copied.
+ */
+
+#ifndef __GENOME_ARCHIVE_H__
+#define __GENOME_ARCHIVE_H__
+
+#include <string>
+#include <vector>
+#include <array>
+#include <stdexcept>
+#include <cstring>
+#include <cstdio>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include "sim_namespace.h"
+
+using namespace std;
+
+SIM_NAMESPACE_BEGIN
+
+#ifndef __LIB_H__
+#error "#include lib.h before #including genome_archive.h so that genome2packed() is defined"
+#endif
+
+//! Identifies a genome archive. The last character is the version of the format.
+#define GENOME_ARCHIVE_MAGIC "BNGENOM1"
+
+/*!
+ * The start of a genome archive.
+ */
+struct GenomeArchiveHeader
+{
+    char magic[8];
+    unsigned int n_genes;
+    unsigned int n_ins;
+    //! The number of bytes in each record
+    unsigned int record_len;
+    unsigned int reserved;
+};
+
+/*!
+ * Check that hdr is the header of a genome archive for this N_Genes and
+ * N_Ins, throwing if not. path is for the error message.
+ */
+void
+genome_archive_check_header (const GenomeArchiveHeader& hdr, const string& path)
+{
+    if (memcmp (hdr.magic, GENOME_ARCHIVE_MAGIC, 8) != 0) {
+        throw runtime_error ("GenomeArchive: " + path + " is not a genome archive");
+    }
+    if (hdr.n_genes != N_Genes || hdr.n_ins != N_Ins || hdr.record_len != Genome_Packed_Len) {
+        stringstream ee;
+        ee << "GenomeArchive: " << path << " holds genomes with N_Genes=" << hdr.n_genes
+           << ", N_Ins=" << hdr.n_ins << ", not N_Genes=" << N_Genes << ", N_Ins=" << N_Ins;
+        throw runtime_error (ee.str());
+    }
+}
+
+class GenomeArchiveReader
+{
+public:
+    GenomeArchiveReader()
+        : mapped(0)
+        , maplen(0)
+        , records(0)
+        , n_records(0)
+    {
+    }
+
+    GenomeArchiveReader (const string& path)
+        : mapped(0)
+        , maplen(0)
+        , records(0)
+        , n_records(0)
+    {
+        this->open (path);
+    }
+
+    GenomeArchiveReader (const GenomeArchiveReader&) = delete;
+    GenomeArchiveReader& operator= (const GenomeArchiveReader&) = delete;
+
+    GenomeArchiveReader (GenomeArchiveReader&& other)
+        : mapped(other.mapped)
+        , maplen(other.maplen)
+        , records(other.records)
+        , n_records(other.n_records)
+    {
+        other.release();
+    }
+
+    GenomeArchiveReader& operator= (GenomeArchiveReader&& other)
+    {
+        if (this != &other) {
+            this->close();
+            this->mapped = other.mapped;
+            this->maplen = other.maplen;
+            this->records = other.records;
+            this->n_records = other.n_records;
+            other.release();
+        }
+        return *this;
+    }
+
+    ~GenomeArchiveReader()
+    {
+        this->close();
+    }
+
+    //! Memory-map the archive at path. Throws if it can't be read or isn't for this N_Genes.
+    void open (const string& path)
+    {
+        this->close();
+        int fd = ::open (path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            throw runtime_error ("GenomeArchiveReader: failed to open " + path);
+        }
+        struct stat st;
+        if (fstat (fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(GenomeArchiveHeader)) {
+            ::close (fd);
+            throw runtime_error ("GenomeArchiveReader: " + path + " is too short to be a genome archive");
+        }
+        size_t len = static_cast<size_t>(st.st_size);
+        void* m = mmap (0, len, PROT_READ, MAP_SHARED, fd, 0);
+        ::close (fd);
+        if (m == MAP_FAILED) {
+            throw runtime_error ("GenomeArchiveReader: failed to map " + path);
+        }
+        try {
+            genome_archive_check_header (*static_cast<const GenomeArchiveHeader*>(m), path);
+        } catch (...) {
+            munmap (m, len);
+            throw;
+        }
+        this->mapped = m;
+        this->maplen = len;
+        this->records = static_cast<const unsigned char*>(m) + sizeof(GenomeArchiveHeader);
+        // A partly written last record (from an interrupted append) is ignored
+        this->n_records = (len - sizeof(GenomeArchiveHeader)) / Genome_Packed_Len;
+    }
+
+    void close (void)
+    {
+        if (this->mapped) {
+            munmap (this->mapped, this->maplen);
+            this->mapped = 0;
+            this->maplen = 0;
+            this->records = 0;
+            this->n_records = 0;
+        }
+    }
+
+    //! The number of genomes in the archive
+    size_t size (void) const { return this->n_records; }
+
+    //! Read genome i into genome
+    void get (size_t i, array<genosect_t, N_Genes>& genome) const
+    {
+        if (i >= this->n_records) {
+            throw out_of_range ("GenomeArchiveReader: no such genome");
+        }
+        packed2genome (this->records + i * Genome_Packed_Len, genome);
+    }
+
+    //! Return genome i
+    array<genosect_t, N_Genes> get (size_t i) const
+    {
+        array<genosect_t, N_Genes> genome;
+        this->get (i, genome);
+        return genome;
+    }
+
+    //! Read the n genomes from first into genomes
+    void get (size_t first, size_t n, array<genosect_t, N_Genes>* genomes) const
+    {
+        if (first > this->n_records || n > this->n_records - first) {
+            throw out_of_range ("GenomeArchiveReader: no such genomes");
+        }
+        packed2genomes (this->records + first * Genome_Packed_Len, n, genomes);
+    }
+
+private:
+    //! Forget the mapping without unmapping it (it has been moved to another reader)
+    void release (void)
+    {
+        this->mapped = 0;
+        this->maplen = 0;
+        this->records = 0;
+        this->n_records = 0;
+    }
+
+    void* mapped;
+    size_t maplen;
+    //! The first record in the mapped file
+    const unsigned char* records;
+    size_t n_records;
+};
+
+class GenomeArchiveWriter
+{
+public:
+    GenomeArchiveWriter()
+        : fp((FILE*)0)
+        , n_records(0)
+    {
+    }
+
+    GenomeArchiveWriter (const string& path, bool truncate = false)
+        : fp((FILE*)0)
+        , n_records(0)
+    {
+        this->open (path, truncate);
+    }
+
+    GenomeArchiveWriter (const GenomeArchiveWriter&) = delete;
+    GenomeArchiveWriter& operator= (const GenomeArchiveWriter&) = delete;
+
+    GenomeArchiveWriter (GenomeArchiveWriter&& other)
+        : fp(other.fp)
+        , n_records(other.n_records)
+    {
+        this->path.swap (other.path);
+        this->buf.swap (other.buf);
+        other.fp = (FILE*)0;
+        other.n_records = 0;
+    }
+
+    GenomeArchiveWriter& operator= (GenomeArchiveWriter&& other)
+    {
+        if (this != &other) {
+            this->close();
+            this->fp = other.fp;
+            this->path.swap (other.path);
+            this->n_records = other.n_records;
+            this->buf.swap (other.buf);
+            other.fp = (FILE*)0;
+            other.n_records = 0;
+        }
+        return *this;
+    }
+
+    ~GenomeArchiveWriter()
+    {
+        if (this->fp) {
+            fclose (this->fp);
+        }
+    }
+
+    /*!
+     * Open the archive at path for appending, creating it if it doesn't
+     * exist (or if truncate is true). Throws if an existing archive is
+     * for another N_Genes. A partly written last record is discarded.
+     */
+    void open (const string& path, bool truncate = false)
+    {
+        this->close();
+        this->path = path;
+        this->n_records = 0;
+
+        struct stat st;
+        if (!truncate && stat (path.c_str(), &st) == 0 && st.st_size > 0) {
+            FILE* f = fopen (path.c_str(), "rb");
+            GenomeArchiveHeader hdr;
+            bool ok = (f != (FILE*)0) && fread (&hdr, sizeof(hdr), 1, f) == 1;
+            if (f) { fclose (f); }
+            if (!ok) {
+                throw runtime_error ("GenomeArchiveWriter: " + path + " is too short to be a genome archive");
+            }
+            genome_archive_check_header (hdr, path);
+            size_t len = static_cast<size_t>(st.st_size) - sizeof(GenomeArchiveHeader);
+            this->n_records = len / Genome_Packed_Len;
+            off_t whole = static_cast<off_t>(sizeof(GenomeArchiveHeader) + this->n_records * Genome_Packed_Len);
+            if (len % Genome_Packed_Len != 0 && ::truncate (path.c_str(), whole) != 0) {
+                throw runtime_error ("GenomeArchiveWriter: failed to remove a partial record from " + path);
+            }
+            this->fp = fopen (path.c_str(), "ab");
+            if (this->fp == (FILE*)0) {
+                throw runtime_error ("GenomeArchiveWriter: failed to open " + path + " for appending");
+            }
+            return;
+        }
+
+        this->fp = fopen (path.c_str(), "wb");
+        if (this->fp == (FILE*)0) {
+            throw runtime_error ("GenomeArchiveWriter: failed to open " + path + " for writing");
+        }
+        GenomeArchiveHeader hdr;
+        memset (&hdr, 0, sizeof(hdr));
+        memcpy (hdr.magic, GENOME_ARCHIVE_MAGIC, 8);
+        hdr.n_genes = N_Genes;
+        hdr.n_ins = N_Ins;
+        hdr.record_len = Genome_Packed_Len;
+        if (fwrite (&hdr, sizeof(hdr), 1, this->fp) != 1) {
+            throw runtime_error ("GenomeArchiveWriter: failed to write to " + path);
+        }
+    }
+
+    //! Append genome to the archive
+    void append (const array<genosect_t, N_Genes>& genome)
+    {
+        unsigned char buf[Genome_Packed_Len];
+        genome2packed (genome, buf);
+        this->write (buf, 1);
+    }
+
+    //! Append the n genomes to the archive
+    void append (const array<genosect_t, N_Genes>* genomes, size_t n)
+    {
+        this->buf.resize (n * Genome_Packed_Len);
+        genomes2packed (genomes, n, this->buf.data());
+        this->write (this->buf.data(), n);
+    }
+
+    //! The number of genomes in the archive, including those appended
+    size_t size (void) const { return this->n_records; }
+
+    void flush (void)
+    {
+        if (this->fp && fflush (this->fp) != 0) {
+            throw runtime_error ("GenomeArchiveWriter: failed to write to " + this->path);
+        }
+    }
+
+    void close (void)
+    {
+        if (this->fp) {
+            int rtn = fclose (this->fp);
+            this->fp = (FILE*)0;
+            if (rtn != 0) {
+                throw runtime_error ("GenomeArchiveWriter: failed to write to " + this->path);
+            }
+        }
+    }
+
+private:
+    void write (const unsigned char* records, size_t n)
+    {
+        if (this->fp == (FILE*)0) {
+            throw runtime_error ("GenomeArchiveWriter: no archive is open");
+        }
+        if (fwrite (records, Genome_Packed_Len, n, this->fp) != n) {
+            throw runtime_error ("GenomeArchiveWriter: failed to write to " + this->path);
+        }
+        this->n_records += n;
+    }
+
+    FILE* fp;
+    string path;
+    size_t n_records;
+    //! Packed records for append()
+    vector<unsigned char> buf;
+};
+
+SIM_NAMESPACE_END
+
+#endif // __GENOME_ARCHIVE_H__
@@ -0,0 +1,118 @@
+/*!
+ * A set of genomes (or genome-shaped flip masks) which may be
+ * inserted into from several threads at once. It's an open
+ * addressing hash table with linear probing, sized once on
+ * construction, so that there's no rehashing and no heap allocation
+ * per insertion (unlike a set<array<genosect_t, N_Genes> >).
+ */
+
+#ifndef __GENOMESET_H__
+#define __GENOMESET_H__
+
+#include <array>
+#include <vector>
+#include <atomic>
+#include <memory>
+#include <stdexcept>
+#include "sim_namespace.h"
+
+using namespace std;
+
+SIM_NAMESPACE_BEGIN
+
+#ifndef __LIB_H__
+#error "#include lib.h before #including genomeset.h so that genosect_t and N_Genes are defined"
+#endif
+
+/*!
+ * States for each slot in the hash table.
+ */
+#define GENOMESET_EMPTY   0x0
+#define GENOMESET_WRITING 0x1
+#define GENOMESET_FULL    0x2
+
+class ConcurrentGenomeSet
+{
+public:
+    /*!
+     * Construct with room for max_entries genomes. The table is made
+     * at least twice this size to keep the probe sequences short.
+     */
+    ConcurrentGenomeSet (size_t max_entries)
+    {
+        this->capacity = 64;
+        while (this->capacity < 2 * max_entries) {
+            this->capacity <<= 1;
+        }
+        this->mask = this->capacity - 1;
+        this->keys.resize (this->capacity);
+        this->slots.reset (new atomic<unsigned char>[this->capacity]);
+        for (size_t i = 0; i < this->capacity; ++i) {
+            this->slots[i].store (GENOMESET_EMPTY);
+        }
+        this->count.store (0);
+    }
+
+    /*!
+     * Insert g into the set. Returns true if g was not already in the
+     * set (and so has been inserted by this call), false if it was.
+     */
+    bool insert (const array<genosect_t, N_Genes>& g)
+    {
+        size_t i = ConcurrentGenomeSet::hash (g) & this->mask;
+        for (;;) {
+            unsigned char s = this->slots[i].load (memory_order_acquire);
+            if (s == GENOMESET_EMPTY) {
+                unsigned char expected = GENOMESET_EMPTY;
+                if (this->slots[i].compare_exchange_strong (expected, GENOMESET_WRITING,
+                                                            memory_order_acq_rel)) {
+                    if (this->count.fetch_add (1) >= this->capacity - 1) {
+                        throw runtime_error ("ConcurrentGenomeSet is full");
+                    }
+                    this->keys[i] = g;
+                    this->slots[i].store (GENOMESET_FULL, memory_order_release);
+                    return true;
+                }
+                s = expected;
+            }
+            // Another thread may be part way through writing this slot; wait for it.
+            while (s == GENOMESET_WRITING) {
+                s = this->slots[i].load (memory_order_acquire);
+            }
+            if (this->keys[i] == g) {
+                return false;
+            }
+            i = (i + 1) & this->mask;
+        }
+    }
+
+    //! The number of genomes in the set
+    size_t size (void) const { return this->count.load(); }
+
+    /*!
+     * Mix the bits of the genome into a hash value (the finaliser
+     * from splitmix64, applied after each genosect).
+     */
+    static size_t hash (const array<genosect_t, N_Genes>& g)
+    {
+        unsigned long long int h = 0x9e3779b97f4a7c15ULL;
+        for (unsigned int i = 0; i < N_Genes; ++i) {
+            h ^= static_cast<unsigned long long int>(g[i]);
+            h = (h ^ (h >> 30)) * 0xbf58476d1ce4e5b9ULL;
+            h = (h ^ (h >> 27)) * 0x94d049bb133111ebULL;
+            h ^= (h >> 31);
+        }
+        return static_cast<size_t>(h);
+    }
+
+private:
+    size_t capacity;
+    size_t mask;
+    vector<array<genosect_t, N_Genes> > keys;
+    unique_ptr<atomic<unsigned char>[]> slots;
+    atomic<size_t> count;
+};
+
+SIM_NAMESPACE_END
+
+#endif // __GENOMESET_H__
@@ -0,0 +1,174 @@
+/*!
+ * The layers of the n dimensional boolean hypercube, as used by
+ * dimension_tree. Layer k holds the nodes with k set bits, and a
+ * transition joins a node in layer k-1 to one in layer k which differs
+ * from it in a single bit.
+ *
+ * Nothing here stores a whole layer. The nodes of a layer are generated
+ * in ascending order by stepping from one k-bit number to the next, and
+ * the transitions out of a node by setting each of its clear bits in
+ * turn, so that the cost is proportional to the size of the output.
+ * Paths are counted by dynamic programming, layer by layer, over the
+ * nodes below a target, rather than by listing them.
+ */
+
+#ifndef __HYPERCUBE_H__
+#define __HYPERCUBE_H__
+
+#include <vector>
+#include <string>
+#include <algorithm>
+#include "sim_namespace.h"
+
+using namespace std;
+
+SIM_NAMESPACE_BEGIN
+
+/*!
+ * A node of the hypercube. 32 bits is plenty; the transitions of an
+ * n=24 space already run to 2x10^8.
+ */
+typedef unsigned int node_t;
+
+//! The largest n that the hypercube functions accept
+#define Hypercube_Max_N 31
+
+//! A path count. 24! is about 6x10^23, too big for 64 bits.
+typedef unsigned __int128 pathcount_t;
+
+/*!
+ * The next number after x with the same number of set bits. x must be
+ * non-zero.
+ */
+inline node_t
+hypercube_next_node (node_t x)
+{
+    node_t lowest = x & -x;
+    node_t ripple = x + lowest;
+    return ripple | (((x ^ ripple) >> 2) / lowest);
+}
+
+/*!
+ * Call fn(node) for each node in layer k of the n dimensional
+ * hypercube, in ascending order.
+ */
+template <typename Fn>
+void
+hypercube_layer (unsigned int n, unsigned int k, Fn fn)
+{
+    if (k > n) {
+        return;
+    }
+    if (k == 0) {
+        fn ((node_t)0);
+        return;
+    }
+    node_t x = (node_t)((1ULL << k) - 1);
+    const node_t last = x << (n - k);
+    for (;;) {
+        fn (x);
+        if (x == last) {
+            break;
+        }
+        x = hypercube_next_node (x);
+    }
+}
+
+/*!
+ * Call fn(from, to) for each transition from layer k-1 into layer k of
+ * the n dimensional hypercube, ordered by from and then by to.
+ */
+template <typename Fn>
+void
+hypercube_transitions (unsigned int n, unsigned int k, Fn fn)
+{
+    if (k == 0 || k > n) {
+        return;
+    }
+    hypercube_layer (n, k - 1, [n, &fn](node_t from) {
+        for (unsigned int b = 0; b < n; ++b) {
+            node_t bit = (node_t)1 << b;
+            if (!(from & bit)) {
+                fn (from, from | bit);
+            }
+        }
+    });
+}
+
+/*!
+ * Count the paths from node 0 to target which set one bit at a time.
+ * The count for each node below target is the sum of the counts of the
+ * nodes one bit below it, worked out one layer at a time. Layers are
+ * held as sorted arrays of the nodes below target, so the memory is
+ * that of the two largest adjacent layers. If layer_paths is non-null,
+ * it is filled with the total count of paths into each layer, 0 to
+ * popcount(target).
+ */
+inline pathcount_t
+hypercube_count_paths (node_t target, vector<pathcount_t>* layer_paths = (vector<pathcount_t>*)0)
+{
+    const unsigned int h = __builtin_popcount (target);
+    // The set bits of target, which are the only ones a path can set
+    vector<node_t> bits;
+    for (unsigned int b = 0; b < 32; ++b) {
+        if (target & ((node_t)1 << b)) { bits.push_back ((node_t)1 << b); }
+    }
+
+    vector<node_t> prev_nodes (1, 0), nodes;
+    vector<pathcount_t> prev_counts (1, 1), counts;
+    if (layer_paths) {
+        layer_paths->assign (1, 1);
+    }
+    for (unsigned int k = 1; k <= h; ++k) {
+        // Layer k of the h dimensional cube, spread out onto the set bits of target
+        nodes.clear();
+        counts.clear();
+        pathcount_t total = 0;
+        hypercube_layer (h, k, [&](node_t c) {
+            node_t v = 0;
+            for (unsigned int i = 0; i < h; ++i) {
+                if (c & ((node_t)1 << i)) { v |= bits[i]; }
+            }
+            nodes.push_back (v);
+        });
+        // Spreading out preserves the order of the nodes
+        for (node_t v : nodes) {
+            pathcount_t cnt = 0;
+            for (unsigned int i = 0; i < h; ++i) {
+                if (v & bits[i]) {
+                    node_t u = v ^ bits[i];
+                    vector<node_t>::const_iterator pu = lower_bound (prev_nodes.begin(), prev_nodes.end(), u);
+                    cnt += prev_counts[pu - prev_nodes.begin()];
+                }
+            }
+            counts.push_back (cnt);
+            total += cnt;
+        }
+        if (layer_paths) {
+            layer_paths->push_back (total);
+        }
+        prev_nodes.swap (nodes);
+        prev_counts.swap (counts);
+    }
+    return prev_counts[0];
+}
+
+//! The decimal representation of a path count
+inline string
+pathcount_str (pathcount_t c)
+{
+    if (c == 0) {
+        return string("0");
+    }
+    string s;
+    while (c > 0) {
+        s.push_back ('0' + (char)(c % 10));
+        c /= 10;
+    }
+    reverse (s.begin(), s.end());
+    return s;
+}
+
+SIM_NAMESPACE_END
+
+#endif // __HYPERCUBE_H__
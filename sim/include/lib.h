@@ -13,6 +13,7 @@
 #include <iostream>
 #include <sstream>
 #include <stdlib.h>
+#include <string.h>
 #include <vector>
 #include <bitset>
 #include <list>
@@ -21,12 +22,17 @@
 
 // Using rng.h for random numbers means that RngData has to be properly set up in evolve_json.cpp etc.
 #include "rng.h"
+// The genosect_t for N_Ins > 6
+#include "wide_genosect.h"
+#include "sim_namespace.h"
 #define DUMMYARG 11
 // To avoid use of RngData:
 //#define USE_SIMPLE_RAND 1
 
 using namespace std;
 
+SIM_NAMESPACE_BEGIN
+
 /*!
  * Debugging/informational macros.
  */
@@ -71,20 +77,20 @@ using namespace std;
 /*!
  * The genome has a section for each gene. The length of the
  * section of each gene is 2^N_Ins. 32 bit width sections are
- * enough for N_Genes <= 6. 64 bit width sections ok for N_Genes <= 7.
+ * enough for N_Ins <= 5, 64 bit sections for N_Ins == 6. Wider
+ * sections (N_Ins >= 7, as for N_Genes=7 with k=n or N_Genes=8) are
+ * WideGenosects of Genosect_Words 64 bit words.
  */
-#if N_Genes == 7 // or N_Genes == 6 and N_Ins_EQUALS_N_Genes
+#if N_Ins > 6
+# define Genosect_Words (1 << (N_Ins - 6))
+typedef WideGenosect<Genosect_Words> genosect_t;
+# define GENOSECT_ONE (genosect_t(0x1ULL))
+#elif N_Ins == 6
+# define Genosect_Words 1
 typedef unsigned long long int genosect_t;
 # define GENOSECT_ONE 0x1ULL
-#elif N_Genes == 6
-# if defined N_Ins_EQUALS_N_Genes
-typedef unsigned long long int genosect_t;
-#  define GENOSECT_ONE 0x1ULL
-# else
-typedef unsigned int genosect_t;
-#  define GENOSECT_ONE 0x1UL
-# endif
 #else
+# define Genosect_Words 1
 typedef unsigned int genosect_t;
 # define GENOSECT_ONE 0x1UL
 #endif
@@ -96,16 +102,79 @@ typedef unsigned int genosect_t;
 #define Genosect_Width (1 << N_Ins)
 
 /*!
- * The state has N_Genes bits in it. Working with N_Genes <= 8, so:
+ * Single bit and byte access to a genosect, the same for integer and
+ * wide genosects; for a WideGenosect each touches one word only.
  */
+//@{
+#if Genosect_Words > 1
+//! Bit j (0 or 1) of gs
+inline unsigned int genosect_bit (const genosect_t& gs, unsigned int j)
+{
+    return (unsigned int)((gs.w[j >> 6] >> (j & 63)) & 0x1ULL);
+}
+//! Flip bit j of gs
+inline void genosect_flip (genosect_t& gs, unsigned int j)
+{
+    gs.w[j >> 6] ^= 0x1ULL << (j & 63);
+}
+//! The number of set bits in gs
+inline unsigned int genosect_popcount (const genosect_t& gs)
+{
+    unsigned int n = 0;
+    for (unsigned int k = 0; k < Genosect_Words; ++k) { n += (unsigned int)_mm_popcnt_u64 (gs.w[k]); }
+    return n;
+}
+//! Byte b of gs
+inline unsigned int genosect_byte (const genosect_t& gs, unsigned int b)
+{
+    return (unsigned int)((gs.w[b >> 3] >> (8 * (b & 7))) & 0xffULL);
+}
+//! Bitwise or the byte value v into byte b of gs
+inline void genosect_or_byte (genosect_t& gs, unsigned int b, unsigned int v)
+{
+    gs.w[b >> 3] |= (unsigned long long int)v << (8 * (b & 7));
+}
+#else
+inline unsigned int genosect_bit (const genosect_t& gs, unsigned int j)
+{
+    return (unsigned int)((gs >> j) & 0x1);
+}
+inline void genosect_flip (genosect_t& gs, unsigned int j)
+{
+    gs ^= GENOSECT_ONE << j;
+}
+inline unsigned int genosect_popcount (const genosect_t& gs)
+{
+    return (unsigned int)_mm_popcnt_u64 ((unsigned long long int)gs);
+}
+inline unsigned int genosect_byte (const genosect_t& gs, unsigned int b)
+{
+    return (unsigned int)((gs >> (8 * b)) & 0xff);
+}
+inline void genosect_or_byte (genosect_t& gs, unsigned int b, unsigned int v)
+{
+    gs |= (genosect_t)v << (8 * b);
+}
+#endif
+//@}
+
+/*!
+ * The state has N_Genes bits in it. An unsigned char for N_Genes <= 8
+ * and an unsigned short for up to 16 (though the genome of more than
+ * 10 genes is impractically large).
+ */
+#if N_Genes > 8
+typedef unsigned short state_t;
+#else
 typedef unsigned char state_t;
+#endif
 
 /*!
  * When right-shifting the hi_mask, we need to set the top bit to 1,
  * because right-shifting an unsigned integer number always zero-fills
  * by default.
  */
-#define state_t_top_bit 0x80
+#define state_t_top_bit ((state_t)(1U << (8 * sizeof(state_t) - 1)))
 
 /*!
  * Probability of flipping each bit of the genome during evolution.
@@ -120,8 +189,8 @@ float pOn;
  * input containing N_Genes-1 bits. Must be set up using masks_init().
  */
 //@{
-unsigned char lo_mask_start;
-unsigned char hi_mask_start;
+state_t lo_mask_start;
+state_t hi_mask_start;
 //@}
 
 /*!
@@ -155,8 +224,17 @@ state_t target_pos = 0x15; // 010101
 #elif N_Genes == 7
 state_t target_ant = 0x55; // 1010101
 state_t target_pos = 0x2a; // 0101010
-#elif N_Genes > 7
-# error "You'll need to set up target_ant/target_pos suitably for N_Genes > 7. Also consider the type for genosect_t. Finally, check up on state_t_unset in basins.h to go to N_Genes==8 or higher."
+#elif N_Genes == 8
+state_t target_ant = 0xaa; // 10101010
+state_t target_pos = 0x55; // 01010101
+#elif N_Genes == 9
+state_t target_ant = 0x155; // 101010101
+state_t target_pos = 0xaa;  // 010101010
+#elif N_Genes == 10
+state_t target_ant = 0x2aa; // 1010101010
+state_t target_pos = 0x155; // 0101010101
+#elif N_Genes > 10
+# error "You'll need to set up target_ant/target_pos suitably for N_Genes > 10."
 #else
 # error "You'll need to set up target_ant/target_pos suitably for N_Genes < 3"
 #endif
@@ -178,6 +256,15 @@ state_t initial_pos = 0x0;  // 000000b;
 #elif N_Genes == 7
 state_t initial_ant = 0x40; // 1000000b;
 state_t initial_pos = 0x0;  // 0000000b;
+#elif N_Genes == 8
+state_t initial_ant = 0x80; // 10000000b;
+state_t initial_pos = 0x0;  // 00000000b;
+#elif N_Genes == 9
+state_t initial_ant = 0x100; // 100000000b;
+state_t initial_pos = 0x0;   // 000000000b;
+#elif N_Genes == 10
+state_t initial_ant = 0x200; // 1000000000b;
+state_t initial_pos = 0x0;   // 0000000000b;
 #endif
 
 /*!
@@ -211,6 +298,27 @@ randDouble (void)
 #endif
 }
 
+/*!
+ * Return a random single precision number between 0 and 1, drawn
+ * from the passed-in RngData, rather than the global rd. For use in
+ * threaded code, where each thread has its own RngData.
+ */
+float
+randFloat (RngData* _rd)
+{
+    return static_cast<float>(UNI(_rd));
+}
+
+/*!
+ * Return a random double precision number between 0 and 1 from the
+ * passed-in RngData.
+ */
+double
+randDouble (RngData* _rd)
+{
+    return static_cast<double>(UNI_D(_rd));
+}
+
 /*!
  * Initialise the masks based on the value of N_Genes
  */
@@ -228,11 +336,11 @@ masks_init (void)
     for (unsigned int i = 0; i < N_Ins; ++i) {
         lo_mask_start |= 0x1 << i;
     }
-    hi_mask_start = 0xff & (0xff << N_Genes);
+    hi_mask_start = (state_t)(~0U << N_Genes);
 
     genosect_mask = 0x0;
     for (unsigned int i = 0; i < (1<<N_Ins); ++i) { // 1<<N is the same as 2^N
-        genosect_mask |= (0x1 << i);
+        genosect_mask |= (GENOSECT_ONE << i);
     }
     DBG2 ("genosect_mask: 0x" << hex << genosect_mask << dec); // 65535 is 16 bits
 
@@ -292,7 +400,7 @@ compute_next_common (const state_t& state, array<state_t, N_Genes>& inputs)
         inputs[i] = ((state << i) & state_mask) | (state >> (N_Genes-i));
 #else
         inputs[i] = (state & lo_mask) | ((state & hi_mask) >> N_minus_k);
-        hi_mask = (hi_mask >> 1) | 0x80;
+        hi_mask = (hi_mask >> 1) | state_t_top_bit;
         lo_mask >>= 1;
 #endif
     }
@@ -313,9 +421,7 @@ compute_next_async (const array<genosect_t, N_Genes>& genome, state_t& state)
     unsigned int i = floor(randDouble()*N_Genes);
     //for (unsigned int i = 0; i < N_Genes; ++i) {
     DBG2 ("Setting state for gene " << i);
-    genosect_t gs = genome[i];
-    genosect_t inpit = (0x1 << inputs[i]);
-    state_t num = ((gs & inpit) ? 0x1 : 0x0);
+    state_t num = genosect_bit (genome[i], inputs[i]);
     if (num) {
         state |= (0x1 << (N_Ins-(i+ExtraOffset)));
     } else {
@@ -344,26 +450,98 @@ compute_next (const array<genosect_t, N_Genes>& genome, state_t& state)
         inputs[i] = ((state << i) & state_mask) | (state >> (N_Genes-i));
 #else
         inputs[i] = (state & lo_mask) | ((state & hi_mask) >> N_minus_k);
-        hi_mask = (hi_mask >> 1) | 0x80;
+        hi_mask = (hi_mask >> 1) | state_t_top_bit;
         lo_mask >>= 1;
 #endif
     }
 
-    // Now reset state and compute new values:
-    state = 0x0;
-
-    // State a anterior is genome[inps[0]] etc
+    // Now reset state and compute new values. State a anterior is genome[inps[0]] etc
+    state_t next = 0x0;
     for (unsigned int i = 0; i < N_Genes; ++i) {
         DBG2 ("Setting state for gene " << i);
-        genosect_t gs = genome[i];
-        genosect_t inpit = (0x1 << inputs[i]);
-        state_t num = ((gs & inpit) ? 0x1 : 0x0);
-        if (num) {
-            state |= (0x1 << (N_Ins-(i+ExtraOffset)));
-        } else {
-            state &= ~(0x1 << (N_Ins-(i+ExtraOffset)));
+        next |= genosect_bit (genome[i], inputs[i]) << (N_Ins-(i+ExtraOffset));
+    }
+    state = next;
+}
+
+/*!
+ * The number of genomes in the blocks which the population samplers develop together with
+ * compute_next_batch(). 16 lanes of unsigned int fill a 512 bit vector register, or two 256 bit
+ * registers; 8 is the alternative.
+ */
+#ifndef Genome_Block_Len
+# define Genome_Block_Len 16
+#endif
+
+/*!
+ * A block of L genomes in structure of arrays layout, for developing L networks in lockstep with
+ * compute_next_batch(). gs[i][l] is genosect i of the genome in lane l, so that genosect i of
+ * every lane, which compute_next_batch() reads all at once, is contiguous.
+ */
+template <unsigned int L>
+struct GenomeBlock
+{
+    GenomeBlock (void)
+    {
+        for (unsigned int i = 0; i < N_Genes; ++i) {
+            for (unsigned int l = 0; l < L; ++l) { this->gs[i][l] = 0; }
+        }
+    }
+
+    //! Place genome in lane l
+    void set (unsigned int l, const array<genosect_t, N_Genes>& genome)
+    {
+        for (unsigned int i = 0; i < N_Genes; ++i) { this->gs[i][l] = genome[i]; }
+    }
+
+    //! Copy the genome in lane l into genome
+    void get (unsigned int l, array<genosect_t, N_Genes>& genome) const
+    {
+        for (unsigned int i = 0; i < N_Genes; ++i) { genome[i] = this->gs[i][l]; }
+    }
+
+    genosect_t gs[N_Genes][L];
+};
+
+/*!
+ * compute_next() for each of the L networks in block, advancing states[l] (the state of the
+ * network in lane l) by one step. The lanes' states are unsigned ints, rather than state_ts, so
+ * that the lanes fill a vector register. The inputs to each gene are the same function of the
+ * state in every lane, so the loop over the lanes is vectorised; for the integer genosects,
+ * looking up each lane's truth table row is one variable shift.
+ */
+template <unsigned int L>
+void
+compute_next_batch (const GenomeBlock<L>& block, unsigned int* states)
+{
+    unsigned int next[L];
+    for (unsigned int l = 0; l < L; ++l) { next[l] = 0x0; }
+
+#ifdef N_Ins_EQUALS_N_Genes
+    const unsigned int smask = state_mask;
+#else
+    unsigned int lo_mask = lo_mask_start;
+    unsigned int hi_mask = hi_mask_start;
+#endif
+
+    for (unsigned int i = 0; i < N_Genes; ++i) {
+#pragma omp simd
+        for (unsigned int l = 0; l < L; ++l) {
+            unsigned int s = states[l];
+#ifdef N_Ins_EQUALS_N_Genes
+            unsigned int input = ((s << i) & smask) | (s >> (N_Genes-i));
+#else
+            unsigned int input = (s & lo_mask) | ((s & hi_mask) >> N_minus_k);
+#endif
+            next[l] |= genosect_bit (block.gs[i][l], input) << (N_Ins-(i+ExtraOffset));
         }
+#ifndef N_Ins_EQUALS_N_Genes
+        hi_mask = (hi_mask >> 1) | state_t_top_bit;
+        lo_mask >>= 1;
+#endif
     }
+
+    for (unsigned int l = 0; l < L; ++l) { states[l] = next[l]; }
 }
 
 /*!
@@ -448,6 +626,301 @@ mix (unsigned int a, unsigned int b, unsigned int c)
     return c;
 }
 
+/*!
+ * Set up nstreams independent RngData instances in rds, one for each
+ * thread that needs its own stream of random numbers. Each is seeded
+ * from the global rd, so rd must already have been seeded, and the
+ * streams are reproducible for a given rd seed.
+ */
+void
+rngDataInitStreams (vector<RngData>& rds, unsigned int nstreams)
+{
+    rds.resize (nstreams);
+    for (unsigned int i = 0; i < nstreams; ++i) {
+        rngDataInit (&rds[i]);
+        zigset (&rds[i], DUMMYARG);
+        // Mix in the stream number so that streams differ even if SHR3 repeats. Zero seed is
+        // not allowed (see rng.h).
+        unsigned int s1 = SHR3((&rd));
+        unsigned int s2 = SHR3((&rd));
+        unsigned int s = mix (s1, s2, i);
+        rds[i].seed = (s == 0) ? (i+1) : s;
+    }
+}
+
+/*!
+ * Allocation-free conversions between the genome and its text forms
+ * (the Dan string of 1s and 0s and the hex genome_id) and a packed
+ * binary form, for tools which convert many genomes at a time. They
+ * write into, and read from, caller-supplied buffers. genome2str(),
+ * str2genome() and genome_id() are wrappers around them.
+ *
+ * The packed form holds the bits in the order of the Dan string, bit j
+ * of gene i being bit (i*Genosect_Width + j), least significant bit
+ * first within each byte.
+ */
+//@{
+//! The number of chars in the Dan string form of a genome
+#define Genome_Str_Len (N_Genes * Genosect_Width)
+//! The largest number of chars in the genome_id form of a genome, plus one for a null
+#define Genome_Id_Maxlen (N_Genes * (Genosect_Width/4 + 1))
+//! The number of bytes in the packed form of a genome
+#define Genome_Packed_Len ((N_Genes * Genosect_Width + 7) / 8)
+//! The significant bits of a genosect (the same as genosect_mask, once masks_init() has run)
+//! and the shift which leaves its top hex digit.
+#if Genosect_Width >= 64
+# define Genosect_Width_Mask (~(genosect_t)0)
+# define Genosect_Top_Digit_Shift (Genosect_Width - 4)
+#else
+# define Genosect_Width_Mask ((GENOSECT_ONE << Genosect_Width) - 1)
+# define Genosect_Top_Digit_Shift (Genosect_Width - 4)
+#endif
+
+/*!
+ * Lookup tables for the conversions: the 8 chars of the Dan string
+ * for each byte, and the value of each hex digit char (-1 if it isn't
+ * one).
+ */
+struct GenomeConvTables
+{
+    unsigned long long int bitchars[256];
+    signed char hexval[256];
+    GenomeConvTables()
+    {
+        for (unsigned int b = 0; b < 256; ++b) {
+            unsigned long long int c = 0;
+            for (unsigned int j = 0; j < 8; ++j) {
+                c |= (unsigned long long int)((b >> j) & 0x1 ? '1' : '0') << (8*j);
+            }
+            this->bitchars[b] = c;
+            this->hexval[b] = -1;
+        }
+        for (unsigned int d = 0; d < 10; ++d) { this->hexval['0'+d] = d; }
+        for (unsigned int d = 0; d < 6; ++d) {
+            this->hexval['a'+d] = 10 + d;
+            this->hexval['A'+d] = 10 + d;
+        }
+    }
+};
+const GenomeConvTables genome_conv_tables;
+
+/*!
+ * Convert n (<= 8) chars of a Dan string to bits, the first char
+ * giving bit 0. Returns false if any char is not '0' or '1'.
+ */
+inline bool
+chars2bits (const char* s, unsigned int n, unsigned int& bits)
+{
+    unsigned long long int x = 0;
+    memcpy (&x, s, n);
+    unsigned long long int ones = 0x0101010101010101ULL >> (8*(8-n));
+    x -= 0x3030303030303030ULL & (ones * 0xff);
+    if (x & ~ones) {
+        return false;
+    }
+    // Gather the low bit of each byte into the top byte; there are no carries.
+    bits = (unsigned int)((x * 0x0102040810204080ULL) >> 56);
+    return true;
+}
+
+/*!
+ * Write the Dan string form of genome to buf, which must have room for
+ * Genome_Str_Len chars. No terminating null is written.
+ */
+void
+genome2chars (const array<genosect_t, N_Genes>& genome, char* buf)
+{
+    const unsigned int bytes_per_sect = (Genosect_Width + 7) / 8;
+    const unsigned int chars_per_byte = Genosect_Width < 8 ? Genosect_Width : 8;
+    for (unsigned int i = 0; i < N_Genes; ++i) {
+        const genosect_t& gs = genome[i];
+        for (unsigned int b = 0; b < bytes_per_sect; ++b) {
+            memcpy (buf, &genome_conv_tables.bitchars[genosect_byte (gs, b)], chars_per_byte);
+            buf += chars_per_byte;
+        }
+    }
+}
+
+/*!
+ * Read the Dan string form of a genome from the Genome_Str_Len chars
+ * at s into genome. Returns false if any char is not '0' or '1'.
+ */
+bool
+chars2genome (const char* s, array<genosect_t, N_Genes>& genome)
+{
+    const unsigned int bytes_per_sect = (Genosect_Width + 7) / 8;
+    const unsigned int chars_per_byte = Genosect_Width < 8 ? Genosect_Width : 8;
+    for (unsigned int i = 0; i < N_Genes; ++i) {
+        genosect_t gs = 0;
+        for (unsigned int b = 0; b < bytes_per_sect; ++b) {
+            unsigned int bits = 0;
+            if (!chars2bits (s, chars_per_byte, bits)) {
+                return false;
+            }
+            genosect_or_byte (gs, b, bits);
+            s += chars_per_byte;
+        }
+        genome[i] = gs;
+    }
+    return true;
+}
+
+/*!
+ * Write the genome_id form of genome to buf, which must have room for
+ * Genome_Id_Maxlen chars, with a terminating null. Returns the number
+ * of chars written, not counting the null.
+ */
+unsigned int
+genome2id (const array<genosect_t, N_Genes>& genome, char* buf)
+{
+    static const char hexdigits[] = "0123456789abcdef";
+    char* p = buf;
+    for (unsigned int i = 0; i < N_Genes; ++i) {
+        if (i > 0) { *p++ = '-'; }
+        const genosect_t gs = genome[i] & Genosect_Width_Mask;
+        // The number of hex digits, without leading zeros (but at least one)
+        int nd = Genosect_Width < 4 ? 1 : Genosect_Width/4;
+        while (nd > 1 && ((genosect_byte (gs, (nd-1)/2) >> (4*((nd-1)%2))) & 0xf) == 0) { --nd; }
+        for (int d = nd - 1; d >= 0; --d) {
+            *p++ = hexdigits[(genosect_byte (gs, d/2) >> (4*(d%2))) & 0xf];
+        }
+    }
+    *p = '\0';
+    return (unsigned int)(p - buf);
+}
+
+/*!
+ * Read the genome_id form of a genome (N_Genes '-' separated hex
+ * numbers) from the len chars at s. Returns false if they aren't one.
+ */
+bool
+id2genome (const char* s, unsigned int len, array<genosect_t, N_Genes>& genome)
+{
+    const char* end = s + len;
+    for (unsigned int i = 0; i < N_Genes; ++i) {
+        if (i > 0) {
+            if (s == end || *s != '-') { return false; }
+            ++s;
+        }
+        genosect_t gs = 0;
+        unsigned int nd = 0;
+        for (; s != end && *s != '-'; ++s, ++nd) {
+            int v = genome_conv_tables.hexval[(unsigned char)*s];
+            if (v < 0 || (gs >> Genosect_Top_Digit_Shift) != 0) {
+                return false;
+            }
+            gs = (gs << 4) | (genosect_t)v;
+        }
+        if (nd == 0) { return false; }
+        genome[i] = gs;
+    }
+    return s == end;
+}
+
+/*!
+ * Write the packed form of genome to the Genome_Packed_Len bytes at buf.
+ */
+void
+genome2packed (const array<genosect_t, N_Genes>& genome, unsigned char* buf)
+{
+#if Genosect_Width >= 8
+    for (unsigned int i = 0; i < N_Genes; ++i) {
+        const genosect_t& gs = genome[i];
+        for (unsigned int b = 0; b < Genosect_Width/8; ++b) {
+            *buf++ = (unsigned char)genosect_byte (gs, b);
+        }
+    }
+#else
+    // Genosects of 4 bits, two to a byte
+    for (unsigned int i = 0; i < Genome_Packed_Len; ++i) {
+        unsigned int lo = genome[2*i] & 0xf;
+        unsigned int hi = (2*i + 1 < N_Genes) ? (genome[2*i+1] & 0xf) : 0;
+        buf[i] = (unsigned char)(lo | (hi << 4));
+    }
+#endif
+}
+
+/*!
+ * Read a genome from the packed form in the Genome_Packed_Len bytes at buf.
+ */
+void
+packed2genome (const unsigned char* buf, array<genosect_t, N_Genes>& genome)
+{
+#if Genosect_Width >= 8
+    for (unsigned int i = 0; i < N_Genes; ++i) {
+        genosect_t gs = 0;
+        for (unsigned int b = 0; b < Genosect_Width/8; ++b) {
+            genosect_or_byte (gs, b, *buf++);
+        }
+        genome[i] = gs;
+    }
+#else
+    for (unsigned int i = 0; i < N_Genes; ++i) {
+        genome[i] = (buf[i/2] >> (4*(i%2))) & 0xf;
+    }
+#endif
+}
+
+/*!
+ * Batch forms of the conversions. The text forms of the n genomes are
+ * each followed by a newline in buf; genomes2chars() writes
+ * n*(Genome_Str_Len+1) chars and chars2genomes() reads them back,
+ * returning the number of genomes read before the first bad one.
+ */
+//@{
+void
+genomes2chars (const array<genosect_t, N_Genes>* genomes, size_t n, char* buf)
+{
+    for (size_t g = 0; g < n; ++g) {
+        genome2chars (genomes[g], buf);
+        buf[Genome_Str_Len] = '\n';
+        buf += Genome_Str_Len + 1;
+    }
+}
+
+size_t
+chars2genomes (const char* buf, size_t n, array<genosect_t, N_Genes>* genomes)
+{
+    for (size_t g = 0; g < n; ++g) {
+        if (!chars2genome (buf, genomes[g])) {
+            return g;
+        }
+        buf += Genome_Str_Len + 1;
+    }
+    return n;
+}
+
+//! Returns the number of chars written to buf, which needs room for n*Genome_Id_Maxlen
+size_t
+genomes2ids (const array<genosect_t, N_Genes>* genomes, size_t n, char* buf)
+{
+    char* p = buf;
+    for (size_t g = 0; g < n; ++g) {
+        p += genome2id (genomes[g], p);
+        *p++ = '\n';
+    }
+    return (size_t)(p - buf);
+}
+
+void
+genomes2packed (const array<genosect_t, N_Genes>* genomes, size_t n, unsigned char* buf)
+{
+    for (size_t g = 0; g < n; ++g) {
+        genome2packed (genomes[g], buf + g * Genome_Packed_Len);
+    }
+}
+
+void
+packed2genomes (const unsigned char* buf, size_t n, array<genosect_t, N_Genes>* genomes)
+{
+    for (size_t g = 0; g < n; ++g) {
+        packed2genome (buf + g * Genome_Packed_Len, genomes[g]);
+    }
+}
+//@}
+//@}
+
+#if Genosect_Words == 1
 /*!
  * Convert from my array of genosect_t form for genome to the long
  * double form used by Stuart's code. Untested; no idea if it works.
@@ -464,23 +937,18 @@ genome2int (array<genosect_t, N_Genes>& genome)
     }
     return (long double)u;
 }
+#endif
 
 /*!
  * Produce the string of 1 and 0 chars to match the format Dan
  * provides genomes in.
  */
 string
-genome2str (array<genosect_t, N_Genes>& genome)
+genome2str (const array<genosect_t, N_Genes>& genome)
 {
-    stringstream rtn;
-    for (unsigned int i = 0; i < N_Genes; ++i) {
-        for (unsigned long long int j = 0; j < (1 << N_Ins); ++j) {
-            genosect_t mask = GENOSECT_ONE << j;
-            //LOG ("mask 1<<"<<j<<": " << hex << (unsigned long long int)mask << dec);
-            rtn << ((genome[i]&mask) >> j);
-        }
-    }
-    return rtn.str();
+    char buf[Genome_Str_Len];
+    genome2chars (genome, buf);
+    return string (buf, Genome_Str_Len);
 }
 
 /*!
@@ -498,7 +966,7 @@ str2genome (const string& s)
 
     // Check length of string.
     unsigned int l = s.length();
-    unsigned int l_genosect = GENOSECT_ONE << N_Ins;
+    unsigned int l_genosect = Genosect_Width;
     unsigned int l_genome = N_Genes * l_genosect;
     if (l == l_genome) {
         DBG ("String has " << l_genome << " bit chars as required...");
@@ -506,6 +974,13 @@ str2genome (const string& s)
         return g;
     }
 
+    if (chars2genome (s.data(), g)) {
+        return g;
+    }
+    // Not all 1s and 0s; take anything but '1' as 0
+    for (unsigned int i = 0; i < N_Genes; ++i) {
+        g[i] = 0x0;
+    }
     for (unsigned int i = 0; i < N_Genes; ++i) {
         for (unsigned int j = 0; j < l_genosect; ++j) {
             bool high = (s[j + i*l_genosect] == '1');
@@ -533,7 +1008,7 @@ vecbool2genome (const vector<bool>& vb)
 
     // Check length of vector of bools
     unsigned int l = vb.size();
-    unsigned int l_genosect = GENOSECT_ONE << N_Ins;
+    unsigned int l_genosect = Genosect_Width;
     unsigned int l_genome = N_Genes * l_genosect;
     if (l == l_genome) {
         DBG ("Vector has " << l_genome << " bit bools as required...");
@@ -559,19 +1034,9 @@ vecbool2genome (const vector<bool>& vb)
 string
 genome_id (const array<genosect_t, N_Genes>& genome)
 {
-    stringstream ss;
-    ss << hex;
-    bool first = true;
-    for (unsigned int i = 0; i<N_Genes; ++i) {
-        if (first) {
-            first = false;
-            ss << (genome[i] & genosect_mask);
-        } else {
-            ss << "-" << (genome[i] & genosect_mask);
-        }
-    }
-    ss << dec;
-    return ss.str();
+    char buf[Genome_Id_Maxlen];
+    unsigned int l = genome2id (genome, buf);
+    return string (buf, l);
 }
 
 /*!
@@ -635,8 +1100,7 @@ show_genome (const array<genosect_t, N_Genes>& genome)
     for (unsigned int j = 0; j < (1 << N_Ins); ++j) {
         cout << bitset<N_Ins>(j) << "   ";
         for (unsigned int i = 0; i < N_Genes; ++i) {
-            genosect_t mask = GENOSECT_ONE << j;
-            cout << ((genome[i]&mask) >> j);
+            cout << genosect_bit (genome[i], j);
         }
         cout << endl;
     }
@@ -667,80 +1131,70 @@ copy_genome (const array<genosect_t, N_Genes>& from, array<genosect_t, N_Genes>&
 }
 
 /*!
- * This one will, rather than flipping each bit with a certain
- * probability, instead flip bits_to_flip bits, selected randomly.
+ * Flip each bit of genome with probability p, using the RNG _rd, and
+ * return the number of bits flipped. Rather than testing every bit
+ * against p, this jumps from one flipped bit to the next (the number
+ * of unflipped bits between flips is geometrically distributed), so it
+ * costs as many random numbers as there are flips, plus one. That
+ * matters for the larger genomes: there are 2048 bits when N_Genes=8.
  */
-void
-evolve_genome (array<genosect_t, N_Genes>& genome, unsigned int bits_to_flip)
+unsigned int
+flip_genome_bits (array<genosect_t, N_Genes>& genome, double p, RngData* _rd)
 {
-#ifdef DEBUG
-    unsigned int numflipped = 0;
-#endif
-
-    unsigned int genosect_w = (GENOSECT_ONE << N_Ins);
-    unsigned int lgenome = N_Genes * genosect_w;
-
-    // Init a list containing all the indices, lgenome long. As bits
-    // are flipped, we'll remove from this list, ensuring that the
-    // random selection of the remaining bits remains fair.
-    list<unsigned int> idices;
-    for (unsigned int b = 0; b < lgenome; ++b) {
-        idices.push_back (b);
-    }
-    for (unsigned int b = 0; b < bits_to_flip; ++b) {
-        unsigned int r = static_cast<unsigned int>(floor(randDouble() * (double)lgenome));
-        // Catch the edge case (where randDouble() returned exactly 1.0)
-        if (r == lgenome) {
-            --r;
+    const long long int lgenome = N_Genes * Genosect_Width;
+    if (p <= 0.0) {
+        return 0;
+    }
+    if (p >= 1.0) {
+        for (unsigned int i = 0; i < N_Genes; ++i) {
+            genome[i] ^= Genosect_Width_Mask;
         }
-
-        // The bit to flip is *i, after these two lines:
-        list<unsigned int>::iterator i = idices.begin();
-        for (unsigned int rr = 0; rr < r; ++rr, ++i) {}
-
-        unsigned int j = *i;
-        // Find out which genome sect j is in.
-        unsigned int gi = j / genosect_w;
-        DBG ("Genome section gi= " << gi << " which is an offset of " << (gi*genosect_w));
-        genosect_t gsect = genome[gi];
-
-        j -= (gi*genosect_w);
-#ifdef DEBUG
-        ++numflipped;
-        DBG ("Flipping bit " << j+(gi*genosect_w));
-#endif
-        gsect ^= (GENOSECT_ONE << j);
-        genome[gi] = gsect;
-
-        --lgenome;
+        return lgenome;
     }
-    DBG ("Num flipped: " << numflipped);
+    const double lq = log1p (-p);
+    unsigned int nflips = 0;
+    long long int b = -1;
+    for (;;) {
+        // The number of unflipped bits before the next flip is geometric: P(skip >= k) = (1-p)^k
+        double u = 1.0 - randDouble (_rd); // in (0,1]
+        double skip = floor (log (u) / lq);
+        if (skip >= (double)(lgenome - b)) {
+            break;
+        }
+        b += 1 + (long long int)skip;
+        if (b >= lgenome) {
+            break;
+        }
+        genosect_flip (genome[b / Genosect_Width], b % Genosect_Width);
+        ++nflips;
+    }
+    return nflips;
 }
 
 /*!
- * The evolution function. Note that this function depends on the
- * existence of a global variable pOn.
+ * The evolution function, flipping each bit with probability pOn. Note
+ * that this function depends on the existence of a global variable
+ * pOn.
  */
 void
 evolve_genome (array<genosect_t, N_Genes>& genome)
 {
 #ifdef DEBUG
-    unsigned int numflipped = 0;
-#endif
-    for (unsigned int i = 0; i < N_Genes; ++i) {
-        genosect_t gsect = genome[i];
-        for (unsigned int j = 0; j < (1<<N_Ins); ++j) {
-            if (randDouble() < pOn) {
-                // Flip bit j
-#ifdef DEBUG
-                ++numflipped;
-#endif
-                gsect ^= (GENOSECT_ONE << j);
-            }
-        }
-        genome[i] = gsect;
-    }
+    unsigned int numflipped = flip_genome_bits (genome, pOn, &rd);
     DBG ("Num flipped: " << numflipped);
+#else
+    flip_genome_bits (genome, pOn, &rd);
+#endif
+}
+
+/*!
+ * evolve_genome(genome), flipping each bit with probability pOn, but
+ * using the RNG _rd (so that each thread may have its own).
+ */
+void
+evolve_genome (array<genosect_t, N_Genes>& genome, RngData* _rd)
+{
+    flip_genome_bits (genome, pOn, _rd);
 }
 
 /*!
@@ -750,7 +1204,53 @@ void
 bitflip_genome (array<genosect_t, N_Genes>& genome, unsigned int theGenosect, unsigned int extra)
 {
     DBG2("Genosect " << theGenosect << " plus " << extra);
-    genome[theGenosect] ^= (GENOSECT_ONE << extra);
+    genosect_flip (genome[theGenosect], extra);
+}
+
+/*!
+ * Set flip_mask to a uniformly chosen mask with exactly h bits set
+ * out of the N_Genes * 2^N_Ins bits in the genome. This is Floyd's
+ * algorithm for choosing an h-subset; it makes exactly h calls to the
+ * RNG and uses the mask itself as the record of the bits already
+ * chosen. _rd is the RNG to use (so that each thread may have its own).
+ */
+void
+random_flip_mask (array<genosect_t, N_Genes>& flip_mask, unsigned int h, RngData* _rd)
+{
+    unsigned int genosect_w = Genosect_Width;
+    unsigned int lgenome = N_Genes * genosect_w;
+    zero_genome (flip_mask);
+    for (unsigned int j = lgenome - h; j < lgenome; ++j) {
+        // Choose t in [0,j]
+        unsigned int t = static_cast<unsigned int>(floor(randDouble(_rd) * (double)(j+1)));
+        if (t > j) { t = j; }
+        if (genosect_bit (flip_mask[t / genosect_w], t % genosect_w)) {
+            // t already chosen, so choose j, which can't have been.
+            genosect_flip (flip_mask[j / genosect_w], j % genosect_w);
+        } else {
+            genosect_flip (flip_mask[t / genosect_w], t % genosect_w);
+        }
+    }
+}
+
+/*!
+ * This one will, rather than flipping each bit with a certain
+ * probability, instead flip bits_to_flip bits, selected randomly
+ * (each set of bits_to_flip bits being equally likely), using the RNG
+ * _rd.
+ */
+void
+evolve_genome (array<genosect_t, N_Genes>& genome, unsigned int bits_to_flip, RngData* _rd = &rd)
+{
+    const unsigned int lgenome = N_Genes * Genosect_Width;
+    if (bits_to_flip > lgenome) {
+        bits_to_flip = lgenome;
+    }
+    array<genosect_t, N_Genes> mask;
+    random_flip_mask (mask, bits_to_flip, _rd);
+    for (unsigned int i = 0; i < N_Genes; ++i) {
+        genome[i] ^= mask[i];
+    }
 }
 
 /*!
@@ -766,7 +1266,7 @@ evolve_genome (array<genosect_t, N_Genes>& genome, array<unsigned long long int,
             if (randFloat() < pOn) {
                 // Flip bit j
                 ++flipcount[i];
-                gsect ^= (GENOSECT_ONE << j);
+                genosect_flip (gsect, j);
             }
         }
         genome[i] = gsect;
@@ -791,6 +1291,22 @@ random_genome_sw (array<genosect_t, N_Genes>& genome) {
     genome = vecbool2genome (G);
 }
 
+#if Genosect_Words > 1
+/*!
+ * Fill the wide genosect gs with random bits from the RNG _rd, with
+ * two SHR3 draws for each 64 bit word, as for the 64 bit genosect.
+ */
+void
+random_genosect (genosect_t& gs, RngData* _rd)
+{
+    for (unsigned int k = 0; k < Genosect_Words; ++k) {
+        unsigned long long int hi = SHR3(_rd);
+        unsigned long long int lo = SHR3(_rd);
+        gs.w[k] = (hi << 32) | lo;
+    }
+}
+#endif
+
 /*!
  * Populate the passed in genome with random bits.
  */
@@ -798,7 +1314,9 @@ void
 random_genome (array<genosect_t, N_Genes>& genome)
 {
     for (unsigned int i = 0; i < N_Genes; ++i) {
-#ifndef USE_SIMPLE_RAND
+#if Genosect_Words > 1
+        random_genosect (genome[i], &rd);
+#elif !defined USE_SIMPLE_RAND
         genome[i] = ((genosect_t) SHR3((&rd))) & genosect_mask;
 #else
         genome[i] = ((genosect_t) rand()) & genosect_mask;
@@ -806,6 +1324,27 @@ random_genome (array<genosect_t, N_Genes>& genome)
     }
 }
 
+/*!
+ * Populate the passed in genome with random bits from the RNG _rd (so
+ * that each thread may have its own).
+ */
+void
+random_genome (array<genosect_t, N_Genes>& genome, RngData* _rd)
+{
+    for (unsigned int i = 0; i < N_Genes; ++i) {
+#if Genosect_Words > 1
+        random_genosect (genome[i], _rd);
+#elif N_Ins > 5
+        // SHR3 gives 32 bits; a 64 bit genosect needs two of them, drawn in sequence
+        genosect_t hi = (genosect_t) SHR3(_rd);
+        genosect_t lo = (genosect_t) SHR3(_rd);
+        genome[i] = (hi << 32) | lo;
+#else
+        genome[i] = ((genosect_t) SHR3(_rd)) & genosect_mask;
+#endif
+    }
+}
+
 /*!
  * Generate a random genome and return it.
  */
@@ -814,7 +1353,9 @@ random_genome (void)
 {
     array<genosect_t, N_Genes> genome;
     for (unsigned int i = 0; i < N_Genes; ++i) {
-#ifndef USE_SIMPLE_RAND
+#if Genosect_Words > 1
+        random_genosect (genome[i], &rd);
+#elif !defined USE_SIMPLE_RAND
         genome[i] = ((genosect_t) SHR3((&rd))) & genosect_mask;
 #else
         genome[i] = ((genosect_t) rand()) & genosect_mask;
@@ -847,8 +1388,14 @@ compute_hamming (const array<genosect_t, N_Genes>& g1,
 {
     unsigned int hamming = 0;
     for (unsigned int i = 0; i < N_Genes; ++i) {
+#if Genosect_Words > 1
+        for (unsigned int k = 0; k < Genosect_Words; ++k) {
+            hamming += (unsigned int)_mm_popcnt_u64 (g1[i].w[k] ^ g2[i].w[k]);
+        }
+#else
         genosect_t bits = g1[i] ^ g2[i]; // XOR
-        hamming += _mm_popcnt_u32 ((unsigned int)bits);
+        hamming += genosect_popcount (bits);
+#endif
     }
     return hamming;
 }
@@ -876,11 +1423,10 @@ next_combination (int comb[], int k, int n)
     ++comb[i];
     while ((i >= 0) && (comb[i] >= n - k + 1 + i)) {
         --i;
-        ++comb[i];
+        if (i >= 0) { ++comb[i]; } // Don't write to comb[-1]
     }
 
-    if (comb[0] > n - k) { /* Combination (n-k, n-k+1, ..., n) reached */
-        /* Peculiar bug occurs here on returning when called within combos.cpp */
+    if (i < 0) { /* Combination (n-k, n-k+1, ..., n) reached */
         return 0; /* No more combinations can be generated */
     }
 
@@ -1046,93 +1592,115 @@ stringToVector (const string& s, const string& separator,
     return theVec;
 }
 
+// The canalysing functions read the truth table of a genosect as one 64 bit word, so there are
+// none for wide genosects.
+#if Genosect_Words == 1
+
+/*!
+ * Cofactor masks for the truth table held in a genosect: bit j of canal_input_masks[i] is set if
+ * input i is 1 in row j of the table. A genosect_t can't hold the truth table for more than 6
+ * inputs, so the last two are never used.
+ */
+const unsigned long long int canal_input_masks[8] = {
+    0xaaaaaaaaaaaaaaaaULL, 0xccccccccccccccccULL, 0xf0f0f0f0f0f0f0f0ULL, 0xff00ff00ff00ff00ULL,
+    0xffff0000ffff0000ULL, 0xffffffff00000000ULL, 0x0ULL, 0x0ULL
+};
+
+/*!
+ * All the rows of the truth table in a genosect
+ */
+#define Canal_Rows_Mask ((1 << N_Ins) >= 64 ? ~0ULL : ((1ULL << ((1 << N_Ins) & 63)) - 1ULL))
+
 /*!
  * Is the function defined by the genosect_t @gs a canalysing function?
  *
  * If not, return (unsigned int)0, otherwise return the number of bits for which the function is
  * canalysing - this may be called canalysing "depth".
+ *
+ * The function is canalysing for input i set to 1 if its output is the same in all the rows of the
+ * truth table where input i is 1; that is, if gs masked by the cofactor mask for input i is either
+ * all zeros or equal to the mask. Likewise for input i set to 0. There are no branches, so that
+ * isCanalyzing_batch() vectorises.
  */
-unsigned int
+inline unsigned int
 isCanalyzing (const genosect_t& gs)
 {
-    bitset<N_Ins> acanal_set;
-    //array<bool, N_Ins> acanal_set;
-    bitset<N_Ins> acanal_unset;
-    //array<bool, N_Ins> acanal_unset;
-    array<int, N_Ins> setbitivalue;
-    array<int, N_Ins> unsetbitivalue;
+    unsigned long long int f = static_cast<unsigned long long int>(gs) & Canal_Rows_Mask;
     unsigned int canal = 0;
-
     for (unsigned int i = 0; i < N_Ins; ++i) {
-        acanal_set[i] = false;
-        acanal_unset[i] = false;
-        setbitivalue[i] = -1;
-        unsetbitivalue[i] = -1;
+        unsigned long long int m1 = canal_input_masks[i] & Canal_Rows_Mask;
+        unsigned long long int m0 = ~canal_input_masks[i] & Canal_Rows_Mask;
+        unsigned long long int f1 = f & m1;
+        unsigned long long int f0 = f & m0;
+        canal += (f1 == 0ULL) + (f1 == m1) + (f0 == 0ULL) + (f0 == m0);
     }
+    return canal;
+}
 
-    // Test each bit. If bit's state always leads to same result in gs, then canalysing is true
-    // for that bit.
-    for (unsigned int i = 0; i < N_Ins; ++i) {
-
-        //DBG2 ("*** Testing bit " << i << " ***");
-        // Test bit i. First assume it IS canalysing for this bit
-        acanal_set.set(i);
-        acanal_unset.set(i);
-
-        // Iterate over the rows in the truth table
-        for (unsigned int j = 0; j < (0x1 << N_Ins); ++j) {
-
-            // if (bit i in row j is on)
-            if ((j & (1UL<<i)) == (1UL<<i)) {
-                if (setbitivalue[i] == -1) {
-                    // -1 means we haven't yet recorded an output from gs, so record it:
-                    setbitivalue[i] = (int)(1UL&(gs>>j));
-                    //DBG2 ("bit "<<i<<" in "<<j<<" is on. Right shift gs=" << gs
-                    //      << " by j=" << j << " bits to get " << setbitivalue[i]);
-                } else {
-                    //DBG2 ("bit "<<i<<" in "<<j<<" is on. Right shift gs=" << gs
-                    //      << " by j=" << j << " bits and compare with " << setbitivalue[i]);
-                    if (setbitivalue[i] != (int)(1UL&(gs>>j))) {
-                        // Cannot be canalysing for bit i set to 1.
-                        //DBG2 ("Cannot be canalysing for bit " <<i<< " on");
-                        acanal_set.reset(i);
-                    }
-                }
-            } else {
-                // (bit i in row j is off)
-                if (unsetbitivalue[i] == -1) {
-                    // Haven't yet recorded an output from gs, so record it:
-                    unsetbitivalue[i] = (int)(1UL&(gs>>j));
-                    //DBG2 ("bit "<<i<<" in "<<j<<" is off. Right shift gs=" << gs
-                    //      << " by j=" << j << " bits to get " << unsetbitivalue[i]);
-                } else {
-                    //DBG2 ("bit "<<i<<" in "<<j<<" is off. Right shift gs=" << gs
-                    //      << " by j=" << j << " bits and compare with " << unsetbitivalue[i]);
-                    if (unsetbitivalue[i] != (int)(1UL&(gs>>j))) {
-                        // Cannot be canalysing for bit i set to 0
-                        //DBG2 ("Cannot be canalysing for bit " <<i<< " off");
-                        acanal_unset.reset(i) = false;
-                    }
-                }
-            }
-        }
+/*!
+ * Compute isCanalyzing() for each of the n genosects in gs, writing the results to canal. The loop
+ * is written to be vectorised, to classify many genosects at a time.
+ */
+void
+isCanalyzing_batch (const genosect_t* gs, unsigned int* canal, size_t n)
+{
+#pragma omp simd
+    for (size_t k = 0; k < n; ++k) {
+        canal[k] = isCanalyzing (gs[k]);
     }
+}
 
-    // Count up
-    for (unsigned int i = 0; i < N_Ins; ++i) {
-        if (acanal_set.test(i) == true) {
-            canal++;
-            DBG2 ("Bit " << i << "=1 produces a consistent output value");
+/*!
+ * The nested canalysing depth of the function defined by @gs: the number of inputs in its
+ * canalysing layers. The first layer is the set of inputs for which the function is canalysing.
+ * Fixing each of those at its non-canalysing value leaves a function of the rest of the inputs,
+ * whose canalysing inputs are the second layer, and so on until the remaining function is constant
+ * or has no canalysing input. A nested canalysing function has depth N_Ins; a function which isn't
+ * canalysing has depth 0.
+ */
+unsigned int
+canalyzingDepth (const genosect_t& gs)
+{
+    unsigned long long int f = static_cast<unsigned long long int>(gs) & Canal_Rows_Mask;
+    // The rows of the truth table which remain, once the layers found so far are fixed
+    unsigned long long int live = Canal_Rows_Mask;
+    unsigned int depth = 0;
+    for (;;) {
+        unsigned long long int fl = f & live;
+        if (fl == 0ULL || fl == live) {
+            break; // constant
         }
-        if (acanal_unset.test(i) == true) {
-            canal++;
-            DBG2 ("Bit " << i << "=0 produces a consistent output value");
+        unsigned long long int next = live;
+        unsigned int layer = 0;
+        for (unsigned int i = 0; i < N_Ins; ++i) {
+            unsigned long long int m1 = canal_input_masks[i] & live;
+            unsigned long long int m0 = ~canal_input_masks[i] & live;
+            // Inputs fixed in earlier layers leave one of m1, m0 empty here
+            if (m1 == 0ULL || m0 == 0ULL) { continue; }
+            if ((f & m1) == 0ULL || (f & m1) == m1) {
+                next &= ~m1;
+                ++layer;
+            } else if ((f & m0) == 0ULL || (f & m0) == m0) {
+                next &= ~m0;
+                ++layer;
+            }
+        }
+        if (layer == 0) {
+            break;
         }
+        depth += layer;
+        live = next;
     }
-
-    return canal;
+    return depth;
 }
 
+/*!
+ * If non-null, canalyzingness() looks up the result of isCanalyzing() for each genosect in this
+ * table, which is indexed by the value of the genosect. Set up by FunctionTables::init() (see
+ * functables.h) when N_Ins <= 4.
+ */
+const unsigned char* canal_table = (const unsigned char*)0;
+
 /*!
  * Test each section of the genosect and determine how many of the truth tables are canalysing
  * functions. Return the number of truth tables that are canalysing.
@@ -1143,13 +1711,42 @@ canalyzingness (const array<genosect_t, N_Genes>& g1)
     unsigned int canal = 0;
     for (unsigned int i = 0; i < N_Genes; ++i) {
         DBG2 ("=== isCanalysing? genome section " << i << " ===");
-        unsigned int _canal = isCanalyzing (g1[i]);
+        unsigned int _canal = canal_table ? canal_table[g1[i]] : isCanalyzing (g1[i]);
         DBG2 ("Section " << i << " has canalysing value: " << _canal);
         canal += _canal;
     }
     return canal;
 }
 
+/*!
+ * Compute canalyzingness() for each of the n genomes in g, writing the results to canal. The
+ * genosects are classified all together, with isCanalyzing_batch(), unless canal_table is set.
+ */
+void
+canalyzingness_batch (const array<genosect_t, N_Genes>* g, unsigned int* canal, size_t n)
+{
+    static_assert (sizeof(array<genosect_t, N_Genes>) == N_Genes * sizeof(genosect_t),
+                   "canalyzingness_batch() reads the genomes as one array of genosects");
+    if (n == 0) { return; }
+    vector<unsigned int> sect_canal (n * N_Genes);
+    const genosect_t* gs = g[0].data();
+    if (canal_table) {
+        for (size_t k = 0; k < n * N_Genes; ++k) {
+            sect_canal[k] = canal_table[gs[k]];
+        }
+    } else {
+        isCanalyzing_batch (gs, &sect_canal[0], n * N_Genes);
+    }
+    for (size_t k = 0; k < n; ++k) {
+        canal[k] = 0;
+        for (unsigned int i = 0; i < N_Genes; ++i) {
+            canal[k] += sect_canal[k * N_Genes + i];
+        }
+    }
+}
+
+#endif // Genosect_Words == 1
+
 /*!
  * Compute the bias; the proportion of set bits in the genome.
  */
@@ -1164,4 +1761,7 @@ bias (const array<genosect_t, N_Genes>& g1)
     }
     return (double)bits/(double)(N_Genes*(1<<N_Genes));
 }
+
+SIM_NAMESPACE_END
+
 #endif // __LIB_H__
@@ -0,0 +1,203 @@
+/*!
+ * Sampling the outcomes of mutation: for each of a number of starting
+ * genomes with F>0, mutate it many times and count how many of the
+ * mutants are fitter than it and how many are equally fit. Used by
+ * prob_fitinc and prob_fitinc_bybits, which differ only in how they
+ * mutate.
+ *
+ * The starting genomes are held in a GenomePool on the heap, so the
+ * number of starts is limited by memory rather than by the stack. The
+ * starts are shared between the OpenMP threads, each with its own RNG
+ * stream, and as each start is mutated by one thread only its counts
+ * need no locking.
+ */
+
+#ifndef __MUTANT_OUTCOME_H__
+#define __MUTANT_OUTCOME_H__
+
+#include <vector>
+#include <array>
+#include <string>
+#include <fstream>
+#include <iostream>
+#include <atomic>
+#ifdef _OPENMP
+# include <omp.h>
+#endif
+#include "sim_namespace.h"
+
+using namespace std;
+
+SIM_NAMESPACE_BEGIN
+
+#ifndef __LIB_H__
+#error "#include lib.h before #including mutant_outcome.h"
+#endif
+#ifndef __FITNESS_FUNCTION__
+#error "#include a fitness.h before #including mutant_outcome.h"
+#endif
+
+/*!
+ * A pool of n genomes, stored gene by gene (all the first genosects,
+ * then all the second, and so on).
+ */
+class GenomePool
+{
+public:
+    GenomePool (size_t _n) : n(_n), sects(_n * N_Genes, 0) {}
+
+    void load (size_t s, array<genosect_t, N_Genes>& genome) const
+    {
+        for (unsigned int i = 0; i < N_Genes; ++i) {
+            genome[i] = this->sects[i * this->n + s];
+        }
+    }
+
+    void store (size_t s, const array<genosect_t, N_Genes>& genome)
+    {
+        for (unsigned int i = 0; i < N_Genes; ++i) {
+            this->sects[i * this->n + s] = genome[i];
+        }
+    }
+
+    size_t size (void) const { return this->n; }
+
+private:
+    size_t n;
+    vector<genosect_t> sects;
+};
+
+class MutantOutcomeSampler
+{
+public:
+    /*!
+     * For nstarts starting genomes, each of which will be mutated
+     * nmutants times.
+     */
+    MutantOutcomeSampler (size_t _nstarts, unsigned long long int _nmutants)
+        : nstarts(_nstarts)
+        , nmutants(_nmutants)
+        , starts(_nstarts)
+        , initialFitness(_nstarts, 0.0)
+        , numFitter(_nstarts, 0)
+        , numEqual(_nstarts, 0)
+        , progress_every(100)
+    {
+#ifdef _OPENMP
+        this->nthreads = omp_get_max_threads();
+#else
+        this->nthreads = 1;
+#endif
+        // Seed one stream per thread from the global rd
+        rngDataInitStreams (this->rds, this->nthreads);
+    }
+
+    //! Choose the starting genomes: random genomes with F>0
+    void init_starts (void)
+    {
+#pragma omp parallel num_threads(this->nthreads)
+        {
+            RngData* trd = this->thread_rd();
+            array<genosect_t, N_Genes> genome;
+#pragma omp for schedule(static)
+            for (long long int s = 0; s < (long long int)this->nstarts; ++s) {
+                double f = 0.0;
+                while (f == 0.0) {
+                    random_genome (genome, trd);
+                    f = evaluate_fitness (genome);
+                }
+                this->starts.store (s, genome);
+                this->initialFitness[s] = f;
+            }
+        }
+    }
+
+    /*!
+     * Mutate each start nmutants times with mutate(genome, RngData*),
+     * counting the mutants which are fitter and which are equally fit.
+     */
+    template <typename Mutate>
+    void run (Mutate mutate)
+    {
+        atomic<unsigned long long int> done(0);
+#pragma omp parallel num_threads(this->nthreads)
+        {
+            RngData* trd = this->thread_rd();
+            array<genosect_t, N_Genes> genome;
+            array<genosect_t, N_Genes> testg;
+#pragma omp for schedule(dynamic,16)
+            for (long long int s = 0; s < (long long int)this->nstarts; ++s) {
+                this->starts.load (s, genome);
+                const double f0 = this->initialFitness[s];
+                unsigned long long int fitter = 0;
+                unsigned long long int equal = 0;
+                for (unsigned long long int e = 0; e < this->nmutants; ++e) {
+                    copy_genome (genome, testg);
+                    mutate (testg, trd);
+                    double newf = evaluate_fitness (testg);
+                    if (newf > f0) {
+                        // Fitness increased
+                        ++fitter;
+                    } else if (newf == f0) {
+                        ++equal;
+                    } // else new fitness is lower than initial fitness
+                }
+                this->numFitter[s] = fitter;
+                this->numEqual[s] = equal;
+
+                unsigned long long int d = ++done;
+                if (this->progress_every && d % this->progress_every == 0) {
+#pragma omp critical (mutant_outcome_progress)
+                    cout << d << "/" << this->nstarts << " genomes tested..." << endl;
+                }
+            }
+        }
+    }
+
+    /*!
+     * Write a line for each start: its genome_id, its fitness and the
+     * numbers of its mutants which were fitter, equally fit and less
+     * fit. Returns false if the file couldn't be opened.
+     */
+    bool write (const string& path) const
+    {
+        ofstream fout (path.c_str(), ios::out|ios::trunc);
+        if (!fout.is_open()) {
+            return false;
+        }
+        fout << "GenomeID,Fitness,NumberEvolvingFitter,NumberEvolvingEqual,NumberEvolvingLessFit" << endl;
+        array<genosect_t, N_Genes> genome;
+        for (size_t s = 0; s < this->nstarts; ++s) {
+            this->starts.load (s, genome);
+            fout << genome_id(genome) << "," << this->initialFitness[s] << "," << this->numFitter[s]
+                 << "," << this->numEqual[s] << "," << (this->nmutants - (this->numFitter[s] + this->numEqual[s])) << "\n";
+        }
+        return true;
+    }
+
+    size_t nstarts;
+    unsigned long long int nmutants;
+    GenomePool starts;
+    vector<double> initialFitness;
+    vector<unsigned long long int> numFitter;
+    vector<unsigned long long int> numEqual;
+    //! Report progress after every this many starts (0 for none)
+    unsigned long long int progress_every;
+
+private:
+    RngData* thread_rd (void)
+    {
+#ifdef _OPENMP
+        return &this->rds[omp_get_thread_num()];
+#else
+        return &this->rds[0];
+#endif
+    }
+
+    unsigned int nthreads;
+    vector<RngData> rds;
+};
+
+SIM_NAMESPACE_END
+
+#endif // __MUTANT_OUTCOME_H__
@@ -7,6 +7,16 @@
 #define _MUTATION_H_
 
 #include <math.h>
+#include <atomic>
+#ifdef _OPENMP
+# include <omp.h>
+#endif
+
+#include "genomeset.h"
+#include "neighbourhood.h"
+#include "sim_namespace.h"
+
+SIM_NAMESPACE_BEGIN
 
 #ifndef __FITNESS_FUNCTION__
 #error "#include a fitness.h before #including mutations.h to ensure evaluate_fitness() is available"
@@ -14,59 +24,21 @@
 
 /*!
  * Return the number of fit mutations of genome at a Hamming
- * distance of h. Exponentially costly in h, I think.
+ * distance of h, along with the sum of their fitnesses. Every mutant
+ * is evaluated (see neighbourhood_sweep()), so this is exponentially
+ * costly in h.
  */
 pair<unsigned int, double>
 num_fit_mutations (const array<genosect_t, N_Genes>& genome, unsigned int h)
 {
-    // Return variables
     unsigned int numfit = 0;
     double fitness_sum = 0.0;
 
-    // The length of the genome
-    unsigned int l_genome = N_Genes * (1<<N_Ins);
-
-    // A genome that gets flipped from the original genome and then evaluated.
-    array<genosect_t, N_Genes> flipped_genome;
-
-    // This makes combo long enough for h all the way up to the full
-    // width of the genome.  combo[i] is the index of the i-th element
-    // in the combination
-    int combo[N_Genes * (1<<N_Ins)];
-
-    // Setup combo for the initial combination - first h bits set to
-    // 1. Set everything else to 0
-    for (int i = 0; i < static_cast<int>(h); ++i) { combo[static_cast<unsigned int>(i)] = i; }
-    for (unsigned int i = h; i < l_genome; ++i) { combo[i] = 0; }
-
-    // Generate and evaluate all the combinations
-    bool finished = false;
-    while (!finished) {
-        // printc (combo, h);
-
-        // Initialise flipped_genome
-        copy_genome (genome, flipped_genome);
-
-        // Work out flipped_genome[i]s and then compute fitness
-        for (unsigned int i = 0; i < N_Genes; ++i) {
-            for (unsigned int j = 0; j < h; ++j) {
-                if (combo[j] >= static_cast<int>(i*(1<<N_Ins))
-                    && combo[j] < static_cast<int>((i+1)*(1<<N_Ins))) {
-                    // Then combo[j] is an index that is in genosect[i] so flip this bit.
-                    unsigned int bit_to_flip = combo[j] - (i*(1<<N_Ins));
-                    flipped_genome[i] ^= (0x1 << bit_to_flip);
-                }
-            }
-        }
-
-        double f = evaluate_fitness (flipped_genome);
-        if (f > 0.0) {
+    vector<double> f = neighbourhood_sweep (genome, h);
+    for (size_t i = 0; i < f.size(); ++i) {
+        if (f[i] > 0.0) {
             ++numfit;
-            fitness_sum += f;
-        }
-
-        if (!next_combination (combo, h, l_genome)) {
-            finished = true;
+            fitness_sum += f[i];
         }
     }
 
@@ -77,6 +49,12 @@ num_fit_mutations (const array<genosect_t, N_Genes>& genome, unsigned int h)
 /*!
  * Compute an estimate of the number of fit mutations at a given
  * Hamming distance, hd, by making a number of samples, num_samples.
+ *
+ * Each sample is a distinct flip mask with hd bits set, drawn
+ * directly with Floyd's algorithm (random_flip_mask()). Masks that
+ * have already been evaluated are rejected using a
+ * ConcurrentGenomeSet. The samples are shared out over the OpenMP
+ * threads, each of which has its own RNG stream, seeded from rd.
  */
 pair<unsigned int, double>
 num_fit_mutations_sample (const array<genosect_t, N_Genes>& genome,
@@ -85,57 +63,59 @@ num_fit_mutations_sample (const array<genosect_t, N_Genes>& genome,
     unsigned int numfit = 0;
     double fitness_sum = 0.0;
 
-    unsigned int n_in_gs = (1 << N_Ins);
-    vector<unsigned int> flipbit (hd, 0);
-    array<genosect_t, N_Genes> flip_mask;
-    array<genosect_t, N_Genes> flipped_genome;
-
-    set<array<genosect_t, N_Genes> > masks;
-
-    for (unsigned int s = 0; s < num_samples; ++s) {
-
-        copy_genome (genome, flipped_genome);
-        zero_genome (flip_mask);
-
-        // Get random numbers to determine flipping
-        //for (unsigned int h = 0; h < hd; ++h) {
-        unsigned int h = 0;
-        unsigned int num_miss = 0;
-        while (h<hd) {
-            // Should be in range 0 to 80 for N_Genes==5
-            float f = randFloat() * N_Genes * n_in_gs;
-            flipbit[h] = (unsigned int)floorf (f);
-            DBG2 ("flipbit[" << h << "]: " << flipbit[h]);
-            unsigned int fb = (unsigned int)floorf (f);
-            unsigned int fb_genosect = fb / n_in_gs;
-            unsigned int fb_offset = fb % n_in_gs;
-            // mask_part is the new part of the mask to flip
-            genosect_t mask_part = 0x1 << fb_offset;
-            // Make sure we didn't already flip this one!
-            if ((flip_mask[fb_genosect] & mask_part) != mask_part) {
-                // Set bit fb_offset in flip_mask[fb_genosect];
-                flip_mask[fb_genosect] |= mask_part;
-                ++h;
-                DBG2 ("Added to flip_mask...");
-            } else {
-                // Do nothing, make another sample from the RNG to flip another bit.
-                DBG2("It's a miss.");
-                ++num_miss;
-            }
-        }
-#ifdef DEBUG2
-        if (num_miss > 0) {
-            DBG ("Number of misses creating flip_mask was: " << num_miss);
-        }
+    // There have to be at least num_samples distinct masks to choose from, or we'd never finish.
+    unsigned int l_genome = N_Genes * (1 << N_Ins);
+    double n_masks = 1.0;
+    for (unsigned int i = 0; i < hd; ++i) {
+        n_masks = n_masks * (double)(l_genome - i) / (double)(i + 1);
+    }
+    if (hd > l_genome || n_masks < (double)num_samples) {
+        stringstream ee;
+        ee << "Can't make " << num_samples << " distinct samples at Hamming distance " << hd;
+        throw runtime_error (ee.str());
+    }
+
+    ConcurrentGenomeSet masks (num_samples);
+
+#ifdef _OPENMP
+    unsigned int nthreads = omp_get_max_threads();
+#else
+    unsigned int nthreads = 1;
 #endif
-        // Check we didn't already choose this one.
-        DBG2 ("Check if flip_mask already seen...");
-        if (masks.count(flip_mask) == 0) {
-            masks.insert(flip_mask);
+    vector<RngData> rds;
+    rngDataInitStreams (rds, nthreads);
+
+    // How many distinct masks have been claimed for evaluation
+    atomic<unsigned int> claimed(0);
+
+#pragma omp parallel num_threads(nthreads) reduction(+:numfit,fitness_sum)
+    {
+#ifdef _OPENMP
+        RngData* trd = &rds[omp_get_thread_num()];
+#else
+        RngData* trd = &rds[0];
+#endif
+        array<genosect_t, N_Genes> flip_mask;
+        array<genosect_t, N_Genes> flipped_genome;
+
+        while (claimed.load() < num_samples) {
+
+            random_flip_mask (flip_mask, hd, trd);
+
+            // Check we didn't already choose this one.
+            if (!masks.insert (flip_mask)) {
+                DBG2 ("Flip mask seen :(");
+                continue;
+            }
+            // Other threads may have filled the quota since we checked.
+            if (claimed.fetch_add (1) >= num_samples) {
+                break;
+            }
+
             // Now do the flipping, genome section by genome section
 #pragma omp simd
             for (unsigned int i=0; i<N_Genes; ++i) {
-                flipped_genome[i] ^= flip_mask[i];
+                flipped_genome[i] = genome[i] ^ flip_mask[i];
             }
             // Now evaluate the fitness
             double f = evaluate_fitness (flipped_genome);
@@ -143,10 +123,6 @@ num_fit_mutations_sample (const array<genosect_t, N_Genes>& genome,
                 ++numfit;
                 fitness_sum += f;
             }
-        } else {
-            // We found a duplicate mask, so decrement s to make sure we do one more random sample.
-            DBG2 ("Flip mask seen :(");
-            --s;
         }
     }
     DBG ("Numfit:" << numfit << " sum of fitness: " << fitness_sum);
@@ -187,4 +163,6 @@ evolve_new_genome (void)
     return refg;
 }
 
+SIM_NAMESPACE_END
+
 #endif // _MUTATION_H_
@@ -0,0 +1,232 @@
+/*!
+ * Sweeps over the mutational neighbourhood of a genome. Given a
+ * genome and a radius, h, evaluate the fitness of every genome which
+ * differs from it in exactly h bits.
+ *
+ * Rather than developing each mutant with compute_next(), the state
+ * transition table of the parent genome is computed once. Flipping a
+ * bit of the genome changes only the successor(s) of the state(s) that
+ * address that bit, so each mutant's transition table is the parent's
+ * with a handful of entries altered. For the fitness functions which
+ * score only the developmental trajectories from initial_ant and
+ * initial_pos (those that define FF_SCORES_TRAJECTORIES_ONLY), if none
+ * of those entries lie on the parent's trajectories then the mutant
+ * develops exactly as the parent did and has the parent's fitness.
+ * The others (FF0 and FF3 score every basin of attraction) evaluate
+ * every mutant in full.
+ */
+
+#ifndef __NEIGHBOURHOOD_H__
+#define __NEIGHBOURHOOD_H__
+
+#include <array>
+#include <vector>
+#include <bitset>
+#include <stdexcept>
+#include <math.h>
+#ifdef _OPENMP
+# include <omp.h>
+#endif
+#include "sim_namespace.h"
+
+using namespace std;
+
+SIM_NAMESPACE_BEGIN
+
+#ifndef __FITNESS_FUNCTION__
+#error "#include a fitness.h before #including neighbourhood.h to ensure evaluate_fitness() is available"
+#endif
+
+/*!
+ * The number of mutants which are enumerated, then evaluated in
+ * parallel, at a time.
+ */
+#define NEIGHBOURHOOD_CHUNK 65536
+
+/*!
+ * The number of states which address each bit of a genosect. For k=n,
+ * this is 1; for k=n-1, the ignored input may take either value, so
+ * it's 2.
+ */
+#define N_States_Per_Bit (1 << (N_Genes - N_Ins))
+
+/*!
+ * Compute the state transition table for genome. succ must have room
+ * for 1<<N_Genes entries; succ[s] is the state that follows s.
+ */
+void
+compute_transitions (const array<genosect_t, N_Genes>& genome, state_t* succ)
+{
+    for (unsigned int s = 0; s < (1 << N_Genes); ++s) {
+        state_t st = static_cast<state_t>(s);
+        compute_next (genome, st);
+        succ[s] = st;
+    }
+}
+
+/*!
+ * For every bit of the genome, find the states whose successor is
+ * determined by that bit. Bit b of genosect g is at index
+ * g*(1<<N_Ins)+b, as in num_fit_mutations().
+ */
+void
+compute_bit_states (vector<array<state_t, N_States_Per_Bit> >& bit_states)
+{
+    unsigned int l_genome = N_Genes * (1 << N_Ins);
+    bit_states.resize (l_genome);
+    vector<unsigned int> n_found (l_genome, 0);
+
+    array<state_t, N_Genes> inputs;
+    for (unsigned int s = 0; s < (1 << N_Genes); ++s) {
+        compute_next_common (static_cast<state_t>(s), inputs);
+        for (unsigned int g = 0; g < N_Genes; ++g) {
+            unsigned int idx = g * (1 << N_Ins) + inputs[g];
+            bit_states[idx][n_found[idx]++] = static_cast<state_t>(s);
+        }
+    }
+}
+
+/*!
+ * Mark the states visited, from initial_ant and initial_pos, when
+ * developing with the transition table succ. Includes the states of
+ * the limit cycles reached.
+ */
+bitset<(1 << N_Genes)>
+trajectory_states (const state_t* succ)
+{
+    bitset<(1 << N_Genes)> on_path;
+    state_t starts[2] = { initial_ant, initial_pos };
+    for (unsigned int i = 0; i < 2; ++i) {
+        state_t state = starts[i];
+        while (!on_path.test (state)) {
+            on_path.set (state);
+            state = succ[state];
+        }
+    }
+    return on_path;
+}
+
+/*!
+ * Evaluate the fitness of one mutant, given the parent's transition
+ * table, the flips made to it (as genome bit indices) and the parent's
+ * fitness.
+ */
+double
+evaluate_mutant (const array<genosect_t, N_Genes>& genome,
+                 const state_t* parent_succ,
+                 const bitset<(1 << N_Genes)>& on_path,
+                 const vector<array<state_t, N_States_Per_Bit> >& bit_states,
+                 const int* combo, unsigned int h, double parent_fitness)
+{
+#ifdef FF_SCORES_TRAJECTORIES_ONLY
+    // If no changed transition lies on the parent's trajectories, nothing changes.
+    bool changed = false;
+    for (unsigned int j = 0; j < h && !changed; ++j) {
+        for (unsigned int k = 0; k < N_States_Per_Bit; ++k) {
+            if (on_path.test (bit_states[combo[j]][k])) {
+                changed = true;
+                break;
+            }
+        }
+    }
+    if (!changed) {
+        return parent_fitness;
+    }
+#endif
+
+#ifdef FF_HAS_TABLE_EVALUATION
+    // Gene g's output is state bit N_Genes-1-g (see compute_next()).
+    state_t succ[(1 << N_Genes)];
+    for (unsigned int s = 0; s < (1 << N_Genes); ++s) {
+        succ[s] = parent_succ[s];
+    }
+    for (unsigned int j = 0; j < h; ++j) {
+        unsigned int g = combo[j] >> N_Ins;
+        for (unsigned int k = 0; k < N_States_Per_Bit; ++k) {
+            succ[bit_states[combo[j]][k]] ^= (0x1 << (N_Genes-1-g));
+        }
+    }
+    return evaluate_fitness_table (succ);
+#else
+    // This fitness function can only be evaluated from the genome itself
+    array<genosect_t, N_Genes> mutant = genome;
+    for (unsigned int j = 0; j < h; ++j) {
+        unsigned int g = combo[j] >> N_Ins;
+        mutant[g] ^= (GENOSECT_ONE << (combo[j] - g * (1 << N_Ins)));
+    }
+    return evaluate_fitness (mutant);
+#endif
+}
+
+/*!
+ * Return the fitness of every genome a Hamming distance h from
+ * genome. The fitnesses are ordered as the combinations of flipped bit
+ * indices are generated by next_combination(), so for h=1, element i
+ * is the fitness of the genome with bit i (bit i%(1<<N_Ins) of genosect
+ * i/(1<<N_Ins)) flipped. For h=0 the one element is the fitness of
+ * genome.
+ *
+ * The mutants are evaluated in parallel.
+ */
+vector<double>
+neighbourhood_sweep (const array<genosect_t, N_Genes>& genome, unsigned int h)
+{
+    unsigned int l_genome = N_Genes * (1 << N_Ins);
+    if (h > l_genome) {
+        throw runtime_error ("neighbourhood_sweep: Hamming distance exceeds genome length");
+    }
+
+    // The number of mutants, l_genome choose h
+    double n_mutants = 1.0;
+    for (unsigned int i = 0; i < h; ++i) {
+        n_mutants = n_mutants * (double)(l_genome - i) / (double)(i + 1);
+    }
+    if (n_mutants > (double)0x7fffffff) {
+        throw runtime_error ("neighbourhood_sweep: too many mutants at this Hamming distance");
+    }
+
+    array<genosect_t, N_Genes> parent = genome;
+    double parent_fitness = evaluate_fitness (parent);
+
+    vector<double> fitness (static_cast<size_t>(n_mutants + 0.5), parent_fitness);
+    if (h == 0) {
+        return fitness;
+    }
+
+    state_t parent_succ[(1 << N_Genes)];
+    compute_transitions (genome, parent_succ);
+    bitset<(1 << N_Genes)> on_path = trajectory_states (parent_succ);
+    vector<array<state_t, N_States_Per_Bit> > bit_states;
+    compute_bit_states (bit_states);
+
+    // Enumerate the combinations serially, a chunk at a time, then evaluate each chunk in parallel.
+    vector<int> combo (l_genome, 0);
+    for (unsigned int i = 0; i < h; ++i) { combo[i] = i; }
+    vector<int> chunk (NEIGHBOURHOOD_CHUNK * h);
+
+    size_t done = 0;
+    bool finished = false;
+    while (!finished) {
+        int n_chunk = 0;
+        while (n_chunk < NEIGHBOURHOOD_CHUNK && !finished) {
+            for (unsigned int j = 0; j < h; ++j) {
+                chunk[n_chunk * h + j] = combo[j];
+            }
+            ++n_chunk;
+            finished = !next_combination (&combo[0], h, l_genome);
+        }
+
+#pragma omp parallel for schedule(static)
+        for (int m = 0; m < n_chunk; ++m) {
+            fitness[done + m] = evaluate_mutant (genome, parent_succ, on_path, bit_states,
+                                                 &chunk[m * h], h, parent_fitness);
+        }
+        done += n_chunk;
+    }
+
+    return fitness;
+}
+
+SIM_NAMESPACE_END
+
+#endif // __NEIGHBOURHOOD_H__
@@ -1,341 +1,293 @@
+/*!
+ * Quine-McCluskey minimisation of a Boolean function of up to 6
+ * variables, used to find the complexity of a genosect.
+ *
+ * The function is held as a 64 bit truth table, bit m being set if m
+ * is a minterm. An implicant is a (value, mask) pair; the bits set in
+ * mask are the "don't care" positions, and value has those bits clear.
+ * The minterms covered by an implicant are then also a 64 bit set, so
+ * the prime implicant chart is a table of bitsets.
+ *
+ * The implicants are generated a popcount (of mask) at a time: for
+ * each mask there's a bitset over the values for which (value, mask)
+ * is an implicant, and the implicants with mask m|b are those pairs of
+ * implicants with mask m which differ only in bit b. An implicant which
+ * can't be merged in this way with any bit is prime.
+ *
+ * The complexity is the number of prime implicants in a minimal sum of
+ * products, divided by 2^vars. The minimal cover is found by branch and
+ * bound, which gives the same result as Petrick's method did in the
+ * earlier, string-labelled implementation. Everything is held in fixed
+ * size arrays, so that there are no heap allocations.
+ */
+
+#ifndef __QUINE_H__
+#define __QUINE_H__
+
 #include <iostream>
-#include <iomanip>
-#include <sstream>
 #include <string>
-#include <vector>
-#include <algorithm>
+#include <bitset>
+#include <stdexcept>
+#include "sim_namespace.h"
 
 using namespace std;
 
-// To see the tables from the original example, define VERBOSEOUT here, or with a -D switch to
-// your compile command
-//
-// #define VERBOSEOUT 1
+SIM_NAMESPACE_BEGIN
 
-struct Implicant
-{
-    int implicant;
-    int mask;
-    int ones;
-    int vars;
-    bool used;
-    string minterms;
-    string bits;
-    vector<int> mints;
-
-    Implicant(int i = 0,
-              int _vars = 1,
-              vector<int> min = vector<int>(),
-              string t = "",
-              int m = 0, bool
-              u = false)
-        : implicant(i)
-        , mask(m)
-        , ones(0)
-        , vars(_vars)
-        , used(u)
-    {
-        if (t == "") {
-            stringstream ss;
-            ss << 'm' << i;
-            minterms = ss.str();
-        } else {
-            minterms = t;
-        }
-        if (min.empty()) {
-            mints.push_back(i);
-        } else {
-            mints = min;
-        }
-        int bit = 1 << vars;
-        while (bit >>= 1) {
-            if (m & bit) {
-                bits += '-';
-            } else if (i & bit) {
-                bits += '1'; ++ones;
-            } else {
-                bits += '0';
-            }
-        }
-    }
+//! The largest number of variables that the truth table can hold
+#define QUINE_MAX_VARS 6
 
-    bool operator<(const Implicant& b) const { return ones < b.ones; }
+//! The number of entries in the truth table
+#define QUINE_MAX_MINTERMS (1 << QUINE_MAX_VARS)
 
-    vector<int> cat (const Implicant &b) {
-        vector<int> v = mints;
-        v.insert (v.end(), b.mints.begin(), b.mints.end());
-        return v;
-    }
+/*!
+ * Room for the prime implicants. No function of 6 variables has more
+ * than 92.
+ */
+#define QUINE_MAX_PRIMES 128
 
-    // An output function. Takes two boolean args for formatting.
-    string output (const bool& pr, const bool& fin) {
-        int bit = 1 << this->vars, lit = 0;
-        ostringstream ss;
-        if (fin) {
-            ss << right << setw(16);
-        }
-        while (bit >>= 1) {
-            if (!(this->mask & bit)) {
-                ss << char(lit + 'A') << (this->implicant & bit ? ' ' : '\'');
-            }
-            ++lit;
-        }
-        if (pr) {
-            ss << '\t' << setw(16) << left << this->minterms << ' ' << this->bits << '\t' << this->ones;
-        }
-        return ss.str();
-    }
+struct Implicant
+{
+    //! The literals; bits which are set in mask are zero here.
+    unsigned int value;
+    //! The "don't care" positions
+    unsigned int mask;
 };
 
 class Quine
 {
 public:
-    int combs;
-    vector<int> minterms;
-    vector<Implicant> implicants;
-    int vars;
-    bool pr = true;
-    bool fin = true;
-    //! Stores results of expression compression
-    vector<size_t> M0, M1;
-    //! Stores results of expression compression
-    vector<Implicant> primes;
-    //! The final complexity value.
-    unsigned int cplexity = 0;
-    unsigned int outof = 0;
-    size_t ind = 0;
-
     Quine (int _vars)
-        : vars(_vars) {
-        combs = 1 << this->vars;
+        : vars(_vars)
+        , fn(0)
+        , nprimes(0)
+        , ncover(0)
+    {
+        if (this->vars < 1 || this->vars > QUINE_MAX_VARS) {
+            throw runtime_error ("Quine: the number of variables must be from 1 to 6");
+        }
     }
 
-    void addMinterm (int m) {
-        minterms.push_back (m);
-        implicants.push_back (Implicant(m, vars));
+    //! Add the minterm m to the function.
+    void addMinterm (int m)
+    {
+        this->fn |= (0x1ULL << m);
     }
 
-    int count1s (size_t x) {
-        int o = 0;
-        while (x) {
-            o += x % 2;
-            x >>= 1;
-        }
-        return o;
+    //! Set the whole function from its truth table (bit m set if m is a minterm).
+    void setFunction (unsigned long long int _fn)
+    {
+        this->fn = _fn & this->allMinterms();
     }
 
-    void mul (vector<size_t> &a, const vector<size_t> &b) {
-        vector<size_t> v;
-        for (size_t i = 0; i < a.size(); ++i) {
-            for (size_t j = 0; j < b.size(); ++j) {
-                v.push_back(a[i] | b[j]);
-            }
+    //! Find the prime implicants and a minimal cover.
+    void go (void)
+    {
+        this->findPrimes();
+        this->findCover();
+    }
+
+    //! Run after go()
+    double complexity (void) const
+    {
+        return (double)this->ncover / (double)(1 << this->vars);
+    }
+
+    //! The number of prime implicants in the minimal cover. Run after go()
+    unsigned int coverSize (void) const { return this->ncover; }
+
+    //! The number of prime implicants. Run after go()
+    unsigned int numPrimes (void) const { return this->nprimes; }
+
+    //! Run after go()
+    string min (void) const
+    {
+        if (this->fn == 0) {
+            return string("F = 0");
         }
-        sort (v.begin(), v.end());
-        v.erase (unique (v.begin(), v.end()), v.end());
-        for (size_t i = 0; i < v.size() - 1; ++i) {
-            for (size_t j = v.size() - 1; j > i ; --j) {
-                size_t z = v[i] & v[j];
-                if ((z & v[i]) == v[i]) {
-                    v.erase (v.begin() + j);
-                } else if ((z & v[j]) == v[j]) {
-                    size_t t = v[i];
-                    v[i] = v[j];
-                    v[j] = t;
-                    v.erase(v.begin() + j);
-                    j = v.size();
+        string s("F = ");
+        for (unsigned int i = 0; i < this->ncover; ++i) {
+            if (i > 0) { s += " + "; }
+            const Implicant& p = this->primes[this->cover[i]];
+            for (int v = 0; v < this->vars; ++v) {
+                unsigned int bit = 0x1 << (this->vars - 1 - v);
+                if (!(p.mask & bit)) {
+                    s += char(v + 'A');
+                    s += (p.value & bit) ? ' ' : '\'';
                 }
             }
         }
-        a = v;
+        return s;
     }
 
-    void go (void) {
-#ifdef VERBOSEOUT
-        if (!minterms.size()) { cout << "\n\tF = 0\n"; }
-#endif
-        sort (minterms.begin(), minterms.end());
-        minterms.erase( unique( minterms.begin(), minterms.end() ), minterms.end() );
-
-#if 0
-        if (!cin.eof() && cin.fail()) { // don't cares
-            cin.clear();
-            while ('d' != cin.get()) ;
-            for (int mint; cin >> mint; ) {
-                implicants.push_back (mint);
-            }
-        }
-#endif
-        sort (implicants.begin(), implicants.end());
-#ifdef VERBOSEOUT
-        for (size_t i = 0; i < implicants.size(); ++i) {
-            cout << implicants[i].output(pr, fin) << endl;
+private:
+    //! The truth table with every minterm set
+    unsigned long long int allMinterms (void) const
+    {
+        return this->vars == QUINE_MAX_VARS ? ~0ULL : ((1ULL << (1 << this->vars)) - 1ULL);
+    }
+
+    void findPrimes (void)
+    {
+        unsigned int nmasks = 1 << this->vars;
+
+        // impl[m] bit v is set if (v, m) is an implicant. cube[m] holds
+        // the minterms of (0, m); those of (v, m) are cube[m] << v.
+        unsigned long long int impl[QUINE_MAX_MINTERMS];
+        unsigned long long int cube[QUINE_MAX_MINTERMS];
+        impl[0] = this->fn;
+        cube[0] = 0x1ULL;
+
+        for (unsigned int m = 1; m < nmasks; ++m) {
+            // Build from m without its lowest bit, b
+            unsigned int b = m & (~m + 1);
+            unsigned int m0 = m ^ b;
+            impl[m] = impl[m0] & (impl[m0] >> b) & Quine::clearBit (b);
+            cube[m] = cube[m0] | (cube[m0] << b);
         }
-        cout << "-------------------------------------------------------\n";
-#endif
-        vector<Implicant> aux;
-        while (implicants.size() > 1) {
-            for (size_t i = 0; i < implicants.size() - 1; ++i) {
-                for (size_t j = implicants.size() - 1; j > i ; --j) {
-                    if (implicants[j].bits == implicants[i].bits) {
-                        implicants.erase (implicants.begin() + j);
-                    }
-                }
-            }
-            aux.clear();
-            for (size_t i = 0; i < implicants.size() - 1; ++i) {
-                for (size_t j = i + 1; j < implicants.size(); ++ j) {
-                    if (implicants[j].ones == implicants[i].ones + 1 &&
-                        implicants[j].mask == implicants[i].mask &&
-                        count1s(implicants[i].implicant ^
-                                implicants[j].implicant) == 1) {
-                        implicants[i].used = true;
-                        implicants[j].used = true;
-                        aux.push_back(Implicant(implicants[i].implicant,
-                                                this->vars,
-                                                implicants[i].cat(implicants[j]),
-                                                implicants[i].minterms + ',' +
-                                                implicants[j].minterms,
-                                                (implicants[i].implicant ^
-                                                 implicants[j].implicant) | implicants[i].mask));
-                    }
-                }
-            }
-            for (size_t i = 0; i < implicants.size(); ++i) {
-                if (!implicants[i].used) {
-                    primes.push_back(implicants[i]);
+
+        // Collect the primes in order of the popcount of their masks
+        this->nprimes = 0;
+        for (unsigned int level = 0; level <= (unsigned int)this->vars; ++level) {
+            for (unsigned int m = 0; m < nmasks; ++m) {
+                if (bitset<QUINE_MAX_VARS>(m).count() != level) { continue; }
+                // (v, m) is not prime if it merges into (v & ~b, m|b) for some bit b not in m.
+                unsigned long long int merged = 0;
+                for (unsigned int b = 1; b < nmasks; b <<= 1) {
+                    if (m & b) { continue; }
+                    merged |= impl[m|b] | (impl[m|b] << b);
                 }
-            }
-            implicants = aux;
-            sort (implicants.begin(), implicants.end());
-#ifdef VERBOSEOUT
-            for (size_t i = 0; i < implicants.size(); ++i) {
-                cout << implicants[i].output(pr, fin) << endl;
-            }
-            cout << "-------------------------------------------------------\n";
-#endif
-        }
-        for (size_t i = 0; i < implicants.size(); ++i) {
-            primes.push_back (implicants[i]);
-        }
-#ifdef VERBOSEOUT
-        if (primes.back().mask == combs - 1) {
-            cout << "\n\tF = 1\n";
-        }
-#endif
-        this->pr = false;
-        bool table[primes.size()][minterms.size()];
-        for (size_t i = 0; i < primes.size(); ++i) {
-            for (size_t k = 0; k < minterms.size(); ++k) {
-                table[i][k] = false;
-            }
-        }
-        for (size_t i = 0; i < primes.size(); ++i) {
-            for (size_t j = 0; j < primes[i].mints.size(); ++j) {
-                for (size_t k = 0; k < minterms.size(); ++k) {
-                    if (primes[i].mints[j] == minterms[k]) {
-                        table[i][k] = true;
+                unsigned long long int prime = impl[m] & ~merged;
+                while (prime) {
+                    unsigned int v = this->lowestBit (prime);
+                    prime &= prime - 1;
+                    if (this->nprimes == QUINE_MAX_PRIMES) {
+                        throw runtime_error ("Quine: too many prime implicants");
                     }
+                    this->primes[this->nprimes].value = v;
+                    this->primes[this->nprimes].mask = m;
+                    this->covers[this->nprimes] = cube[m] << v;
+                    ++this->nprimes;
                 }
             }
         }
-#ifdef VERBOSEOUT
-        for (int k = 0; k < 18; ++k) { cout << " "; }
-        for (size_t k = 0; k < minterms.size(); ++k) {
-            cout << right << setw(2) << minterms[k] << ' ';
-        }
-        cout << endl;
-        for (int k = 0; k < 18; ++k) { cout << " "; }
-        for (size_t k = 0; k < minterms.size(); ++k) {
-            cout << "---";
+    }
+
+    void findCover (void)
+    {
+        // The prime implicant chart, by minterm
+        for (unsigned int t = 0; t < QUINE_MAX_MINTERMS; ++t) {
+            this->chart[t].reset();
         }
-        cout << endl;
-        for (size_t i = 0; i < primes.size(); ++i) {
-            cout << primes[i].output (pr, fin) << " |";
-            for (size_t k = 0; k < minterms.size(); ++k) {
-                cout << (table[i][k] ? " X " : " ");
+        for (unsigned int i = 0; i < this->nprimes; ++i) {
+            unsigned long long int c = this->covers[i];
+            while (c) {
+                this->chart[this->lowestBit (c)].set (i);
+                c &= c - 1;
             }
-            cout << endl;
         }
-#endif
-        for (size_t i = 0; i < primes.size(); ++i) {
-            if (table[i][0]) {
-                M0.push_back(1 << i);
+
+        // Start from a greedy cover as the bound for the search
+        unsigned long long int uncovered = this->fn;
+        this->ncover = 0;
+        while (uncovered) {
+            unsigned int best = 0, bestn = 0;
+            for (unsigned int i = 0; i < this->nprimes; ++i) {
+                unsigned int n = bitset<QUINE_MAX_MINTERMS>(this->covers[i] & uncovered).count();
+                if (n > bestn) { best = i; bestn = n; }
             }
+            this->cover[this->ncover++] = best;
+            uncovered &= ~this->covers[best];
         }
-        for (size_t k = 1; k < minterms.size(); ++k) {
-            M1.clear();
-            for (size_t i = 0; i < primes.size(); ++i) {
-                if (table[i][k]) {
-                    M1.push_back(1 << i);
-                }
+
+        unsigned int trial[QUINE_MAX_PRIMES];
+        this->search (this->fn, trial, 0);
+    }
+
+    /*!
+     * Depth first search for a smaller cover of the minterms in
+     * uncovered, given the depth primes chosen so far in trial. Each
+     * step branches on the primes which cover the uncovered minterm
+     * with the fewest primes covering it.
+     */
+    void search (unsigned long long int uncovered, unsigned int* trial, unsigned int depth)
+    {
+        if (uncovered == 0) {
+            if (depth < this->ncover) {
+                for (unsigned int i = 0; i < depth; ++i) { this->cover[i] = trial[i]; }
+                this->ncover = depth;
             }
-            this->mul (M0, M1);
+            return;
         }
-        int min = count1s(M0[0]);
-        this->ind = 0;
-        for (size_t i = 1; i < M0.size(); ++i) {
-            if (min > count1s(M0[i])) {
-                min = count1s(M0[i]);
-                this->ind = i;
-            }
+        if (depth + 1 >= this->ncover) {
+            return;
         }
-        this->fin = false;
-#ifdef VERBOSEOUT
-        bool f;
-        cout << "-------------------------------------------------------\n";
-        for (size_t j = 0; j < M0.size(); ++j) {
-            cout << "\tF = ";
-            f = false;
-            for (size_t i = 0; i < primes.size(); ++i)
-                if (M0[j] & (1 << i)) {
-                    if (f) { cout << " + "; }
-                    f = true;
-                    cout << primes[i].output (this->pr, this->fin);
-                }
-            cout << endl;
+
+        unsigned int t = 0, tn = QUINE_MAX_PRIMES + 1;
+        unsigned long long int u = uncovered;
+        while (u) {
+            unsigned int m = this->lowestBit (u);
+            u &= u - 1;
+            unsigned int n = this->chart[m].count();
+            if (n < tn) { t = m; tn = n; }
         }
-        cout << "-------------------------------------------------------\n";
-
-        // minimal solution
-        cout << "F = ";
-        f = false;
-        for (size_t i = 0; i < primes.size(); ++i) {
-            if (M0[this->ind] & (1 << i)) {
-                if (f) { cout << " + "; }
-                f = true;
-                cout << primes[i].output (this->pr, this->fin);
-            }
+
+        for (unsigned int i = 0; i < this->nprimes; ++i) {
+            if (!this->chart[t].test (i)) { continue; }
+            trial[depth] = i;
+            this->search (uncovered & ~this->covers[i], trial, depth + 1);
         }
-        cout << endl;
-#endif
     }
 
-    //! Run after go()
-    double complexity (void) {
-        this->cplexity = 0;
-
-        this->outof = 1 << this->vars;
-
-        for (size_t i = 0; i < primes.size(); ++i) {
-            if (M0[this->ind] & (1 << i)) {
-                this->cplexity++;
-            }
+    //! The values (as a bitset, like the truth table) which have bit b clear
+    static unsigned long long int clearBit (unsigned int b)
+    {
+        switch (b) {
+        case 0x1: return 0x5555555555555555ULL;
+        case 0x2: return 0x3333333333333333ULL;
+        case 0x4: return 0x0f0f0f0f0f0f0f0fULL;
+        case 0x8: return 0x00ff00ff00ff00ffULL;
+        case 0x10: return 0x0000ffff0000ffffULL;
+        default: return 0x00000000ffffffffULL;
         }
-        return (double)this->cplexity/(double)this->outof;
     }
 
-    //! Run after go()
-    string min (void) {
-        string s("F = ");
-        bool f = false;
-        for (size_t i = 0; i < primes.size(); ++i) {
-            if (M0[this->ind] & (1 << i)) {
-                if (f) { s += " + "; }
-                f = true;
-                s += primes[i].output (this->pr, this->fin);
-            }
-        }
-        return s;
+    //! The index of the lowest set bit of x, which must be non-zero
+    unsigned int lowestBit (unsigned long long int x) const
+    {
+        return bitset<QUINE_MAX_MINTERMS>((x & (~x + 1ULL)) - 1ULL).count();
     }
+
+    int vars;
+    //! The truth table
+    unsigned long long int fn;
+
+    //! The prime implicants, and the minterms each one covers
+    Implicant primes[QUINE_MAX_PRIMES];
+    unsigned long long int covers[QUINE_MAX_PRIMES];
+    unsigned int nprimes;
+
+    //! For each minterm, the primes which cover it
+    bitset<QUINE_MAX_PRIMES> chart[QUINE_MAX_MINTERMS];
+
+    //! The indices (into primes) of the minimal cover
+    unsigned int cover[QUINE_MAX_PRIMES];
+    unsigned int ncover;
 };
+
+/*!
+ * The complexity of the Boolean function of vars variables with truth
+ * table fn (e.g. a genosect, for vars=N_Ins).
+ */
+double
+function_complexity (unsigned long long int fn, int vars)
+{
+    Quine Q(vars);
+    Q.setFunction (fn);
+    Q.go();
+    return Q.complexity();
+}
+
+SIM_NAMESPACE_END
+
+#endif // __QUINE_H__
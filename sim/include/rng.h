@@ -42,6 +42,9 @@
 #include <climits>
 #include <ctime>
 #include <sys/time.h>
+#include "sim_namespace.h"
+
+SIM_NAMESPACE_BEGIN
 
 /*
  * Definition of a data storage class for use with this code. Each
@@ -260,3 +263,5 @@ int fastBinomial(RngData* rd, int N, float p)
 #define HACK_MACRO(rd,N,p) 1;                                           \
     int spks=fastBinomial(rd,N,p);                                      \
     for(unsigned int i=0;i<spks;++i) {DATAOutspike.push_back(num);}
+
+SIM_NAMESPACE_END
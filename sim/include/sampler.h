@@ -0,0 +1,524 @@
+/*!
+ * A Monte Carlo driver for estimating the proportions of genomes with
+ * F>0 and with F=1. Random genomes are evaluated in parallel batches
+ * and, after each batch, confidence intervals for the two
+ * proportions are updated. Sampling stops when both intervals are
+ * narrower than a target precision, relative to the estimate, (or
+ * when a maximum number of samples is reached) rather than after a
+ * fixed number of samples.
+ *
+ * The samples may be stratified by the number of set bits in the
+ * genome (that is, by bias()). The distribution of this number over
+ * the genome space is binomial, so the weight of each stratum is
+ * known exactly, and a genome from a stratum is drawn by choosing a
+ * number of bits from the stratum, then a uniformly random genome
+ * with that number of bits set.
+ */
+
+#ifndef __SAMPLER_H__
+#define __SAMPLER_H__
+
+#include <array>
+#include <vector>
+#include <stdexcept>
+#include <sstream>
+#include <math.h>
+#ifdef _OPENMP
+# include <omp.h>
+#endif
+#include "sim_namespace.h"
+
+using namespace std;
+
+SIM_NAMESPACE_BEGIN
+
+#ifndef __FITNESS_FUNCTION__
+#error "#include a fitness.h before #including sampler.h to ensure evaluate_fitness() is available"
+#endif
+
+/*!
+ * The kinds of confidence interval available.
+ */
+#define CI_WILSON          0
+#define CI_CLOPPER_PEARSON 1
+
+/*!
+ * The Wilson score interval for x successes in n trials, with z the
+ * normal quantile for the required confidence (1.96 for 95%). x and n
+ * may be non-integer "effective" counts.
+ */
+void
+wilson_interval (double x, double n, double z, double& lo, double& hi)
+{
+    if (n <= 0.0) { lo = 0.0; hi = 1.0; return; }
+    double p = x / n;
+    double z2 = z * z;
+    double denom = 1.0 + z2 / n;
+    double centre = (p + z2 / (2.0 * n)) / denom;
+    double half = (z / denom) * sqrt (p * (1.0 - p) / n + z2 / (4.0 * n * n));
+    lo = centre - half < 0.0 ? 0.0 : centre - half;
+    hi = centre + half > 1.0 ? 1.0 : centre + half;
+}
+
+/*!
+ * Continued fraction for the incomplete beta function (after
+ * Numerical Recipes' betacf).
+ */
+double
+betacf (double a, double b, double x)
+{
+    const double eps = 1e-14;
+    const double fpmin = 1e-300;
+    double qab = a + b, qap = a + 1.0, qam = a - 1.0;
+    double c = 1.0;
+    double d = 1.0 - qab * x / qap;
+    if (fabs(d) < fpmin) { d = fpmin; }
+    d = 1.0 / d;
+    double h = d;
+    for (int m = 1; m <= 10000; ++m) {
+        int m2 = 2 * m;
+        double aa = m * (b - m) * x / ((qam + m2) * (a + m2));
+        d = 1.0 + aa * d;
+        if (fabs(d) < fpmin) { d = fpmin; }
+        c = 1.0 + aa / c;
+        if (fabs(c) < fpmin) { c = fpmin; }
+        d = 1.0 / d;
+        h *= d * c;
+        aa = -(a + m) * (qab + m) * x / ((a + m2) * (qap + m2));
+        d = 1.0 + aa * d;
+        if (fabs(d) < fpmin) { d = fpmin; }
+        c = 1.0 + aa / c;
+        if (fabs(c) < fpmin) { c = fpmin; }
+        d = 1.0 / d;
+        double del = d * c;
+        h *= del;
+        if (fabs(del - 1.0) < eps) { break; }
+    }
+    return h;
+}
+
+/*!
+ * The regularized incomplete beta function I_x(a,b).
+ */
+double
+betai (double a, double b, double x)
+{
+    if (x <= 0.0) { return 0.0; }
+    if (x >= 1.0) { return 1.0; }
+    double bt = exp (lgamma(a + b) - lgamma(a) - lgamma(b) + a * log(x) + b * log(1.0 - x));
+    if (x < (a + 1.0) / (a + b + 2.0)) {
+        return bt * betacf (a, b, x) / a;
+    }
+    return 1.0 - bt * betacf (b, a, 1.0 - x) / b;
+}
+
+/*!
+ * The inverse of betai() in x, found by bisection.
+ */
+double
+betai_inv (double a, double b, double p)
+{
+    double lo = 0.0, hi = 1.0;
+    for (int i = 0; i < 200; ++i) {
+        double mid = 0.5 * (lo + hi);
+        if (betai (a, b, mid) < p) { lo = mid; } else { hi = mid; }
+        if (hi - lo < 1e-15 * hi) { break; }
+    }
+    return 0.5 * (lo + hi);
+}
+
+/*!
+ * The Clopper-Pearson ("exact") interval for x successes in n trials,
+ * at the confidence corresponding to the normal quantile z.
+ */
+void
+clopper_pearson_interval (double x, double n, double z, double& lo, double& hi)
+{
+    if (n <= 0.0) { lo = 0.0; hi = 1.0; return; }
+    double alpha = erfc (z / sqrt(2.0));
+    lo = (x <= 0.0) ? 0.0 : betai_inv (x, n - x + 1.0, alpha / 2.0);
+    hi = (x >= n) ? 1.0 : betai_inv (x + 1.0, n - x, 1.0 - alpha / 2.0);
+}
+
+/*!
+ * The estimate of one proportion, with its confidence interval.
+ */
+struct ProportionEstimate
+{
+    double p;
+    double lo;
+    double hi;
+    //! Half the width of the interval, relative to p
+    double relPrecision (void) const
+    {
+        return (this->p > 0.0) ? 0.5 * (this->hi - this->lo) / this->p : INFINITY;
+    }
+};
+
+class FitnessSampler
+{
+public:
+    FitnessSampler (unsigned int _nstrata = 1)
+        : precision(0.01)
+        , z(1.96)
+        , interval(CI_WILSON)
+        , batch(1 << 16)
+        , max_samples(400000000ULL)
+        , count_canalysing(false)
+        , nstrata(_nstrata)
+    {
+        if (this->nstrata < 1) {
+            throw runtime_error ("FitnessSampler: need at least one stratum");
+        }
+        this->setupStrata();
+        this->reset();
+    }
+
+    //! Zero the counts.
+    void reset (void)
+    {
+        this->n.assign (this->nstrata, 0);
+        this->nfit.assign (this->nstrata, 0);
+        this->nperfect.assign (this->nstrata, 0);
+        this->nfit_canal.assign (this->nstrata, 0);
+        this->nperfect_canal.assign (this->nstrata, 0);
+    }
+
+    /*!
+     * Sample genomes until the interval for P(F=1) (and for P(F>0)) is
+     * narrower than this->precision relative to its estimate, or until
+     * this->max_samples genomes have been evaluated. Uses the global
+     * rd to seed one RNG stream per thread. Returns true if the
+     * precision was reached. Throws runtime_error if a genome's
+     * fitness is outside [0,1].
+     */
+    bool run (void)
+    {
+#ifdef _OPENMP
+        unsigned int nthreads = omp_get_max_threads();
+#else
+        unsigned int nthreads = 1;
+#endif
+        vector<RngData> rds;
+        rngDataInitStreams (rds, nthreads);
+
+        while (this->samples() < this->max_samples) {
+
+            unsigned long long int this_batch = this->batch;
+            if (this_batch > this->max_samples - this->samples()) {
+                this_batch = this->max_samples - this->samples();
+            }
+            vector<unsigned int> strata;
+            this->allocate (this_batch, strata);
+            long long int nb = static_cast<long long int>(strata.size());
+
+            unsigned long long int ninvalid = 0;
+            double invalid_f = 0.0;
+
+#pragma omp parallel num_threads(nthreads)
+            {
+#ifdef _OPENMP
+                RngData* trd = &rds[omp_get_thread_num()];
+#else
+                RngData* trd = &rds[0];
+#endif
+                // Per-thread counters, merged at the end of the batch
+                vector<unsigned long long int> _n (this->nstrata, 0);
+                vector<unsigned long long int> _nfit (this->nstrata, 0);
+                vector<unsigned long long int> _nperfect (this->nstrata, 0);
+                vector<unsigned long long int> _fit_canal (this->nstrata, 0);
+                vector<unsigned long long int> _perfect_canal (this->nstrata, 0);
+                // The number of fitnesses outside [0,1], and the last of them
+                unsigned long long int _ninvalid = 0;
+                double _invalid_f = 0.0;
+                // The genomes are evaluated in blocks of Genome_Block_Len
+                array<genosect_t, N_Genes> genomes[Genome_Block_Len];
+                GenomeBlock<Genome_Block_Len> block;
+                double f[Genome_Block_Len];
+                // The fit genomes, which are tested for canalysingness all together
+                vector<array<genosect_t, N_Genes> > fit_genomes;
+                vector<unsigned int> fit_stratum;
+                vector<bool> fit_perfect;
+
+#pragma omp for schedule(static)
+                for (long long int i = 0; i < nb; i += Genome_Block_Len) {
+                    // The last block may be part filled; its unused lanes are evaluated but not counted
+                    unsigned int nl = (nb - i < Genome_Block_Len) ? (unsigned int)(nb - i) : Genome_Block_Len;
+                    for (unsigned int l = 0; l < nl; ++l) {
+                        this->sampleGenome (strata[i + l], genomes[l], trd);
+                        block.set (l, genomes[l]);
+                    }
+                    evaluate_fitness_batch (block, f);
+                    for (unsigned int l = 0; l < nl; ++l) {
+                        unsigned int h = strata[i + l];
+                        ++_n[h];
+                        if (!(f[l] >= 0.0 && f[l] <= 1.0)) {
+                            ++_ninvalid;
+                            _invalid_f = f[l];
+                        } else if (f[l] > 0.0) {
+                            ++_nfit[h];
+                            if (f[l] == 1.0) { ++_nperfect[h]; }
+                            if (this->count_canalysing) {
+                                fit_genomes.push_back (genomes[l]);
+                                fit_stratum.push_back (h);
+                                fit_perfect.push_back (f[l] == 1.0);
+                            }
+                        }
+                    }
+                }
+
+                vector<unsigned int> canal (fit_genomes.size());
+                canalyzingness_batch (fit_genomes.data(), canal.data(), fit_genomes.size());
+                for (size_t k = 0; k < fit_genomes.size(); ++k) {
+                    if (canal[k]) {
+                        ++_fit_canal[fit_stratum[k]];
+                        if (fit_perfect[k]) { ++_perfect_canal[fit_stratum[k]]; }
+                    }
+                }
+
+#pragma omp critical
+                {
+                    for (unsigned int h = 0; h < this->nstrata; ++h) {
+                        this->n[h] += _n[h];
+                        this->nfit[h] += _nfit[h];
+                        this->nperfect[h] += _nperfect[h];
+                        this->nfit_canal[h] += _fit_canal[h];
+                        this->nperfect_canal[h] += _perfect_canal[h];
+                    }
+                    if (_ninvalid > 0) {
+                        ninvalid += _ninvalid;
+                        invalid_f = _invalid_f;
+                    }
+                }
+            }
+
+            if (ninvalid > 0) {
+                stringstream ee;
+                ee << "FitnessSampler: " << ninvalid << " genome(s) had a fitness outside [0,1], e.g. "
+                   << (invalid_f > 1.0 ? "Fitness > 1.0?!? [" : "Fitness < 0.0?!? [") << invalid_f << "]";
+                throw runtime_error (ee.str());
+            }
+
+            ProportionEstimate ef = this->estimate (this->nfit);
+            ProportionEstimate ep = this->estimate (this->nperfect);
+            DBG (this->samples() << " samples: P(F>0)=" << ef.p << " [" << ef.lo << "," << ef.hi << "] P(F=1)="
+                 << ep.p << " [" << ep.lo << "," << ep.hi << "]");
+            if (ef.relPrecision() <= this->precision && ep.relPrecision() <= this->precision) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    //! The estimate of P(F>0)
+    ProportionEstimate fit (void) const { return this->estimate (this->nfit); }
+    //! The estimate of P(F=1)
+    ProportionEstimate perfect (void) const { return this->estimate (this->nperfect); }
+    //! The estimate of P(F>0 and canalysing), if count_canalysing was set
+    ProportionEstimate fitCanalysing (void) const { return this->estimate (this->nfit_canal); }
+    //! The estimate of P(F=1 and canalysing), if count_canalysing was set
+    ProportionEstimate perfectCanalysing (void) const { return this->estimate (this->nperfect_canal); }
+
+    /*!
+     * True if the samples are stratified. The strata are then sampled
+     * at different rates, so the raw counts below are not in
+     * proportion to the population; use the estimates above.
+     */
+    bool stratified (void) const { return this->nstrata > 1; }
+
+    //@{ Total (unweighted) counts over the strata
+    unsigned long long int samples (void) const { return this->total (this->n); }
+    unsigned long long int numfit (void) const { return this->total (this->nfit); }
+    unsigned long long int numperfect (void) const { return this->total (this->nperfect); }
+    unsigned long long int numfit_and_canalysing (void) const { return this->total (this->nfit_canal); }
+    unsigned long long int numperfect_and_canalysing (void) const { return this->total (this->nperfect_canal); }
+    //@}
+
+    //! The target half width of the intervals, relative to the estimates
+    double precision;
+    //! The normal quantile for the confidence of the intervals
+    double z;
+    //! CI_WILSON or CI_CLOPPER_PEARSON
+    int interval;
+    //! The number of genomes in each batch
+    unsigned long long int batch;
+    //! Stop after this many samples, whether or not the precision has been reached
+    unsigned long long int max_samples;
+    //! If true, also count the fit and perfect genomes which are canalysing in at least one genosect
+    bool count_canalysing;
+
+private:
+    /*!
+     * Split the range of the number of set bits, 0 to l_genome, into
+     * nstrata strata of roughly equal probability.
+     */
+    void setupStrata (void)
+    {
+        unsigned int l_genome = N_Genes * (1 << N_Ins);
+        // The binomial probability of each number of set bits
+        this->pbits.resize (l_genome + 1);
+        for (unsigned int k = 0; k <= l_genome; ++k) {
+            this->pbits[k] = exp (lgamma(l_genome + 1.0) - lgamma(k + 1.0) - lgamma(l_genome - k + 1.0)
+                                  - l_genome * log(2.0));
+        }
+        if (this->nstrata > l_genome + 1) {
+            this->nstrata = l_genome + 1;
+        }
+        this->first.assign (this->nstrata + 1, l_genome + 1);
+        this->weight.assign (this->nstrata, 0.0);
+        this->first[0] = 0;
+        double cum = 0.0;
+        unsigned int h = 0;
+        for (unsigned int k = 0; k <= l_genome; ++k) {
+            // Start the next stratum if this one has its share, leaving enough bits for the rest
+            if (h + 1 < this->nstrata && k > this->first[h]
+                && (cum >= (double)(h + 1) / this->nstrata || l_genome + 1 - k <= this->nstrata - 1 - h)) {
+                ++h;
+                this->first[h] = k;
+            }
+            cum += this->pbits[k];
+            this->weight[h] += this->pbits[k];
+        }
+    }
+
+    /*!
+     * Choose the stratum of each genome in the next batch. The first
+     * batch is allocated in proportion to the stratum weights; later
+     * ones by Neyman allocation for P(F=1), with every stratum getting
+     * some samples. The allocation is rounded to whole samples by
+     * largest remainders, so that rounding (and the minimum of one
+     * sample for a stratum not yet sampled) is taken from or given to
+     * the strata whose rounded allocations are furthest from their
+     * shares. The batch is larger than nb only if nb is smaller than
+     * the number of strata not yet sampled.
+     */
+    void allocate (unsigned long long int nb, vector<unsigned int>& strata)
+    {
+        vector<double> share (this->nstrata, 0.0);
+        double total = 0.0;
+        for (unsigned int h = 0; h < this->nstrata; ++h) {
+            if (this->n[h] == 0) {
+                share[h] = this->weight[h];
+            } else {
+                double q = (this->nperfect[h] + 0.5) / (this->n[h] + 1.0);
+                share[h] = this->weight[h] * sqrt (q * (1.0 - q));
+            }
+            total += share[h];
+        }
+        unsigned long long int floor_n = (this->nstrata > 1) ? nb / (20 * this->nstrata) : 0;
+        vector<double> ideal (this->nstrata, 0.0);
+        vector<unsigned long long int> nh (this->nstrata, 0);
+        vector<unsigned long long int> min_nh (this->nstrata, 0);
+        unsigned long long int sum = 0;
+        for (unsigned int h = 0; h < this->nstrata; ++h) {
+            ideal[h] = floor_n + (double)(nb - floor_n * this->nstrata) * share[h] / total;
+            nh[h] = static_cast<unsigned long long int>(ideal[h]);
+            min_nh[h] = (this->n[h] == 0) ? 1 : 0;
+            if (nh[h] < min_nh[h]) { nh[h] = min_nh[h]; }
+            sum += nh[h];
+        }
+        // Too many (because of the minimum): take from the strata most over their shares
+        while (sum > nb) {
+            unsigned int hmax = this->nstrata;
+            for (unsigned int h = 0; h < this->nstrata; ++h) {
+                if (nh[h] > min_nh[h] && (hmax == this->nstrata || nh[h] - ideal[h] > nh[hmax] - ideal[hmax])) {
+                    hmax = h;
+                }
+            }
+            if (hmax == this->nstrata) { break; }
+            --nh[hmax];
+            --sum;
+        }
+        // Too few (because of truncation): give to the strata most under their shares
+        while (sum < nb) {
+            unsigned int hmax = 0;
+            for (unsigned int h = 1; h < this->nstrata; ++h) {
+                if (ideal[h] - nh[h] > ideal[hmax] - nh[hmax]) { hmax = h; }
+            }
+            ++nh[hmax];
+            ++sum;
+        }
+        strata.clear();
+        strata.reserve (sum);
+        for (unsigned int h = 0; h < this->nstrata; ++h) {
+            strata.insert (strata.end(), nh[h], h);
+        }
+    }
+
+    //! Draw a genome from stratum h
+    void sampleGenome (unsigned int h, array<genosect_t, N_Genes>& genome, RngData* trd) const
+    {
+        if (this->nstrata == 1) {
+            random_genome (genome, trd);
+            return;
+        }
+        // Choose the number of set bits from the stratum, then the bits.
+        double u = randDouble (trd) * this->weight[h];
+        unsigned int k = this->first[h];
+        while (k + 1 < this->first[h + 1] && u >= this->pbits[k]) {
+            u -= this->pbits[k];
+            ++k;
+        }
+        random_flip_mask (genome, k, trd);
+    }
+
+    /*!
+     * The stratified estimate of a proportion, given the number of
+     * successes in each stratum. The interval is computed from an
+     * effective sample size, which is the number of samples for an
+     * unstratified estimate of the same variance, but no more than the
+     * number of samples actually taken.
+     */
+    ProportionEstimate estimate (const vector<unsigned long long int>& x) const
+    {
+        ProportionEstimate e;
+        e.p = 0.0;
+        double var = 0.0;
+        unsigned long long int ntot = 0;
+        for (unsigned int h = 0; h < this->nstrata; ++h) {
+            ntot += this->n[h];
+            if (this->n[h] == 0) { continue; }
+            double ph = (double)x[h] / (double)this->n[h];
+            e.p += this->weight[h] * ph;
+            // A stratum with no successes (or all) would add no variance, which overstates the
+            // precision of a rare proportion, so the variance uses a continuity corrected ph.
+            double qh = ((double)x[h] + 0.5) / ((double)this->n[h] + 1.0);
+            var += this->weight[h] * this->weight[h] * qh * (1.0 - qh) / (double)this->n[h];
+        }
+        double neff = (var > 0.0) ? e.p * (1.0 - e.p) / var : (double)ntot;
+        if (neff > (double)ntot) { neff = (double)ntot; }
+        if (this->interval == CI_CLOPPER_PEARSON) {
+            clopper_pearson_interval (e.p * neff, neff, this->z, e.lo, e.hi);
+        } else {
+            wilson_interval (e.p * neff, neff, this->z, e.lo, e.hi);
+        }
+        return e;
+    }
+
+    unsigned long long int total (const vector<unsigned long long int>& v) const
+    {
+        unsigned long long int t = 0;
+        for (unsigned int h = 0; h < v.size(); ++h) { t += v[h]; }
+        return t;
+    }
+
+    //! The number of strata
+    unsigned int nstrata;
+    //! Probability of each number of set bits in a random genome
+    vector<double> pbits;
+    //! first[h] is the lowest number of set bits in stratum h; first[nstrata] is one past the last
+    vector<unsigned int> first;
+    //! The probability mass of each stratum
+    vector<double> weight;
+    //@{ Per-stratum counts of samples, F>0 and F=1 genomes, and of those which are canalysing
+    vector<unsigned long long int> n;
+    vector<unsigned long long int> nfit;
+    vector<unsigned long long int> nperfect;
+    vector<unsigned long long int> nfit_canal;
+    vector<unsigned long long int> nperfect_canal;
+    //@}
+};
+
+SIM_NAMESPACE_END
+
+#endif // __SAMPLER_H__
@@ -0,0 +1,23 @@
+/*!
+ * SIM_NAMESPACE_BEGIN and SIM_NAMESPACE_END enclose everything that the
+ * headers in sim/include (other than dispatch.h) declare. They open and close the namespace
+ * SIM_NAMESPACE, if that is defined, and are empty otherwise.
+ *
+ * A program compiled once for each network size (see dispatch.h) is
+ * compiled with a different SIM_NAMESPACE each time, so that every
+ * compilation has its own genosect_t, masks, RNG and fitness function,
+ * and they can all be linked into one binary.
+ */
+
+#ifndef __SIM_NAMESPACE_H__
+#define __SIM_NAMESPACE_H__
+
+#ifdef SIM_NAMESPACE
+# define SIM_NAMESPACE_BEGIN namespace SIM_NAMESPACE {
+# define SIM_NAMESPACE_END }
+#else
+# define SIM_NAMESPACE_BEGIN
+# define SIM_NAMESPACE_END
+#endif
+
+#endif // __SIM_NAMESPACE_H__
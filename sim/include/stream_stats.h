@@ -0,0 +1,412 @@
+/*!
+ * Streaming summaries of large numbers of values (fitnesses, hitting
+ * times), for the programs which sample millions of genomes. Rather
+ * than writing every value out for python to bin, values are added to
+ * a summary as they're found and the summary is written out at the end,
+ * as JSON.
+ *
+ * StreamStats holds exact counts of the values 0 and 1, the count, sum,
+ * min and max, a LogHistogram and a QuantileSketch. KeyedHistogram
+ * holds a linear histogram of fitness for each of a number of integer
+ * keys (number of basins etc). All of them can be merged, so that each
+ * thread can fill its own shard which are all merged at the end.
+ */
+
+#ifndef __STREAM_STATS_H__
+#define __STREAM_STATS_H__
+
+#include <vector>
+#include <string>
+#include <ostream>
+#include <stdexcept>
+#include <limits>
+#include <math.h>
+#include "sim_namespace.h"
+
+using namespace std;
+
+SIM_NAMESPACE_BEGIN
+
+//! The default lowest decade of a LogHistogram; fitness goes down to about 1e-10
+#define Stats_Log_Min_Decade (-10)
+
+//! The default number of bins per decade of a LogHistogram
+#define Stats_Bins_Per_Decade 10
+
+//! The default relative accuracy of a QuantileSketch
+#define Stats_Sketch_Accuracy 0.01
+
+//! The number of linear fitness bins in a KeyedHistogram
+#define Stats_Linear_Bins 100
+
+//! Write v to os as a JSON array
+template <typename T>
+void
+stats_write_array (ostream& os, const vector<T>& v)
+{
+    os << "[";
+    for (size_t i = 0; i < v.size(); ++i) {
+        os << (i ? "," : "") << v[i];
+    }
+    os << "]";
+}
+
+/*!
+ * A histogram with bins_per_decade logarithmically spaced bins per
+ * decade, from 10^min_decade up to 10^max_decade. Values out of range
+ * are counted (zero or negative, under and over) but not binned.
+ */
+class LogHistogram
+{
+public:
+    LogHistogram (int _min_decade = Stats_Log_Min_Decade, int _max_decade = 0,
+                  unsigned int _bins_per_decade = Stats_Bins_Per_Decade)
+        : min_decade(_min_decade)
+        , max_decade(_max_decade)
+        , bins_per_decade(_bins_per_decade)
+        , counts((_max_decade - _min_decade) * _bins_per_decade, 0)
+        , n_nonpositive(0)
+        , n_under(0)
+        , n_over(0)
+        , lo(pow (10.0, _min_decade))
+        , hi(pow (10.0, _max_decade))
+    {
+        if (_max_decade <= _min_decade || _bins_per_decade == 0) {
+            throw runtime_error ("LogHistogram: empty range");
+        }
+    }
+
+    void add (double x, unsigned long long int count = 1)
+    {
+        if (x <= 0.0) {
+            this->n_nonpositive += count;
+        } else if (x < this->lo) {
+            this->n_under += count;
+        } else if (x >= this->hi) {
+            this->n_over += count;
+        } else {
+            long long int b = (long long int)floor ((log10 (x) - this->min_decade) * this->bins_per_decade);
+            // Guard against rounding at the bin edges
+            if (b < 0) { b = 0; }
+            if (b >= (long long int)this->counts.size()) { b = this->counts.size() - 1; }
+            this->counts[b] += count;
+        }
+    }
+
+    void merge (const LogHistogram& other)
+    {
+        if (other.min_decade != this->min_decade || other.max_decade != this->max_decade
+            || other.bins_per_decade != this->bins_per_decade) {
+            throw runtime_error ("LogHistogram: can't merge histograms with different bins");
+        }
+        for (size_t i = 0; i < this->counts.size(); ++i) {
+            this->counts[i] += other.counts[i];
+        }
+        this->n_nonpositive += other.n_nonpositive;
+        this->n_under += other.n_under;
+        this->n_over += other.n_over;
+    }
+
+    //! The lower edge of bin i
+    double edge (size_t i) const
+    {
+        return pow (10.0, this->min_decade + (double)i / this->bins_per_decade);
+    }
+
+    void write_json (ostream& os) const
+    {
+        vector<double> edges;
+        for (size_t i = 0; i <= this->counts.size(); ++i) {
+            edges.push_back (this->edge (i));
+        }
+        os << "{\"min_decade\":" << this->min_decade
+           << ",\"max_decade\":" << this->max_decade
+           << ",\"bins_per_decade\":" << this->bins_per_decade
+           << ",\"n_nonpositive\":" << this->n_nonpositive
+           << ",\"n_under\":" << this->n_under
+           << ",\"n_over\":" << this->n_over
+           << ",\"edges\":";
+        stats_write_array (os, edges);
+        os << ",\"counts\":";
+        stats_write_array (os, this->counts);
+        os << "}";
+    }
+
+    int min_decade;
+    int max_decade;
+    unsigned int bins_per_decade;
+    vector<unsigned long long int> counts;
+    unsigned long long int n_nonpositive;
+    unsigned long long int n_under;
+    unsigned long long int n_over;
+
+private:
+    double lo;
+    double hi;
+};
+
+/*!
+ * A mergeable quantile sketch for non-negative values, after the
+ * DDSketch of Masson, Rim & Lee (2019). Positive values go into
+ * logarithmic buckets, bucket i holding (gamma^(i-1), gamma^i] with
+ * gamma = (1+accuracy)/(1-accuracy), so that any quantile is returned
+ * with a relative error of at most accuracy, however far the values
+ * range. Two sketches with the same accuracy merge exactly.
+ */
+class QuantileSketch
+{
+public:
+    QuantileSketch (double _accuracy = Stats_Sketch_Accuracy)
+        : accuracy(_accuracy)
+        , gamma((1.0 + _accuracy) / (1.0 - _accuracy))
+        , lngamma(log ((1.0 + _accuracy) / (1.0 - _accuracy)))
+        , offset(0)
+        , n(0)
+        , n_zero(0)
+    {
+        if (_accuracy <= 0.0 || _accuracy >= 1.0) {
+            throw runtime_error ("QuantileSketch: accuracy should be in (0,1)");
+        }
+    }
+
+    void add (double x, unsigned long long int count = 1)
+    {
+        this->n += count;
+        if (x <= 0.0) {
+            this->n_zero += count;
+            return;
+        }
+        this->bucket ((int)ceil (log (x) / this->lngamma)) += count;
+    }
+
+    void merge (const QuantileSketch& other)
+    {
+        if (other.accuracy != this->accuracy) {
+            throw runtime_error ("QuantileSketch: can't merge sketches of different accuracy");
+        }
+        this->n += other.n;
+        this->n_zero += other.n_zero;
+        for (size_t j = 0; j < other.buckets.size(); ++j) {
+            if (other.buckets[j]) {
+                this->bucket (other.offset + (int)j) += other.buckets[j];
+            }
+        }
+    }
+
+    //! The q quantile (q in [0,1]), within the relative accuracy. 0 if empty.
+    double quantile (double q) const
+    {
+        if (this->n == 0) {
+            return 0.0;
+        }
+        if (q < 0.0) { q = 0.0; }
+        if (q > 1.0) { q = 1.0; }
+        unsigned long long int rank = (unsigned long long int)floor (q * (double)(this->n - 1));
+        if (rank < this->n_zero) {
+            return 0.0;
+        }
+        unsigned long long int cum = this->n_zero;
+        for (size_t j = 0; j < this->buckets.size(); ++j) {
+            cum += this->buckets[j];
+            if (cum > rank) {
+                return this->value (this->offset + (int)j);
+            }
+        }
+        return this->value (this->offset + (int)this->buckets.size() - 1);
+    }
+
+    //! The representative value of bucket i
+    double value (int i) const
+    {
+        return 2.0 * pow (this->gamma, i) / (this->gamma + 1.0);
+    }
+
+    /*!
+     * Write the sketch, and the quantiles at qs, as JSON. The buckets
+     * are enough to recompute any quantile.
+     */
+    void write_json (ostream& os, const vector<double>& qs) const
+    {
+        vector<double> qv;
+        for (double q : qs) {
+            qv.push_back (this->quantile (q));
+        }
+        os << "{\"accuracy\":" << this->accuracy
+           << ",\"gamma\":" << this->gamma
+           << ",\"n\":" << this->n
+           << ",\"n_zero\":" << this->n_zero
+           << ",\"offset\":" << this->offset
+           << ",\"buckets\":";
+        stats_write_array (os, this->buckets);
+        os << ",\"q\":";
+        stats_write_array (os, qs);
+        os << ",\"quantiles\":";
+        stats_write_array (os, qv);
+        os << "}";
+    }
+
+    double accuracy;
+    double gamma;
+    double lngamma;
+    //! The index of buckets[0]
+    int offset;
+    vector<unsigned long long int> buckets;
+    unsigned long long int n;
+    unsigned long long int n_zero;
+
+private:
+    //! Bucket i, growing the bucket vector to hold it if necessary
+    unsigned long long int& bucket (int i)
+    {
+        if (this->buckets.empty()) {
+            this->offset = i;
+            this->buckets.push_back (0);
+        } else if (i < this->offset) {
+            this->buckets.insert (this->buckets.begin(), this->offset - i, 0);
+            this->offset = i;
+        } else if (i >= this->offset + (int)this->buckets.size()) {
+            this->buckets.resize (i - this->offset + 1, 0);
+        }
+        return this->buckets[i - this->offset];
+    }
+};
+
+/*!
+ * The summary of a stream of non-negative values: exact counts of
+ * those equal to 0 and 1, count, sum, min and max, a LogHistogram and a
+ * QuantileSketch.
+ */
+class StreamStats
+{
+public:
+    StreamStats (int min_decade = Stats_Log_Min_Decade, int max_decade = 0)
+        : n(0)
+        , n_zero(0)
+        , n_one(0)
+        , sum(0.0)
+        , sumsq(0.0)
+        , min(numeric_limits<double>::infinity())
+        , max(-numeric_limits<double>::infinity())
+        , hist(min_decade, max_decade)
+    {}
+
+    void add (double x)
+    {
+        ++this->n;
+        if (x == 0.0) { ++this->n_zero; }
+        if (x == 1.0) { ++this->n_one; }
+        this->sum += x;
+        this->sumsq += (long double)x * x;
+        if (x < this->min) { this->min = x; }
+        if (x > this->max) { this->max = x; }
+        this->hist.add (x);
+        this->sketch.add (x);
+    }
+
+    void merge (const StreamStats& other)
+    {
+        this->n += other.n;
+        this->n_zero += other.n_zero;
+        this->n_one += other.n_one;
+        this->sum += other.sum;
+        this->sumsq += other.sumsq;
+        if (other.min < this->min) { this->min = other.min; }
+        if (other.max > this->max) { this->max = other.max; }
+        this->hist.merge (other.hist);
+        this->sketch.merge (other.sketch);
+    }
+
+    double mean (void) const
+    {
+        return this->n ? (double)(this->sum / this->n) : 0.0;
+    }
+
+    double sd (void) const
+    {
+        if (this->n < 2) { return 0.0; }
+        long double m = this->sum / this->n;
+        long double var = (this->sumsq - this->n * m * m) / (this->n - 1);
+        return var > 0.0 ? (double)sqrtl (var) : 0.0;
+    }
+
+    void write_json (ostream& os) const
+    {
+        static const double qa[] = { 0.001, 0.01, 0.05, 0.1, 0.25, 0.5, 0.75, 0.9, 0.95, 0.99, 0.999 };
+        vector<double> qs (qa, qa + sizeof(qa)/sizeof(qa[0]));
+        os << "{\"n\":" << this->n
+           << ",\"n_zero\":" << this->n_zero
+           << ",\"n_one\":" << this->n_one
+           << ",\"mean\":" << this->mean()
+           << ",\"sd\":" << this->sd()
+           << ",\"min\":" << (this->n ? this->min : 0.0)
+           << ",\"max\":" << (this->n ? this->max : 0.0)
+           << ",\"log_histogram\":";
+        this->hist.write_json (os);
+        os << ",\"sketch\":";
+        this->sketch.write_json (os, qs);
+        os << "}";
+    }
+
+    unsigned long long int n;
+    unsigned long long int n_zero;
+    unsigned long long int n_one;
+    long double sum;
+    long double sumsq;
+    double min;
+    double max;
+    LogHistogram hist;
+    QuantileSketch sketch;
+};
+
+/*!
+ * For each integer key 0 to nkeys-1, a histogram of Stats_Linear_Bins
+ * equal bins of fitness from 0 to 1 (1 goes in the last bin). Keys
+ * beyond the last are counted in the last.
+ */
+class KeyedHistogram
+{
+public:
+    KeyedHistogram (unsigned int _nkeys)
+        : nkeys(_nkeys)
+        , counts(_nkeys, vector<unsigned long long int>(Stats_Linear_Bins, 0))
+    {}
+
+    void add (unsigned int key, double f)
+    {
+        if (key >= this->nkeys) { key = this->nkeys - 1; }
+        int b = (int)(f * Stats_Linear_Bins);
+        if (b < 0) { b = 0; }
+        if (b >= Stats_Linear_Bins) { b = Stats_Linear_Bins - 1; }
+        ++this->counts[key][b];
+    }
+
+    void merge (const KeyedHistogram& other)
+    {
+        if (other.nkeys != this->nkeys) {
+            throw runtime_error ("KeyedHistogram: can't merge histograms with different keys");
+        }
+        for (unsigned int k = 0; k < this->nkeys; ++k) {
+            for (unsigned int b = 0; b < Stats_Linear_Bins; ++b) {
+                this->counts[k][b] += other.counts[k][b];
+            }
+        }
+    }
+
+    //! Written as an array of nkeys rows of counts
+    void write_json (ostream& os) const
+    {
+        os << "[";
+        for (unsigned int k = 0; k < this->nkeys; ++k) {
+            os << (k ? ",\n  " : "");
+            stats_write_array (os, this->counts[k]);
+        }
+        os << "]";
+    }
+
+    unsigned int nkeys;
+    vector<vector<unsigned long long int> > counts;
+};
+
+SIM_NAMESPACE_END
+
+#endif // __STREAM_STATS_H__
@@ -0,0 +1,151 @@
+/*!
+ * A genosect wider than 64 bits, for networks in which a gene has more
+ * than 6 inputs (N_Genes=7 with k=n, N_Genes=8). The truth table is
+ * held in W 64 bit words, least significant word first, and the class
+ * has the operators of an unsigned integer, so that code written for
+ * the integer genosect_t compiles unchanged. The word-wise loops are
+ * short enough to be unrolled and vectorised (W=4 is one AVX2
+ * register).
+ *
+ * The hot paths (compute_next(), evolve_genome(), compute_hamming())
+ * use the genosect_bit(), genosect_flip() and genosect_popcount()
+ * functions in lib.h, which test or flip one bit in one word, rather
+ * than shifting a whole WideGenosect.
+ *
+ * Included by lib.h.
+ */
+
+#ifndef __WIDE_GENOSECT_H__
+#define __WIDE_GENOSECT_H__
+
+#include <iostream>
+#include <immintrin.h>
+#include "sim_namespace.h"
+
+using namespace std;
+
+SIM_NAMESPACE_BEGIN
+
+template <unsigned int W>
+struct WideGenosect
+{
+    //! The words, least significant first
+    unsigned long long int w[W];
+
+    //! Uninitialised, like an integer genosect_t
+    WideGenosect() = default;
+
+    //! The value v, in the lowest word
+    WideGenosect (unsigned long long int v)
+    {
+        this->w[0] = v;
+        for (unsigned int k = 1; k < W; ++k) { this->w[k] = 0ULL; }
+    }
+
+    explicit operator bool() const
+    {
+        unsigned long long int any = 0ULL;
+        for (unsigned int k = 0; k < W; ++k) { any |= this->w[k]; }
+        return any != 0ULL;
+    }
+
+    WideGenosect& operator&= (const WideGenosect& o)
+    {
+#pragma omp simd
+        for (unsigned int k = 0; k < W; ++k) { this->w[k] &= o.w[k]; }
+        return *this;
+    }
+    WideGenosect& operator|= (const WideGenosect& o)
+    {
+#pragma omp simd
+        for (unsigned int k = 0; k < W; ++k) { this->w[k] |= o.w[k]; }
+        return *this;
+    }
+    WideGenosect& operator^= (const WideGenosect& o)
+    {
+#pragma omp simd
+        for (unsigned int k = 0; k < W; ++k) { this->w[k] ^= o.w[k]; }
+        return *this;
+    }
+
+    WideGenosect& operator<<= (unsigned int n)
+    {
+        const unsigned int q = n / 64;
+        const unsigned int r = n % 64;
+        for (int k = W - 1; k >= 0; --k) {
+            unsigned long long int v = 0ULL;
+            if (k >= (int)q) {
+                v = this->w[k - q] << r;
+                if (r && k > (int)q) { v |= this->w[k - q - 1] >> (64 - r); }
+            }
+            this->w[k] = v;
+        }
+        return *this;
+    }
+    WideGenosect& operator>>= (unsigned int n)
+    {
+        const unsigned int q = n / 64;
+        const unsigned int r = n % 64;
+        for (unsigned int k = 0; k < W; ++k) {
+            unsigned long long int v = 0ULL;
+            if (k + q < W) {
+                v = this->w[k + q] >> r;
+                if (r && k + q + 1 < W) { v |= this->w[k + q + 1] << (64 - r); }
+            }
+            this->w[k] = v;
+        }
+        return *this;
+    }
+
+    // Friends, so that an integer on either side is converted
+    friend WideGenosect operator& (WideGenosect a, const WideGenosect& b) { return a &= b; }
+    friend WideGenosect operator| (WideGenosect a, const WideGenosect& b) { return a |= b; }
+    friend WideGenosect operator^ (WideGenosect a, const WideGenosect& b) { return a ^= b; }
+    friend WideGenosect operator<< (WideGenosect a, unsigned int n) { return a <<= n; }
+    friend WideGenosect operator>> (WideGenosect a, unsigned int n) { return a >>= n; }
+
+    friend WideGenosect operator~ (WideGenosect a)
+    {
+#pragma omp simd
+        for (unsigned int k = 0; k < W; ++k) { a.w[k] = ~a.w[k]; }
+        return a;
+    }
+
+    friend bool operator== (const WideGenosect& a, const WideGenosect& b)
+    {
+        unsigned long long int diff = 0ULL;
+        for (unsigned int k = 0; k < W; ++k) { diff |= a.w[k] ^ b.w[k]; }
+        return diff == 0ULL;
+    }
+    friend bool operator!= (const WideGenosect& a, const WideGenosect& b) { return !(a == b); }
+
+    //! Ordered as the integers they represent
+    friend bool operator< (const WideGenosect& a, const WideGenosect& b)
+    {
+        for (int k = W - 1; k >= 0; --k) {
+            if (a.w[k] != b.w[k]) { return a.w[k] < b.w[k]; }
+        }
+        return false;
+    }
+
+    //! Always written in hex, without leading zeros (as the integer genosects are, after << hex)
+    friend ostream& operator<< (ostream& os, const WideGenosect& a)
+    {
+        static const char hexdigits[] = "0123456789abcdef";
+        char buf[W * 16 + 1];
+        char* p = buf;
+        bool lead = true;
+        for (int d = W * 16 - 1; d >= 0; --d) {
+            unsigned int v = (a.w[d / 16] >> (4 * (d % 16))) & 0xf;
+            if (lead && v == 0 && d > 0) { continue; }
+            lead = false;
+            *p++ = hexdigits[v];
+        }
+        *p = '\0';
+        return os << buf;
+    }
+};
+
+SIM_NAMESPACE_END
+
+#endif // __WIDE_GENOSECT_H__
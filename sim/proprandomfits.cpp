@@ -2,12 +2,25 @@
  * Find the proportion of fit genomes by randomly sampling the genome
  * space.
  *
- * This defaults the N_Genes=5, but N_Genes can be defined on the
- * compiler command line to find the results for other values.
+ * This is compiled once for each of N_Genes = 3 to 6, and the
+ * compilation is chosen with the -n option (see dispatch.cpp).
  *
  * This code will do an exhaustive search if appropriate. In practice
  * this is possible for N_Genes==3 and k=n and N_Genes==4 and k=n-1
- * only (the latter requiring about 30 minutes of compute time).
+ * only (the latter requiring about 30 minutes of single threaded
+ * compute time). The exhaustive search is carried out in parallel by
+ * GenomeSpaceEnumerator (enumerate.h).
+ *
+ * Usage: proprandom [-n N] [ntrials [checkpointfile [precision [nstrata]]]]
+ *
+ * ntrials is the largest number of genomes for which an exhaustive
+ * search is made; otherwise up to ntrials random genomes are sampled
+ * (see FitnessSampler in sampler.h), stopping once the 95% intervals
+ * of the proportions are within precision (default 0.01) of the
+ * estimates. nstrata sets the number of strata (by genome bias) for
+ * the sampling. If checkpointfile is given (and is not "-"), the
+ * progress of an exhaustive search is saved to it, and a search is
+ * resumed from it if it exists.
  *
  * Author: S James
  * Date: October 2018.
@@ -39,33 +52,21 @@ using namespace std;
 
 // Common code
 #include "lib.h"
+#include "functables.h"
 
 // The fitness function used here
 #include "fitness.h"
 
+#include "enumerate.h"
+#include "sampler.h"
+
 #include "lmp.h"
 
 #include <climits>
 
-// Define a macro for evaluating the fitness to avoid writing it out twice
-#define EVALUATE_FITNESS(genome_) {                                     \
-        double f = evaluate_fitness (genome_);                          \
-        unsigned int c = canalyzingness (genome_);                      \
-        if (f > 0.0) {                                                  \
-            ++numfit;                                                   \
-            if (c) { ++numfit_and_canalysing; }                         \
-            if (f == 1.0) {                                             \
-                ++numperfect;                                           \
-                if (c) { ++numperfect_and_canalysing; }                 \
-            }                                                           \
-        }                                                               \
-        if (g%1000000 == 0) {                                           \
-            cout << g << "," << numfit << "," << numperfect << endl;    \
-        }                                                               \
-        ++g;                                                            \
-    }
+SIM_NAMESPACE_BEGIN
 
-int main (int argc, char** argv)
+int sim_main (int argc, char** argv)
 {
     // Seed the RNG.
     unsigned int seed = mix(clock(), time(NULL), getpid());
@@ -78,6 +79,9 @@ int main (int argc, char** argv)
     // Initialise masks
     masks_init();
 
+    // Tabulated canalysingness of each genosect, for canalyzingness()
+    functables.init (FunctionTables::defaultPath());
+
     // Unused, but set, in this program.
     pOn = 0.5;
 
@@ -107,70 +111,90 @@ int main (int argc, char** argv)
 
     LOG ("2^N = " << nexhaustive_xint << " or " << nexhaustive << " (cf " << ULLONG_MAX << ")");
 
-    // Could be set on cmd line. This many takes 30 mins for n=4 and
-    //ensures I can do an exhaustive search for n=4 and k=n=1
-    //unsigned long long int ntrials = 4294967296;
-
-    // This is about 3 minutes worth of computation:
+    // This is about 3 minutes worth of computation. Can be set on cmd
+    // line; 4294967296 ensures an exhaustive search for n=4 and k=n-1.
     unsigned long long int ntrials = 400000000;
+    if (argc > 1) {
+        ntrials = strtoull (argv[1], NULL, 10);
+    }
+    // An optional checkpoint file for the exhaustive search
+    string checkpoint("");
+    if (argc > 2) {
+        checkpoint = string(argv[2]);
+        if (checkpoint == "-") { checkpoint = ""; }
+    }
+    // For a sampling search, the relative precision at which to stop and the number of strata
+    double precision = 0.01;
+    if (argc > 3) {
+        precision = atof (argv[3]);
+    }
+    unsigned int nstrata = 1;
+    if (argc > 4) {
+        nstrata = atoi (argv[4]);
+    }
 
-    if (nexhaustive != ULLONG_MAX && nexhaustive <= ntrials) {
+    // The proportions of fit and perfect genomes
+    double pfit = 0.0;
+    double pperfect = 0.0;
+
+    if (N < 64 && nexhaustive <= ntrials) {
         LOG ("Doing an exhaustive search...");
         ntrials = nexhaustive;
-        // Create genome, initialise to 0:
-        array<genosect_t, N_Genes> genome;
-        zero_genome (genome);
-        // A counter for the number of trials; should end up equal to ntrials:
-        unsigned long long int g = 0;
-        // Number of permutations in a genome section:
-        unsigned long long int genome_sect_perms = (0x1ULL << (0x1UL<<N_Ins));
-#if N_Genes == 3
-        for (unsigned long long int g1 = 0; g1 < genome_sect_perms; ++g1) {
-            for (unsigned long long int g2 = 0; g2 < genome_sect_perms; ++g2) {
-                for (unsigned long long int g3 = 0; g3 < genome_sect_perms; ++g3) {
-                    //DBG2 ("Evaluate genome " << genome_id(genome));
-                    EVALUATE_FITNESS(genome);
-                    genome[2]++;
-                }
-                genome[2] = 0;
-                genome[1]++;
-            }
-            genome[2] = 0;
-            genome[1] = 0;
-            genome[0]++;
-        }
-#elif N_Genes == 4 // Running the program for N_Genes==4 will only be tractable for the n=k-1 case.
-        for (unsigned long long int g1 = 0; g1 < genome_sect_perms; ++g1) {
-            for (unsigned long long int g2 = 0; g2 < genome_sect_perms; ++g2) {
-                for (unsigned long long int g3 = 0; g3 < genome_sect_perms; ++g3) {
-                    for (unsigned long long int g4 = 0; g4 < genome_sect_perms; ++g4) {
-                        EVALUATE_FITNESS(genome);
-                        genome[3]++;
-                    }
-                    genome[3] = 0;
-                    genome[2]++;
-                }
-                genome[3] = 0;
-                genome[2] = 0;
-                genome[1]++;
+        GenomeSpaceEnumerator gse;
+        try {
+            if (!checkpoint.empty() && gse.loadCheckpoint (checkpoint)) {
+                LOG ("Resuming from genome " << gse.next << " using checkpoint " << checkpoint);
             }
-            genome[3] = 0;
-            genome[2] = 0;
-            genome[1] = 0;
-            genome[0]++;
+        } catch (const exception& e) {
+            // Start again, leaving the checkpoint file (which may be another search's) untouched
+            LOG (e.what() << "; starting from genome 0 without checkpointing");
+            checkpoint = "";
         }
-#else
-        LOG ("Uh oh; I only have code for computing an exhaustive search for N_Genes == 3 or N_Genes==4.");
-#endif
-        LOG ("At end g was " << g << ". Each loop was of length " << genome_sect_perms);
+        gse.run (checkpoint);
+        numfit = gse.numfit;
+        numfit_and_canalysing = gse.numfit_and_canalysing;
+        numperfect = gse.numperfect;
+        numperfect_and_canalysing = gse.numperfect_and_canalysing;
+        LOG ("At end, evaluated " << gse.next << " genomes in chunks of " << gse.chunk_len);
+        pfit = (double)numfit / ntrials;
+        pperfect = (double)numperfect / ntrials;
 
     } else {
         LOG ("Doing sampling search...");
-        for (unsigned long long int g = 0; g < ntrials; ) {
-            array<genosect_t, N_Genes> genome = random_genome();
-            // Note: g increments in EVALUATE_FITNESS():
-            EVALUATE_FITNESS(genome);
+        FitnessSampler fs (nstrata);
+        fs.precision = precision;
+        fs.max_samples = ntrials;
+        fs.count_canalysing = true;
+        try {
+            if (fs.run()) {
+                LOG ("Reached a relative precision of " << precision << " after " << fs.samples() << " samples");
+            } else {
+                LOG ("Did not reach a relative precision of " << precision << " in " << ntrials << " samples");
+            }
+        } catch (const exception& e) {
+            cerr << e.what() << endl;
+            return 1;
         }
+        ntrials = fs.samples();
+        ProportionEstimate ef = fs.fit();
+        ProportionEstimate ep = fs.perfect();
+        pfit = ef.p;
+        pperfect = ep.p;
+        if (fs.stratified()) {
+            // The strata were sampled at different rates, so the raw counts would be biased
+            // towards the oversampled strata. Report the stratum-weighted counts instead.
+            LOG ("Stratified sample: the counts are stratum-weighted estimates out of " << ntrials);
+            numfit = llround (pfit * ntrials);
+            numperfect = llround (pperfect * ntrials);
+            numfit_and_canalysing = llround (fs.fitCanalysing().p * ntrials);
+            numperfect_and_canalysing = llround (fs.perfectCanalysing().p * ntrials);
+        } else {
+            numfit = fs.numfit();
+            numperfect = fs.numperfect();
+            numfit_and_canalysing = fs.numfit_and_canalysing();
+            numperfect_and_canalysing = fs.numperfect_and_canalysing();
+        }
+        LOG ("95% intervals: P(F>0) in [" << ef.lo << "," << ef.hi << "], P(F=1) in [" << ep.lo << "," << ep.hi << "]");
     }
 
     cout << ntrials << "," << numfit << "," << numperfect << endl;
@@ -178,7 +202,14 @@ int main (int argc, char** argv)
     LOG ("For " << N_Genes << " genes, there were " << numfit << " fit genomes out of " << ntrials << " of which " << numperfect << " had F=1");
     LOG ("Of the f=1 genomes, " << numperfect_and_canalysing << " were canalysing in at least one of the genome sections");
     LOG ("Of the f>0 genomes, " << numfit_and_canalysing << " were canalysing in at least one of the genome sections");
-    LOG ("That's " << (double)numfit / ntrials << " and "<< (double)numperfect / ntrials << " as proportions.");
-    LOG ("That's " << (100.0 * (double)numfit / ntrials) << "% and " << (100.0 * (double)numperfect / ntrials) << "%.");
+    LOG ("That's " << pfit << " and "<< pperfect << " as proportions.");
+    LOG ("That's " << (100.0 * pfit) << "% and " << (100.0 * pperfect) << "%.");
     return 0;
 }
+
+SIM_NAMESPACE_END
+
+#ifndef SIM_NAMESPACE
+// Compiled on its own, for the one network size given by N_Genes
+int main (int argc, char** argv) { return sim_main (argc, argv); }
+#endif
@@ -36,6 +36,7 @@ using namespace std;
 
 // The fitness function used here
 #include "fitness.h"
+#include "neighbourhood.h"
 
 int main (int argc, char** argv)
 {
@@ -67,6 +68,9 @@ int main (int argc, char** argv)
     DBG ("Fitness of unflipped genome = " << lastf);
     ab.update (genome);
 
+    // The fitness of every single bit flip of genome
+    vector<double> flipf = neighbourhood_sweep (genome, 1);
+
     for (unsigned int g = 0; g < N_Genes; ++g) {
         for (unsigned int i = 0; i < (1<<N_Ins); ++i) {
 
@@ -75,7 +79,7 @@ int main (int argc, char** argv)
 
             bitflip_genome (genome1, g, i);
 
-            f = evaluate_fitness (genome1);
+            f = flipf[g * (1<<N_Ins) + i];
 
             ab1.update (genome1);
 #ifdef DEBUG2
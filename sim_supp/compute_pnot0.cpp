@@ -1,159 +1,186 @@
 /*
  * Compute the probability of non-zero fitness in the fitness function
  * number 4. This computes the value of the relation given in
- * paper/combinatorics/combinatorics.tex/pdf for a given number of
- * genes supplied on the command line.
+ * paper/combinatorics/combinatorics.tex/pdf for each of the numbers of
+ * genes supplied on the command line (e.g. "compute_pnot0 3-25"), writing
+ * one file per number of genes. The values of l for all the numbers of
+ * genes are shared out between threads.
  */
 
 #include <iostream>
 #include <fstream>
 #include <sstream>
+#include <vector>
+#include <string>
+#include <cstdio>
 
 #define N_Genes 5 // required for lib.h but unused
 #include "lib.h"
 
 #include "lmp.h"
+#include "combicache.h"
 
+using namespace std;
+
+//! The number of values of l which are computed for each ngenes in a round
+#define PNOT0_L_BLOCK 32
+
+/*!
+ * Compute p(!0) for l of the 2^ngenes genome states, using the cache
+ * cc, which may be shared between threads.
+ */
 long double
-xint_to_double (Xint& xi)
+compute_pnot0 (CombiCache& cc, int ngenes, int l)
 {
-    long double d;
-    std::stringstream ss;
-    ss << xi;
-    ss >> d;
-    return d;
-}
+    long double numsum_d = 0.0;
+    long double denomsum_d = 0.0;
+
+    long double two_to_n_over_2_choose_l_d = cc.BinomialLD (1<<(ngenes-1), l);
+    long double two_to_n_choose_l_d = cc.BinomialLD (1<<ngenes, l);
+
+    long double col0 = two_to_n_over_2_choose_l_d / two_to_n_choose_l_d;
+    long double pnot0 = 1.0-col0;
+
+    for (ulong col = 1; col < (ulong)ngenes; ++col) {
+        numsum_d = 0.0;
+        denomsum_d = 0.0;
+        // Compute numerator and denominator sums. +ve for i=1, -ve for 2 etc
+        for (ulong i = 1; i <= col; ++i) {
+            long double m_choose_i_d = cc.BinomialLD (col, i);
+            long double two_to_n_minus_1_over_2i_choose_l_d = cc.BinomialLD (1UL<<(ngenes-1-i), l);
+            if (i%2 == 0) {
+                numsum_d -= m_choose_i_d * two_to_n_minus_1_over_2i_choose_l_d;
+            } else {
+                numsum_d += m_choose_i_d * two_to_n_minus_1_over_2i_choose_l_d;
+            }
+        }
+        for (ulong i = 1; i <= col; ++i) {
+            long double m_choose_i_d = cc.BinomialLD (col, i);
+            long double two_to_n_over_2i_choose_l_d = cc.BinomialLD (1UL<<(ngenes-i), l);
+            if (i%2 == 0) {
+                denomsum_d -= m_choose_i_d * two_to_n_over_2i_choose_l_d;
+            } else {
+                denomsum_d += m_choose_i_d * two_to_n_over_2i_choose_l_d;
+            }
+        }
 
-using namespace std;
+        // Compute probability
+        long double p_onezc = (two_to_n_over_2_choose_l_d - numsum_d) / (two_to_n_choose_l_d - denomsum_d);
+        //cout << "P(ZC"<<(col)<<"|!ZC[1->"<<col<<"]) = " << p_onezc << endl;
 
-int main (int argc, char** argv)
-{
-    if (argc < 2) {
-        cerr << "Usage: " << argv[0] << " ngenes" << endl;
-        return 1;
+        pnot0 = pnot0 * (1.0-p_onezc);
     }
 
-    int ngenes = atoi(argv[1]);
+    return pnot0;
+}
 
-    ofstream fout;
-    stringstream fpath;
-    fpath << "./data/pnot0_n" << ngenes << ".csv";
-    fout.open (fpath.str().c_str(), ios::out|ios::trunc);
+/*!
+ * Add the values of ngenes given by arg, which is either a number or a
+ * range like 3-25, to ns. Returns false if arg isn't valid.
+ */
+bool
+parse_ngenes (const string& arg, vector<int>& ns)
+{
+    int first = 0, last = 0;
+    char dash = 0, extra = 0;
+    int nread = sscanf (arg.c_str(), "%d%c%d%c", &first, &dash, &last, &extra);
+    if (nread == 1) {
+        last = first;
+    } else if (nread != 3 || dash != '-') {
+        return false;
+    }
+    // 2^ngenes must fit in an int
+    if (first < 1 || last < first || last > 30) {
+        return false;
+    }
+    for (int n = first; n <= last; ++n) {
+        ns.push_back (n);
+    }
+    return true;
+}
 
-    if (!fout.is_open()) {
-        cerr << "Failed to open file " << fpath.str() << endl;
+int main (int argc, char** argv)
+{
+    vector<int> ns;
+    for (int a = 1; a < argc; ++a) {
+        if (!parse_ngenes (argv[a], ns)) {
+            ns.clear();
+            break;
+        }
+    }
+    if (ns.empty()) {
+        cerr << "Usage: " << argv[0] << " ngenes [ngenes...]" << endl;
+        cerr << "  where ngenes is a number, or a range such as 3-25. Writes ./data/pnot0_n<ngenes>.csv" << endl;
         return 1;
     }
 
-    fout << "l,p(!0),p(0)" << endl;
-
-    long double p0 = 0.0;
-    long double pnot0 = 1.0;
-
-    for (int l = 1; l<=(1<<(ngenes)); ++l) {
-
-        Xint two_to_n_choose_l;
-        Xint two_to_n_over_2_choose_l;
-        lmp::InitSetUi (two_to_n_choose_l, 1);
-        lmp::InitSetUi (two_to_n_over_2_choose_l, 1);
-
-        long double two_to_n_choose_l_d = 0.0;
-        long double two_to_n_over_2_choose_l_d = 0.0;
-        long double two_to_n_minus_1_over_2i_choose_l_d = 0.0;
-        long double two_to_n_over_2i_choose_l_d = 0.0;
-        long double m_choose_i_d = 0.0;
-        long double numsum_d = 0.0;
-        long double denomsum_d = 0.0;
-
-        // Once only:
-        lmp::BinomialUiUi(two_to_n_over_2_choose_l, 1<<(ngenes-1), l);
-        two_to_n_over_2_choose_l_d = xint_to_double (two_to_n_over_2_choose_l);
-
-        lmp::BinomialUiUi(two_to_n_choose_l, 1<<ngenes, l);
-        two_to_n_choose_l_d = xint_to_double (two_to_n_choose_l);
-
-        long double col0 = two_to_n_over_2_choose_l_d / two_to_n_choose_l_d;
-        pnot0 = 1.0-col0;
-        //cout << "P(ZC0) = " << col0 << endl;
-        //cout << "P(!ZC0) = " << pnot0 << endl;
-
-        for (ulong col = 1; col < (ulong)ngenes; ++col) {
-            numsum_d = 0.0;
-            denomsum_d = 0.0;
-            // Compute numerator sum
-            for (ulong i = 1; i <= col; ++i) {
-
-                Xint m_choose_i;
-                Xint two_to_n_minus_1_over_2i_choose_l;
-                lmp::InitSetUi (m_choose_i, 1);
-                lmp::InitSetUi (two_to_n_minus_1_over_2i_choose_l, 1);
-
-                lmp::BinomialUiUi(m_choose_i, col, i);
-                m_choose_i_d = xint_to_double (m_choose_i);
-                //cout << col << " choose " << i << " = " << m_choose_i_d << endl; // crash?!
-
-                lmp::BinomialUiUi(two_to_n_minus_1_over_2i_choose_l, static_cast<ulong>(1<<(ngenes-1-i)), static_cast<ulong>(l));
-
-                //cout << static_cast<ulong>(1<<(ngenes-1-i)) << " choose " << static_cast<ulong>(l) << " = "
-                //     << two_to_n_minus_1_over_2i_choose_l << endl;
-                two_to_n_minus_1_over_2i_choose_l_d = xint_to_double (two_to_n_minus_1_over_2i_choose_l);
-                // +ve for 1, -ve for 2 etc
-                bool negative = (i%2==0);
-                if (negative) {
-                    //cout << "numsum_d -= " << m_choose_i_d << " * " << two_to_n_minus_1_over_2i_choose_l_d << endl;
-                    numsum_d -= m_choose_i_d * two_to_n_minus_1_over_2i_choose_l_d;
-                } else {
-                    //cout << "numsum_d += " << m_choose_i_d << " * " << two_to_n_minus_1_over_2i_choose_l_d << endl;
-                    numsum_d += m_choose_i_d * two_to_n_minus_1_over_2i_choose_l_d;
-                }
-                lmp::Clear(m_choose_i);
-                lmp::Clear(two_to_n_minus_1_over_2i_choose_l);
-            }
+    vector<ofstream*> fouts;
+    for (size_t j = 0; j < ns.size(); ++j) {
+        stringstream fpath;
+        fpath << "./data/pnot0_n" << ns[j] << ".csv";
+        ofstream* fout = new ofstream (fpath.str().c_str(), ios::out|ios::trunc);
+        fouts.push_back (fout);
+        if (!fout->is_open()) {
+            cerr << "Failed to open file " << fpath.str() << endl;
+            return 1;
+        }
+        *fout << "l,p(!0),p(0)" << endl;
+        fout->precision(18);
+    }
 
-            // Compute denomenator sum
-            for (ulong i = 1; i <= col; ++i) {
-
-                Xint m_choose_i;
-                lmp::InitSetUi (m_choose_i, 1);
-                Xint two_to_n_over_2i_choose_l;
-                lmp::InitSetUi (two_to_n_over_2i_choose_l, 1);
-
-                lmp::BinomialUiUi(m_choose_i, col, i);
-                m_choose_i_d = xint_to_double (m_choose_i);
-                lmp::BinomialUiUi(two_to_n_over_2i_choose_l, static_cast<ulong>(1<<(ngenes-i)), static_cast<ulong>(l));
-                two_to_n_over_2i_choose_l_d = xint_to_double (two_to_n_over_2i_choose_l);
-                // +ve for 1, -ve for 2 etc
-                bool negative = (i%2==0);
-                if (negative) {
-                    denomsum_d -= m_choose_i_d * two_to_n_over_2i_choose_l_d;
-                    //cout << "denomsum_d -= " << m_choose_i_d << " * " << two_to_n_over_2i_choose_l_d << endl;
-                } else {
-                    denomsum_d += m_choose_i_d * two_to_n_over_2i_choose_l_d;
-                    //cout << "denomsum_d += " << m_choose_i_d << " * " << two_to_n_over_2i_choose_l_d << endl;
-                }
-                lmp::Clear(m_choose_i);
-                lmp::Clear(two_to_n_over_2i_choose_l);
+    // The same binomial coefficients are needed for every col (and for
+    // many values of ngenes), so they're memoized here, for all threads
+    CombiCache cc;
+
+    // Each round computes the next PNOT0_L_BLOCK values of l for every
+    // ngenes that's not yet finished. A file is finished at the first l
+    // for which p(!0) is 1.
+    vector<int> next_l (ns.size(), 1);
+    vector<bool> done (ns.size(), false);
+    vector<int> item_n;
+    vector<int> item_l;
+    vector<long double> item_pnot0;
+
+    for (;;) {
+        item_n.clear();
+        item_l.clear();
+        for (size_t j = 0; j < ns.size(); ++j) {
+            if (done[j]) { continue; }
+            int lmax = 1<<ns[j];
+            for (int l = next_l[j]; l < next_l[j] + PNOT0_L_BLOCK && l <= lmax; ++l) {
+                item_n.push_back ((int)j);
+                item_l.push_back (l);
             }
-
-            // Compute probability
-            //cout << "Probability sum: " << two_to_n_over_2_choose_l_d << " - " <<  numsum_d << " / " << two_to_n_choose_l_d << " - " << denomsum_d << endl;
-            long double p_onezc = (two_to_n_over_2_choose_l_d - numsum_d) / (two_to_n_choose_l_d - denomsum_d);
-            //cout << "P(ZC"<<(col)<<"|!ZC[1->"<<col<<"]) = " << p_onezc << endl;
-
-            pnot0 = pnot0 * (1.0-p_onezc);
+        }
+        if (item_n.empty()) {
+            break;
         }
 
-        p0 = 1.0 - pnot0;
-
-        fout.precision(18);
-        fout << l << "," << pnot0 << "," << p0 << endl;
+        item_pnot0.resize (item_n.size());
+        long int nitems = (long int)item_n.size();
+#pragma omp parallel for schedule(dynamic)
+        for (long int i = 0; i < nitems; ++i) {
+            item_pnot0[i] = compute_pnot0 (cc, ns[item_n[i]], item_l[i]);
+        }
 
-        if (pnot0 == 1.0) {
-            break;
+        // The items are in order of l for each ngenes
+        for (size_t i = 0; i < item_n.size(); ++i) {
+            int j = item_n[i];
+            if (done[j]) { continue; }
+            long double pnot0 = item_pnot0[i];
+            long double p0 = 1.0 - pnot0;
+            *fouts[j] << item_l[i] << "," << pnot0 << "," << p0 << endl;
+            next_l[j] = item_l[i] + 1;
+            if (pnot0 == 1.0 || next_l[j] > (1<<ns[j])) {
+                done[j] = true;
+            }
         }
     }
 
-    fout.close();
+    for (size_t j = 0; j < fouts.size(); ++j) {
+        fouts[j]->close();
+        delete fouts[j];
+    }
 
     return 0;
 }
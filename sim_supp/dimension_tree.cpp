@@ -1,8 +1,10 @@
 /*
- * Compute, by brute force, the tree of nodes and edges for an n
- * dimensional boolean space. Start at the node [000...0000] and
- * proceed with incrementing Hamming distance from the start. Make
- * sets containing the layer nodes and the transitions.
+ * Compute the tree of nodes and edges for an n dimensional boolean
+ * space. Start at the node [000...0000] and proceed with incrementing
+ * Hamming distance from the start. Each layer's nodes and the
+ * transitions into it are generated in order (see hypercube.h) and
+ * streamed out, so nothing is held in memory and n up to about 24 is
+ * feasible (though the n=24 files are several GB).
  *
  * Save out in a form suitable for graphing in python.
  */
@@ -10,88 +12,46 @@
 #include <iostream>
 #include <sstream>
 #include <fstream>
+#include <vector>
+#include <stdlib.h>
 
 //#define DEBUG 1
 
 #define N_Genes 5 // required for lib.h but unused
 #include "lib.h"
-
-#include <vector>
-#include <utility>
-#include <set>
-#include <map>
-#include <deque>
+#include "hypercube.h"
 
 using namespace std;
 
-// Can go to 32 bits without messing about with very long numbers -
-// this is because while the nodes can be 32 bit, the transition type
-// needs to be 64 bits (though I could store transitions as pairs of
-// node_t). Won't need anything like this many; we'd have 10^8 nodes
-// in the middle layer for a n=32 dimension space, so this can be an
-// unsigned int.
-typedef unsigned int node_t;
-
-// A privately defined compute hamming function
-node_t
-_compute_hamming (node_t n, node_t state, node_t target)
-{
-    node_t bits = state ^ target;
-    unsigned int hamming = _mm_popcnt_u32 ((unsigned int)bits);
-    return static_cast<node_t>(hamming);
-}
+//! The largest sensible n. The layer files grow as n 2^n.
+#define Dimension_Tree_Max_N 24
 
-void find_paths (map<node_t, deque<node_t> >& paths,
-                 vector<set<pair<node_t, node_t> > >& transition_layers,
-                 node_t pathto_state,
-                 int set_bits_pathto)
+#ifdef SHOW_PATHS
+/*!
+ * List the paths from 0 to target, one bit at a time, from path, which
+ * holds the nodes so far. pathnum counts the paths listed.
+ */
+void show_paths (node_t target, vector<node_t>& path, unsigned long long int& pathnum)
 {
-    DBG ("Called for transition layer " << set_bits_pathto);
-
-    if (set_bits_pathto == -1) {
-        DBG ("Returning as set_bits_pathto is -1");
+    node_t last = path.back();
+    if (last == target) {
+        cout << "Path " << pathnum++ << ": ";
+        for (node_t nd : path) {
+            cout << nd << ",";
+        }
+        cout << endl;
         return;
     }
-    // For each member of transition layers[set_bits_pathto],
-    // see if its second element is equal to pathto_state. For each one that IS...
-    for (pair<node_t, node_t>trans : transition_layers[set_bits_pathto]) {
-        DBG2 ("Transitions to " << set_bits_pathto << " set bits layer: "  << trans.first << "->" << trans.second << "...");
-        if (trans.second == pathto_state) {
-            DBG ("Transition " << trans.first << "->" << trans.second << " ends on pathto_state");
-            // Now check through paths to make sure we don't need to add to an existing path
-            map<node_t, deque<node_t> >::iterator pi = paths.begin();
-            bool added = false;
-            int max_path_idx = paths.size() - 1;
-            DBG ("max_path_idx = " << max_path_idx);
-            while (pi != paths.end()) {
-                DBG ("Checking path " << pi->first << " added is " << added << ", comparing path front: " << pi->second.front() << " with pathto_state: " << pathto_state);
-                if (pi->second.front() == pathto_state) {
-                    DBG ("Adding " << trans.first << " to path " << pi->first);
-                    pi->second.push_front (trans.first);
-                    added = true;
-                }
-                if ((int)pi->first > max_path_idx) {
-                    max_path_idx = pi->first;
-                }
-
-                ++pi;
-            }
-            if (!added) {
-                DBG ("Adding new path " << trans.first << "->" << trans.second << " to paths index " << (max_path_idx+1));
-                deque<node_t> new_deque;
-                new_deque.push_back (trans.first);
-                new_deque.push_back (trans.second);
-                paths.insert (make_pair (max_path_idx+1, new_deque));
-            }
-            // Recurse
-            DBG ("Recursion to trans layer " << (set_bits_pathto-1) << ", paths size is " << paths.size());
-            find_paths (paths, transition_layers, trans.first, set_bits_pathto-1);
-            DBG ("After recursion, paths size is " << paths.size());
-        } // else do nothing
+    for (unsigned int b = 0; b < 32; ++b) {
+        node_t bit = (node_t)1 << b;
+        if ((target & bit) && !(last & bit)) {
+            path.push_back (last | bit);
+            show_paths (target, path, pathnum);
+            path.pop_back();
+        }
     }
-    // At end, recurse?
-    //find_paths (paths, transition_layers, trans.first, set_bits_pathto-1);
 }
+#endif
 
 int main (int argc, char** argv)
 {
@@ -101,49 +61,15 @@ int main (int argc, char** argv)
         return 1;
     }
 
-    node_t n = atoi(argv[1]);
-    if (n >= 16) { // Could be increased to 32 but results will be fairly useless.
-        cerr << "Please choose n < 16 (probably 6, 7 or 8 is a sensible maximum)" << endl;
+    unsigned int n = atoi(argv[1]);
+    if (n < 1 || n > Dimension_Tree_Max_N) {
+        cerr << "Please choose 1 <= n <= " << Dimension_Tree_Max_N
+             << " (probably 6, 7 or 8 is a sensible maximum for graphing)" << endl;
         return 1;
     }
-    node_t n_states = 1<<n;
-    int set_bits = 0;
-
-    vector<set<node_t> > node_layers;
-    vector<set<pair<node_t, node_t> > > transition_layers;
-
-    for (node_t n_ones = 0; n_ones <= n; ++n_ones) {
-        set<node_t> nodes;
-        set<pair<node_t, node_t> > trans;
-        for (node_t i = 0; i < n_states; ++i) {
-            set_bits = _mm_popcnt_u32 ((unsigned int)i);
-            if ((node_t)set_bits == n_ones) {
-                nodes.insert(i);
-
-                // If not on the first layer, determine which of the
-                // members of the previous layer set can connect to this
-                // state with a single bit flip.
-                if (n_ones > 0) {
-                    set<node_t>::const_iterator j = node_layers.back().begin();
-                    while (j != node_layers.back().end()) {
-                        node_t hd = _compute_hamming (n, *j, i);
-                        if (hd == 1) {
-                            // Hamming separation is 1. Add transition
-                            trans.insert (make_pair (*j, i));
-                        }
-                        ++j;
-                    }
-                }
-            }
-        }
-        node_layers.push_back (nodes);
-        if (n_ones > 0) {
-            transition_layers.push_back (trans);
-        }
-    }
 
     // Write results out
-    for (node_t n_ones = 0; n_ones <= n; ++n_ones) {
+    for (unsigned int n_ones = 0; n_ones <= n; ++n_ones) {
 
         ofstream f_nodes;
         stringstream nodespath;
@@ -153,12 +79,13 @@ int main (int argc, char** argv)
             cerr << "File open error" << endl;
             return 1;
         }
-        set<node_t>::const_iterator j = node_layers[n_ones].begin();
-        while (j != node_layers[n_ones].end()) {
-            f_nodes << *j << endl;
-            ++j;
-        }
+        unsigned long long int nnodes = 0;
+        hypercube_layer (n, n_ones, [&f_nodes, &nnodes](node_t nd) {
+            f_nodes << nd << "\n";
+            ++nnodes;
+        });
         f_nodes.close();
+        DBG ("Layer " << n_ones << ": " << nnodes << " nodes");
 
         if (n_ones > 0) {
             ofstream f_trans;
@@ -169,23 +96,22 @@ int main (int argc, char** argv)
                 cerr << "File open error" << endl;
                 return 1;
             }
-            set<pair<node_t, node_t> >::const_iterator k = transition_layers[n_ones-1].begin();
-            while (k != transition_layers[n_ones-1].end()) {
-                f_trans << k->first << "," << k->second << endl;
-                ++k;
-            }
+            hypercube_transitions (n, n_ones, [&f_trans](node_t from, node_t to) {
+                f_trans << from << "," << to << "\n";
+            });
             f_trans.close();
         }
     }
 
     // Now find the number of unique paths to a specific state.
     if (argc > 2) {
-        node_t pathto_state = atoi(argv[2]);
-        if (pathto_state >= (node_t)(1<<n)) {
-            cerr << "pathto_state should be in range [0,"<< ((1<<n)-1) << "]" << endl;
+        unsigned long long int pathto_arg = strtoull (argv[2], (char**)0, 10);
+        if (pathto_arg >= (1ULL<<n)) {
+            cerr << "pathto_state should be in range [0,"<< ((1ULL<<n)-1) << "]" << endl;
             return 1;
         }
-        int set_bits_pathto = _mm_popcnt_u32 ((unsigned int)pathto_state);
+        node_t pathto_state = (node_t)pathto_arg;
+        int set_bits_pathto = __builtin_popcount (pathto_state);
         cout << "Finding paths to the state "<< pathto_state << " which has " << set_bits_pathto << " set bits." << endl;
 
         if (set_bits_pathto == 0) {
@@ -193,20 +119,16 @@ int main (int argc, char** argv)
             return 0;
         }
 
-        // Recursive function required to find all the paths.
-        map<node_t, deque<node_t> > paths;
-        find_paths (paths, transition_layers, pathto_state, set_bits_pathto-1);
-        cout << "There are " << paths.size() << " paths from 0 to " << pathto_state << endl;
-#ifdef SHOW_PATHS
-        map<node_t, deque<node_t> >::iterator pi = paths.begin();
-        while (pi != paths.end()) {
-            cout << "Path " << pi->first << ": ";
-            for (node_t n : pi->second) {
-                cout << n << ",";
-            }
-            cout << endl;
-            ++pi;
+        vector<pathcount_t> layer_paths;
+        pathcount_t npaths = hypercube_count_paths (pathto_state, &layer_paths);
+        for (unsigned int k = 1; k < layer_paths.size(); ++k) {
+            DBG ("Paths into layer " << k << ": " << pathcount_str (layer_paths[k]));
         }
+        cout << "There are " << pathcount_str (npaths) << " paths from 0 to " << pathto_state << endl;
+#ifdef SHOW_PATHS
+        vector<node_t> path (1, 0);
+        unsigned long long int pathnum = 0;
+        show_paths (pathto_state, path, pathnum);
 #endif
 
         // Answer:
@@ -215,31 +137,6 @@ int main (int argc, char** argv)
         // There are h! ways to traverse from one vertex to another
         // vertex in a layer which is a Hamming distance h away from
         // the starting vertex.
-
-#if 0
-        // Investigating each layer.
-        set<node_t> target_states;
-        set<node_t> next_target_states;
-        target_states.insert(pathto_state);
-        while (set_bits_pathto > 0) {
-            next_target_states.clear();
-            // First find the target state in its layer.
-            set<pair<node_t, node_t> >::const_iterator k = transition_layers[set_bits_pathto-1].begin();
-            cout << "Its layer:" << endl;
-            while (k != transition_layers[set_bits_pathto-1].end()) {
-                for (node_t ts : target_states) {
-                    if (k->second == ts) {
-                        // There is a transition in this layer to a target state.
-                        cout << k->first << "," << k->second << endl;
-                        next_target_states.insert (k->first);
-                    }
-                }
-                ++k;
-            }
-            target_states.swap (next_target_states);
-            --set_bits_pathto;
-        }
-#endif
     }
 
     return 0;
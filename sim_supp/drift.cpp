@@ -3,7 +3,15 @@
  *
  * The drifting algorithm evolves the genome at every generation, recording how often an f=1 genome
  * is happened upon. With the drift algorithm, all p values should give the same mean time to f=1.
-
+ *
+ * Usage: drift pOn [nwalkers [generations]]
+ *
+ * The generations (N_Generations by default) are shared between nwalkers independent walkers (by
+ * default, one per thread), which run in parallel (see drift.h). Their hitting times are written
+ * to the data file as they're found, so the order of the lines depends on the threads' timing, but
+ * the set of times depends only on the seed and nwalkers. The _withf version, which records every
+ * generation, runs one walker.
+ *
  * Author: S James
  * Date: October 2018.
  */
@@ -47,6 +55,50 @@ using namespace std;
 // The fitness function used here
 #include "fitness.h"
 
+#include "drift.h"
+
+#ifdef RECORD_ALL_FITNESS
+/*!
+ * Records the evolution of the fitness of a genome. Fig 3. The (abs) generation for each fitness
+ * is recorded along with the floating point fitness value, in a vector of vectors, with one
+ * vector for each evolution towards F=1.
+ */
+struct DriftRecorder
+{
+    DriftRecorder() : lastf(0.0) { this->netinfo.push_back (vector<NetInfo>()); }
+    void operator() (const array<genosect_t, N_Genes>& genome, unsigned long long int gen, double f, bool hit)
+    {
+        this->ab1.update (genome);
+        NetInfo ni(this->ab1, gen, f);
+        ni.deltaF = f - this->lastf;
+        this->netinfo.back().push_back (ni);
+        if (hit) {
+            this->netinfo.push_back (vector<NetInfo>());
+            this->lastf = 0.0;
+        } else {
+            this->lastf = f;
+        }
+    }
+    vector<vector<NetInfo> > netinfo;
+    double lastf;
+    AllBasins ab1;
+};
+#endif
+
+//! Writes hitting times to the data file, one per line.
+struct DriftFileSink
+{
+    DriftFileSink (ofstream& _fout) : fout(_fout) {}
+    void operator() (const vector<unsigned long long int>& times)
+    {
+        for (size_t i = 0; i < times.size(); ++i) {
+            this->fout << times[i] << "\n";
+        }
+        this->fout.flush();
+    }
+    ofstream& fout;
+};
+
 // Perform a loop N_Generations long during which an initially
 // randomly selected genome is evolved until a maximally fit state is
 // achieved.
@@ -54,13 +106,40 @@ int main (int argc, char** argv)
 {
     // Obtain pOn from command line.
     if (argc < 2) {
-        LOG ("Usage: " << argv[0] << " pOn");
+        LOG ("Usage: " << argv[0] << " pOn [nwalkers [generations]]");
         LOG ("Supply the probability of flipping a gene during drift, pOn (float, 0 to 1.0f)");
         return 1;
     }
     pOn = static_cast<float>(atof (argv[1]));
     LOG ("Probability of flipping = " << pOn);
 
+#ifdef RECORD_ALL_FITNESS
+    unsigned int nwalkers = 1;
+#elif defined _OPENMP
+    unsigned int nwalkers = omp_get_max_threads();
+#else
+    unsigned int nwalkers = 1;
+#endif
+    if (argc > 2) {
+        nwalkers = static_cast<unsigned int>(atoi (argv[2]));
+    }
+    unsigned long long int ngens = N_Generations;
+    if (argc > 3) {
+        ngens = strtoull (argv[3], (char**)0, 10);
+    }
+    if (nwalkers == 0 || ngens < nwalkers) {
+        LOG ("Need at least one walker and one generation per walker");
+        return 1;
+    }
+#ifdef RECORD_ALL_FITNESS
+    if (nwalkers != 1) {
+        LOG ("The _withf version runs one walker only");
+        return 1;
+    }
+#endif
+    unsigned long long int gens_per_walker = ngens / nwalkers;
+    LOG (nwalkers << " walkers of " << gens_per_walker << " generations");
+
     // Seed the RNG.
     unsigned int seed = mix(clock(), time(NULL), getpid());
     srand (seed);
@@ -72,105 +151,43 @@ int main (int argc, char** argv)
     // Initialise masks
     masks_init();
 
-    // generations records the relative number of generations required
-    // to achieve fitness 1.
-    vector<unsigned int> generations;
-
-#ifdef RECORD_ALL_FITNESS
-    // Records the evolution of the fitness of a genome. Fig 3. The
-    // (abs) generation for each fitness is recorded along with the
-    // floating point fitness value. Record this in a vector of
-    // vectors, with one vector for each evolution towards F=1
-    vector<vector<NetInfo> > netinfo;
-    vector<NetInfo> ni0;
-    netinfo.push_back (ni0);
-#endif
-
-    // Set to true when a new, random genome should be generated
-    bool need_new_genome = true;
-
-    // Holds the drifting genome
-    array<genosect_t, N_Genes> genome;
-
-    unsigned int lastgen = 0;
-    double f = 0.0;
-#ifdef RECORD_ALL_FITNESS
-    double lastf = 0.0;
-    AllBasins ab1;
-#endif
-
-    // The main loop. Repeatedly evolve from a random genome starting
-    // point, recording the number of generations required to achieve a
-    // maximally fit state of 1.
-    for (unsigned int gen = 0; gen < N_Generations; ++gen) {
-
-        // At the start of the loop, and every time fitness of 1.0 is
-        // achieved, generate a random genome starting point.
-        if (need_new_genome == true) {
-            DBG ("Generate new random genome");
-            random_genome (genome);
-            need_new_genome = false;
-        }
-
-        f = evaluate_fitness (genome);
-        DBG2 ("Fitness f = " << f);
-
-#ifdef RECORD_ALL_FITNESS
-        ab1.update (genome);
-        NetInfo ni(ab1, gen, f);
-        ni.deltaF = f - lastf;
-        netinfo.back().push_back (ni);
-#endif
-
-        // Test fitness to determine whether we should evolve.
-        if (f == 1.0) {
-            DBG ("Fitness max. F=" << f);
-            // Record data
-            generations.push_back (gen-lastgen);
-            lastgen = gen;
-
-#ifdef RECORD_ALL_FITNESS
-            if (gen < N_Generations) {
-                vector<NetInfo> vni;
-                netinfo.push_back (vni);
-            }
-            lastf = 0.0;
-#endif
-            // Reset loop variables
-            need_new_genome = true;
-
-        } else {
-            evolve_genome (genome);
-#ifdef RECORD_ALL_FITNESS
-            lastf = f;
-#endif
-        }
-    }
-
-    LOG ("Generations size: " << generations.size());
-
-    // Save data to file. These data files can be graphed using the python scripts.
+    // Save data to file as it's generated. These data files can be graphed using the python
+    // scripts. The file is named for the number of generations asked for.
     ofstream fout;
     stringstream pathss;
     pathss << "./data/drift_";
     pathss << "a" << (unsigned int)target_ant << "_p" << (unsigned int)target_pos << "_";
-    pathss << FF_NAME << "_" << N_Generations << "_gens_" << pOn << ".csv";
+    pathss << FF_NAME << "_" << ngens << "_gens_" << pOn << ".csv";
     fout.open (pathss.str().c_str());
     if (!fout.is_open()) {
         cerr << "Error opening " << pathss.str() << endl;
         return 1;
     }
-    for (unsigned int i = 0; i < generations.size(); ++i) {
-        fout << generations[i] << endl;
-    }
+    DriftFileSink sink (fout);
+
+#ifdef RECORD_ALL_FITNESS
+    vector<RngData> rds;
+    rngDataInitStreams (rds, 1);
+    DriftRecorder recorder;
+    DriftBatcher<DriftFileSink> batcher (sink);
+    unsigned long long int nhits = 0;
+    auto on_hit = [&batcher, &nhits](unsigned long long int t) { batcher (t); ++nhits; };
+    drift_walk (&rds[0], pOn, gens_per_walker, on_hit, recorder);
+    batcher.flush();
+#else
+    unsigned long long int nhits = drift_walkers (nwalkers, pOn, gens_per_walker, sink);
+#endif
     fout.close();
 
+    LOG ("Generations size: " << nhits);
+
 #ifdef RECORD_ALL_FITNESS
+    vector<vector<NetInfo> >& netinfo = recorder.netinfo;
     // Open file
     stringstream pathss2;
     pathss2 << "./data/drift_withf_";
     pathss2 << "a" << (unsigned int)target_ant << "_p" << (unsigned int)target_pos << "_";
-    pathss2 << FF_NAME << "_" << N_Generations <<  "_fitness_" << pOn << ".csv";
+    pathss2 << FF_NAME << "_" << ngens <<  "_fitness_" << pOn << ".csv";
     fout.open (pathss2.str().c_str());
     if (!fout.is_open()) {
         cerr << "Error opening " << pathss2.str() << endl;
@@ -3,6 +3,12 @@
  * each. The idea is to determine, by sampling, the distribution of
  * fitnesses for the chosen fitness function.
  *
+ * The genomes are shared between threads, each with its own RNG stream,
+ * adding their fitnesses to their own StreamStats (see stream_stats.h),
+ * which are merged at the end. The summary (exact counts of F=0 and
+ * F=1, a log binned histogram and quantiles) is written to
+ * data/fitness_dist_<ff>_n<N_Genomes>.json.
+ *
  * Author: S James
  * Date: November 2018.
  */
@@ -14,9 +20,11 @@
 #include <sstream>
 #include <fstream>
 #include <string>
-#include <map>
 #include <sys/types.h>
 #include <unistd.h>
+#ifdef _OPENMP
+# include <omp.h>
+#endif
 
 using namespace std;
 
@@ -42,6 +50,8 @@ using namespace std;
 // The fitness function used here
 #include "fitness.h"
 
+#include "stream_stats.h"
+
 // Perform a loop N_Generations long during which an initially
 // randomly selected genome is evolved until a maximally fit state is
 // achieved.
@@ -58,21 +68,41 @@ int main (int argc, char** argv)
     // Initialise masks
     masks_init();
 
-    // The fitnesses that we find, the fitness itself is the key, the
-    // number of times that fitness is found is the value.
-    map<double, unsigned long long int> fitnesses;
+#ifdef _OPENMP
+    unsigned int nthreads = omp_get_max_threads();
+#else
+    unsigned int nthreads = 1;
+#endif
+    vector<RngData> rds;
+    rngDataInitStreams (rds, nthreads);
+
+    // One shard of the summary per thread
+    vector<StreamStats> shards (nthreads);
+
+#pragma omp parallel num_threads(nthreads)
+    {
+#ifdef _OPENMP
+        unsigned int t = omp_get_thread_num();
+#else
+        unsigned int t = 0;
+#endif
+        array<genosect_t, N_Genes> genome;
+#pragma omp for schedule(static)
+        for (long long int i = 0; i < (long long int)N_Genomes; ++i) {
+            random_genome (genome, &rds[t]);
+            shards[t].add (evaluate_fitness (genome));
+        }
+    }
 
-    array<genosect_t, N_Genes> genome;
-    for (unsigned int i = 0; i < N_Genomes; ++i) {
-        random_genome (genome);
-        double f = evaluate_fitness (genome);
-        fitnesses[f]++;
+    StreamStats fitnesses = shards[0];
+    for (unsigned int t = 1; t < nthreads; ++t) {
+        fitnesses.merge (shards[t]);
     }
+    LOG ("F=0: " << fitnesses.n_zero << ", F=1: " << fitnesses.n_one << " of " << fitnesses.n);
 
-    LOG ("fitnesses.size(): " << fitnesses.size());
     ofstream fout;
     stringstream pathss;
-    pathss << "./data/fitness_dist_" << FF_NAME << "_n" << N_Genomes << ".csv";
+    pathss << "./data/fitness_dist_" << FF_NAME << "_n" << N_Genomes << ".json";
 
     fout.open (pathss.str().c_str(), ios::out|ios::trunc);
     if (!fout.is_open()) {
@@ -80,12 +110,10 @@ int main (int argc, char** argv)
         return 1;
     }
 
-    auto mi = fitnesses.begin();
-    while (mi != fitnesses.end()) {
-        fout << mi->first << "," << mi->second << endl;
-        ++mi;
-    }
-
+    fout.precision (10);
+    fout << "{\"ff\":\"" << FF_NAME << "\",\"n_genes\":" << N_Genes << ",\"fitness\":";
+    fitnesses.write_json (fout);
+    fout << "}" << endl;
     fout.close();
 
     return 0;
@@ -3,6 +3,9 @@
  * posterior initial states will end on the same limit cycle - those
  * genomes which have 'shared terminations'.
  *
+ * Uses shared_termination() (basins.h), which follows just the two
+ * trajectories rather than finding all the basins of attraction.
+ *
  * Author: S James
  * Date: November 2018.
  */
@@ -56,10 +59,7 @@ int main (int argc, char** argv)
     for (unsigned int i = 0; i < N_Genomes; ++i) {
         random_genome (genome);
         //double f = evaluate_fitness (genome);
-        AllBasins ab (genome);
-        BasinOfAttraction ba = ab.find (initial_ant);
-        BasinOfAttraction bp = ab.find (initial_pos);
-        if (ba.endpoint != ENDPOINT_UNKNOWN && (ba.limitCycle == bp.limitCycle)) {
+        if (shared_termination (genome, initial_ant, initial_pos)) {
             // Both initial states land on the same attractor
             ++num_sharedterm;
         }
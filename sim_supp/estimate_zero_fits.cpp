@@ -1,6 +1,7 @@
 /*
- * Randomly selects N_Genomes genomes and finds numbers for those with
- * fitness 0, those with >0 fitness and those with fitness == 1.
+ * Randomly selects genomes (up to N_Genomes of them) and finds numbers
+ * for those with fitness 0, those with >0 fitness and those with
+ * fitness == 1. Stops early once P(F=1) is known to within 5%.
  *
  * Author: S James
  * Date: October 2018.
@@ -27,7 +28,7 @@ using namespace std;
 # define N_Genes 5
 #endif
 
-// The number of genomes to generate
+// The maximum number of genomes to generate
 #define N_Genomes 1000000
 
 // Common code
@@ -35,6 +36,7 @@ using namespace std;
 
 // The fitness function used here
 #include "fitness.h"
+#include "sampler.h"
 
 // Perform a loop N_Generations long during which an initially
 // randomly selected genome is evolved until a maximally fit state is
@@ -52,33 +54,24 @@ int main (int argc, char** argv)
     // Initialise masks
     masks_init();
 
-    unsigned int num_fitness1    = 0;
-    unsigned int num_fitness0    = 0;
-    unsigned int num_fitness_gt0 = 0;
-
-    array<genosect_t, N_Genes> genome;
-    for (unsigned int i = 0; i < N_Genomes; ++i) {
-        random_genome (genome);
-        double f = evaluate_fitness (genome);
-        if (f > 1.0) {
-            cerr << "Fitness > 1.0?!? [" << f << "]" << endl;
-            return 1;
-        } else if (f == 1.0) {
-            ++num_fitness1;
-            ++num_fitness_gt0;
-        } else if (f > 0.0) {
-            ++num_fitness_gt0;
-        } else if (f == 0.0) {
-            ++num_fitness0;
-        } else {
-            cerr << "Fitness < 0.0?!? [" << f << "]" << endl;
-            return 1;
-        }
+    // Sample until P(F=1) is known to within 5%, or N_Genomes have been tested.
+    FitnessSampler fs;
+    fs.precision = 0.05;
+    fs.max_samples = N_Genomes;
+    try {
+        fs.run();
+    } catch (const exception& e) {
+        cerr << e.what() << endl;
+        return 1;
     }
 
-    LOG (num_fitness1 << "/" << N_Genomes << " genomes had fitness 1");
-    LOG (num_fitness_gt0 << "/" << N_Genomes << " genomes had fitness >0");
-    LOG (num_fitness0 << "/" << N_Genomes << " genomes had fitness 0");
+    unsigned long long int num_samples = fs.samples();
+    LOG (fs.numperfect() << "/" << num_samples << " genomes had fitness 1");
+    LOG (fs.numfit() << "/" << num_samples << " genomes had fitness >0");
+    LOG ((num_samples - fs.numfit()) << "/" << num_samples << " genomes had fitness 0");
+    ProportionEstimate ef = fs.fit();
+    ProportionEstimate ep = fs.perfect();
+    LOG ("95% intervals: P(F>0) in [" << ef.lo << "," << ef.hi << "], P(F=1) in [" << ep.lo << "," << ep.hi << "]");
 
     return 0;
 }
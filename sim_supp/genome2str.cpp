@@ -1,13 +1,15 @@
 /*
  * Convert from genome_id format
  * (e.g. 5039a8e4-a090a0eb-56cfd0a8-9c9ccdbb-60b214b) to 1s and 0s
- * format.
+ * format. Given "-" as its argument, converts one genome_id per line
+ * from stdin to stdout.
  *
  * Author: S James
  * Date: October 2018.
  */
 
 #include <iostream>
+#include <cstdio>
 #include <vector>
 #include <set>
 #include <stdlib.h>
@@ -19,8 +21,8 @@ using namespace std;
 
 // Choose debugging level.
 //
-#define DEBUG 1
-#define DEBUG2 1
+// #define DEBUG 1
+// #define DEBUG2 1
 
 // Number of genes in a state is set at compile time.
 #ifndef N_Genes
@@ -30,6 +32,37 @@ using namespace std;
 // Common code
 #include "lib.h"
 
+// The number of genomes converted at a time when reading stdin
+#define BATCH_GENOMES 65536
+
+/*!
+ * Convert a genome_id on each line of stdin to a Dan string on
+ * stdout. Returns non-zero if a line isn't a genome_id.
+ */
+int
+convert_stream (void)
+{
+    vector<array<genosect_t, N_Genes> > genomes (BATCH_GENOMES);
+    vector<char> out (BATCH_GENOMES * (Genome_Str_Len + 1));
+    string line;
+    size_t lineno = 0;
+    bool more = true;
+    while (more) {
+        size_t n = 0;
+        while (n < BATCH_GENOMES && (more = static_cast<bool>(getline (cin, line)))) {
+            ++lineno;
+            if (!id2genome (line.data(), line.size(), genomes[n])) {
+                cerr << "Line " << lineno << " is not a genome_id: " << line << endl;
+                return 1;
+            }
+            ++n;
+        }
+        genomes2chars (genomes.data(), n, out.data());
+        fwrite (out.data(), 1, n * (Genome_Str_Len + 1), stdout);
+    }
+    return 0;
+}
+
 int main (int argc, char** argv)
 {
     // Initialise masks
@@ -37,29 +70,29 @@ int main (int argc, char** argv)
 
     if (argc < 2) {
         LOG ("Usage: " << argv[0] << " 5039a9e4-abc.....");
+        LOG ("   or: " << argv[0] << " - < genome_ids.txt");
         return 1;
     }
 
     string s(argv[1]);
+    if (s == "-") {
+        return convert_stream();
+    }
 
+    // Ignore a trailing '-'
+    if (!s.empty() && s[s.size()-1] == '-') {
+        s.erase (s.size()-1);
+    }
     array<genosect_t, N_Genes> genome;
-    zero_genome(genome);
-
-    // Split s using the '-' character, then set genome with each one.
-    bool ignoreTrailingEmptyVal = true;
-    vector<string> vs = stringToVector (s, "-", ignoreTrailingEmptyVal);
-    unsigned int g = 0;
-    for (string gs : vs) {
-        stringstream ss;
-        ss << hex << gs;
-        ss >> genome[g];
-        g++;
+    if (!id2genome (s.data(), s.size(), genome)) {
+        LOG ("Not a genome_id with " << N_Genes << " genosects: " << s);
+        return 1;
     }
 
-    //show_genome(genome);
-
-    string stringis = genome2str (genome);
-    cout << stringis << endl;
+    char buf[Genome_Str_Len];
+    genome2chars (genome, buf);
+    cout.write (buf, Genome_Str_Len);
+    cout << endl;
 
     return 0;
 }
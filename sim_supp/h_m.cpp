@@ -1,23 +1,52 @@
 /*
  * Compute h(m) from the paper
+ *
+ * h(m) = (N-m)!(N-k)! / (N!(N-k-m)!) is a telescoping product,
+ *
+ *   h(m) = prod_{j=0}^{m-1} (N-k-j)/(N-j) = h(m-1) * (N-k-m+1)/(N-m+1),
+ *
+ * so by default it's computed as a running sum of logs (with Kahan
+ * summation), which takes constant time per entry and can't overflow.
+ * The exact, multiprecision computation is kept:
+ *
+ *   h_m nGenes exact      computes every entry exactly (as it used to)
+ *   h_m nGenes <frac>     computes in log space, then checks a fraction
+ *                         frac of the entries (chosen pseudo-randomly)
+ *                         against the exact value.
  */
 
 #include <iostream>
 #include <sstream>
+#include <string>
+#include <math.h>
 
 #include "lmp.h"
 #include "xmath.h"
-#include "primeswing.h"
+#include "combicache.h"
 
 using std::cout;
 using std::cerr;
 using std::endl;
 using std::stringstream;
+using std::string;
 
 #ifndef N_Genes
 # define N_Genes 5
 #endif
 
+// The largest relative difference between the log space and exact values that verification accepts
+#define H_M_TOLERANCE 1e-12L
+
+// Is the entry (k,m) one of the fraction frac which are verified?
+bool
+spot_check (ulong k, ulong m, double frac)
+{
+    unsigned long long int h = (unsigned long long int)k * 0x9e3779b97f4a7c15ULL + m;
+    h = (h ^ (h >> 31)) * 0xbf58476d1ce4e5b9ULL;
+    h ^= (h >> 29);
+    return (double)(h >> 11) / 9007199254740992.0 < frac;
+}
+
 int main(int argc, char** argv)
 {
     ulong nGenes = N_Genes;
@@ -26,82 +55,76 @@ int main(int argc, char** argv)
     }
     cerr << "nGenes: " << nGenes << endl;
 
+    bool exact = false;
+    double verify_frac = 0.0;
+    if (argc > 2) {
+        if (string(argv[2]) == "exact") {
+            exact = true;
+        } else {
+            verify_frac = atof(argv[2]);
+        }
+    }
+
     // Compute h(m) from the paper
     ulong N = nGenes * (1<<(nGenes-1));
     cerr << "N bits: " << N << endl;
 
-    Xint N_minus_k_fac;
-    Xint N_minus_m_fac;
-    Xint N_minus_k_minus_m_fac;
-    Xint N_fac;
     Xint num;
-    long double num_dbl = 0.0;
     Xint denom;
-    long double denom_dbl = 0.0;
-    Xint h_m;
-    long double h_m_dbl = 0.0;
-    Xint zero;
-
-    lmp::InitSetUi(N_minus_k_fac, 1);
-    lmp::InitSetUi(N_minus_m_fac, 1);
-    lmp::InitSetUi(N_minus_k_minus_m_fac, 1);
-    lmp::InitSetUi(N_fac, 1);
     lmp::InitSetUi(num, 1);
     lmp::InitSetUi(denom, 1);
-    lmp::InitSetUi(h_m, 1);
-    lmp::InitSetUi(zero, 0);
 
-    PrimeSwing::ParallelFactorial (N_fac, N);
+    // Each factorial is needed many times over, so they're memoized
+    CombiCache cc;
+
+    ulong n_checked = 0;
+    ulong n_failed = 0;
 
-    //cout << "# nGenes: " << nGenes << ", N=" << N << endl;
     cout << "k,m,h(m)" << endl;
     for (ulong k = 1; k<N; ++k) {
-        PrimeSwing::ParallelFactorial (N_minus_k_fac, (N-k));
+        // Running (Kahan) sum of log((N-k-j)/(N-j)) for j < m
+        long double lsum = 0.0L;
+        long double lcomp = 0.0L;
         // Compute up to 8 mutations away
         for (ulong m = 1; m <= N/2; ++m) {
             if (N < (k+m)) {
                 continue;
             }
-            PrimeSwing::ParallelFactorial (N_minus_m_fac, (N-m));
-            lmp::Mul(num, N_minus_m_fac, N_minus_k_fac);
-            PrimeSwing::ParallelFactorial (N_minus_k_minus_m_fac, (N-k-m));
-            lmp::Mul(denom, N_fac, N_minus_k_minus_m_fac);
-            if (lmp::Cmp (denom, zero) == 0) {
-                cerr << "denominator is zero!" << endl;
-                //cout << k << "," << m << ",NaN" << endl;
-            } else {
-                slong thecmp = lmp::Cmp (num, denom);
-                if (thecmp > 0) {
-                    lmp::Div(h_m, num, denom);
-                    cout << k << "," << m << "," << h_m << endl;
-                } else if (thecmp == 0) {
-                    cout << k << "," << m << ",1" << endl;
+            long double h_m_dbl = 0.0L;
+            bool check = !exact && verify_frac > 0.0 && spot_check (k, m, verify_frac);
+            if (!exact) {
+                long double y = log1pl (-(long double)k / (long double)(N-m+1)) - lcomp;
+                long double t = lsum + y;
+                lcomp = (t - lsum) - y;
+                lsum = t;
+                h_m_dbl = expl (lsum);
+            }
+            if (exact || check) {
+                lmp::Mul(num, cc.Factorial (N-m), cc.Factorial (N-k));
+                lmp::Mul(denom, cc.Factorial (N), cc.Factorial (N-k-m));
+                long double h_exact = CombiCache::Ratio (num, denom);
+                if (exact) {
+                    h_m_dbl = h_exact;
                 } else {
-                    // thecmp < 0, so need a floating point output.
-                    // This method fails for normal doubles
-                    denom_dbl = 0.0;
-                    stringstream ss;
-                    ss << denom;
-                    ss >> denom_dbl;
-                    //cerr << "denom_dbl " << denom_dbl << " and num_dbl: " << num_dbl << endl;
-                    stringstream ss2;
-                    ss2 << num;
-                    ss2 >> num_dbl;
-                    h_m_dbl = num_dbl/denom_dbl;
-                    cout << k << "," << m << "," << h_m_dbl << endl;
+                    ++n_checked;
+                    if (fabsl (h_m_dbl - h_exact) > H_M_TOLERANCE * h_exact) {
+                        cerr << "h(" << k << "," << m << "): log space " << h_m_dbl
+                             << " differs from exact " << h_exact << endl;
+                        ++n_failed;
+                    }
                 }
             }
+            cout << k << "," << m << "," << h_m_dbl << endl;
         }
     }
 
-    lmp::Clear(N_minus_k_fac);
-    lmp::Clear(N_minus_m_fac);
-    lmp::Clear(N_minus_k_minus_m_fac);
-    lmp::Clear(N_fac);
+    if (verify_frac > 0.0) {
+        cerr << "Verified " << n_checked << " entries against exact values; "
+             << n_failed << " differed" << endl;
+    }
+
     lmp::Clear(num);
     lmp::Clear(denom);
-    lmp::Clear(h_m);
-    lmp::Clear(zero);
 
-    return 0;
+    return n_failed > 0 ? 1 : 0;
 }
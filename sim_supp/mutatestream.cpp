@@ -48,9 +48,12 @@ int main (int argc, char** argv)
 
     // Holds the genome
     array<genosect_t, N_Genes> genome = selected_genome();
+    char buf[Genome_Str_Len + 1];
+    buf[Genome_Str_Len] = '\n';
     unsigned int i = 0;
     while (i++ < 100) {
-        cout << genome2str (genome) << endl;
+        genome2chars (genome, buf);
+        cout.write (buf, Genome_Str_Len + 1);
         evolve_genome (genome);
     }
 
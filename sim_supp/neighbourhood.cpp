@@ -0,0 +1,95 @@
+/*
+ * Evaluate the fitness of every genome a given Hamming distance away
+ * from a genome supplied on the command line (in "Dan string format",
+ * as for showfitness). The fitnesses are written to a file of raw
+ * doubles, in the order of neighbourhood_sweep().
+ *
+ * Author: S James
+ * Date: October 2026.
+ */
+
+#include <iostream>
+#include <vector>
+#include <set>
+#include <stdlib.h>
+#include <sstream>
+#include <fstream>
+#include <string>
+#include <sys/types.h>
+#include <unistd.h>
+
+using namespace std;
+
+// Choose debugging level.
+//
+#define DEBUG 1
+// #define DEBUG2 1
+
+// Number of genes in a state is set at compile time.
+#ifndef N_Genes
+# define N_Genes 5
+#endif
+
+// Common code
+#include "lib.h"
+
+// The fitness function used here
+#include "fitness.h"
+#include "neighbourhood.h"
+
+int main (int argc, char** argv)
+{
+    if (argc < 3) {
+        cerr << "Write the fitness (" << FF_NAME << ") of every genome a Hamming distance h" << endl
+             << "away from a genome into a binary file of doubles." << endl << endl
+             << "Usage: " << argv[0] << " 0110100101..... h [outfile]" << endl;
+        return 1;
+    }
+
+    // Initialise masks
+    masks_init();
+
+    string s(argv[1]);
+    unsigned int l_genome = N_Genes * (1 << N_Ins);
+    if (s.length() != l_genome) {
+        cerr << "Genome string does not have " << l_genome << " bit chars as required." << endl;
+        return 1;
+    }
+    array<genosect_t, N_Genes> genome = str2genome (s);
+    unsigned int h = atoi (argv[2]);
+
+    string path("");
+    if (argc > 3) {
+        path = string(argv[3]);
+    } else {
+        stringstream pathss;
+        pathss << "data/neighbourhood_" << FF_NAME << "_n" << N_Genes << "_h" << h << "_"
+               << genome_id(genome) << ".bin";
+        path = pathss.str();
+    }
+
+    vector<double> f;
+    try {
+        f = neighbourhood_sweep (genome, h);
+    } catch (const exception& e) {
+        cerr << "Error: " << e.what() << endl;
+        return 1;
+    }
+
+    ofstream fout;
+    fout.open (path.c_str(), ios::out|ios::trunc|ios::binary);
+    if (!fout.is_open()) {
+        cerr << "Failed to open " << path << " for writing." << endl;
+        return 1;
+    }
+    fout.write (reinterpret_cast<const char*>(&f[0]), f.size() * sizeof(double));
+    fout.close();
+
+    unsigned int numfit = 0;
+    for (size_t i = 0; i < f.size(); ++i) {
+        if (f[i] > 0.0) { ++numfit; }
+    }
+    LOG ("Wrote " << f.size() << " fitnesses (" << numfit << " non-zero) to " << path);
+
+    return 0;
+}
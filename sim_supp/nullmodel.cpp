@@ -1,6 +1,19 @@
 /*
  * Randomly generate genomes, measuring fitness each time.
  *
+ * The times between genomes with F=1 are written to
+ * data/null_<ff>_<N_Generations>_gens_<pOn>.csv, and a summary of the
+ * fitnesses and of those times (see stream_stats.h) to the .json file
+ * of the same name. The generations are shared between threads, each
+ * with its own RNG stream and its own shard of the summary.
+ *
+ * The _withf version (RECORD_ALL_FITNESS) runs in one thread and
+ * summarises the fitness of the genomes by number of basins, mean
+ * limit cycle length and max limit cycle length (as histograms), and
+ * by block of Null_Block_Gens generations, writing
+ * data/null_withf_a<ant>_p<pos>_<ff>_<N_Generations>_fitness_<pOn>.json
+ * for plot_null_stats.py.
+ *
  * Author: S James
  * Date: October 2018.
  */
@@ -14,6 +27,9 @@
 #include <stdlib.h>
 #include <sys/types.h>
 #include <unistd.h>
+#ifdef _OPENMP
+# include <omp.h>
+#endif
 
 using namespace std;
 
@@ -45,6 +61,15 @@ using namespace std;
 // The fitness function used here
 #include "fitness.h"
 
+#include "stream_stats.h"
+
+#ifdef RECORD_ALL_FITNESS
+//! The number of generations summarised in each block
+# define Null_Block_Gens 10000
+//! Keys for the histograms by number of basins and limit cycle lengths: 0 to 2^N_Genes
+# define Null_Keys ((1 << N_Genes) + 1)
+#endif
+
 // Perform a loop N_Generations long during which an initially
 // randomly selected genome is evolved until a maximally fit state is
 // achieved.
@@ -63,108 +88,165 @@ int main (int argc, char** argv)
 
     // generations records the relative number of generations required
     // to achieve fitness 1.
-    vector<unsigned int> generations;
-
-#ifdef RECORD_ALL_FITNESS
-    // Records the evolution of the fitness of a genome. Fig 3. The
-    // (abs) generation for each fitness is recorded along with the
-    // floating point fitness value. Record this in a vector of
-    // vectors, with one vector for each evolution towards F=1
-    vector<vector<NetInfo> > netinfo;
-    vector<NetInfo> ni0;
-    netinfo.push_back (ni0);
-#endif
-
-    // Holds the drifting genome
-    array<genosect_t, N_Genes> genome;
+    vector<unsigned long long int> generations;
+    // Summaries of the fitnesses and of the generations to F=1
+    StreamStats fitnesses;
+    StreamStats gen_stats (0, 10);
 
-    unsigned int lastgen = 0;
-    double f = 0.0;
 #ifdef RECORD_ALL_FITNESS
-    double lastf = 0.0;
+    // Histograms of fitness by number of basins, mean limit cycle
+    // length and max limit cycle length, and a summary of each block
+    // of Null_Block_Gens generations.
+    KeyedHistogram by_basins (Null_Keys);
+    KeyedHistogram by_meanlim (Null_Keys);
+    KeyedHistogram by_maxlim (Null_Keys);
+    vector<StreamStats> blocks;
     AllBasins ab1;
-#endif
+    array<genosect_t, N_Genes> genome;
+    unsigned long long int lastgen = 0;
 
     // The main loop. Repeatedly generate a random genome point,
     // recording the number of genomes generated every time a
     // maximally fit state of 1 is happened upon.
-    for (unsigned int gen = 0; gen < N_Generations; ++gen) {
+    for (unsigned long long int gen = 0; gen < N_Generations; ++gen) {
 
         random_genome (genome);
-        f = evaluate_fitness (genome);
+        double f = evaluate_fitness (genome);
         DBG2 ("Fitness f = " << f);
 
-#ifdef RECORD_ALL_FITNESS
+        fitnesses.add (f);
         ab1.update (genome);
-        NetInfo ni(ab1, gen, f);
-        ni.deltaF = f - lastf;
-        netinfo.back().push_back (ni);
-#endif
+        by_basins.add (ab1.getNumBasins(), f);
+        by_meanlim.add ((unsigned int)ab1.meanAttractorLength(), f);
+        by_maxlim.add (ab1.maxAttractorLength(), f);
+        if (gen % Null_Block_Gens == 0) {
+            blocks.push_back (StreamStats());
+        }
+        blocks.back().add (f);
 
-        // Test fitness to determine whether we should evolve.
         if (f == 1.0) {
             DBG ("Fitness max. F=" << f);
-            // Record data
             generations.push_back (gen-lastgen);
+            gen_stats.add ((double)(gen-lastgen));
             lastgen = gen;
-
-#ifdef RECORD_ALL_FITNESS
-            if (gen < N_Generations) {
-                vector<NetInfo> vni;
-                netinfo.push_back (vni);
+        }
+    }
+#else
+# ifdef _OPENMP
+    unsigned int nthreads = omp_get_max_threads();
+# else
+    unsigned int nthreads = 1;
+# endif
+    vector<RngData> rds;
+    rngDataInitStreams (rds, nthreads);
+    vector<StreamStats> fit_shards (nthreads);
+    vector<StreamStats> gen_shards (nthreads, StreamStats (0, 10));
+    vector<vector<unsigned long long int> > gen_lists (nthreads);
+
+    // Each thread takes a contiguous range of generations, recording
+    // the number of genomes generated every time a maximally fit state
+    // of 1 is happened upon.
+#pragma omp parallel num_threads(nthreads)
+    {
+# ifdef _OPENMP
+        unsigned int t = omp_get_thread_num();
+# else
+        unsigned int t = 0;
+# endif
+        // The genomes are evaluated in blocks of Genome_Block_Len generations
+        array<genosect_t, N_Genes> genome;
+        GenomeBlock<Genome_Block_Len> block;
+        double f[Genome_Block_Len];
+        bool first = true;
+        unsigned long long int lastgen = 0;
+#pragma omp for schedule(static)
+        for (long long int gen0 = 0; gen0 < (long long int)N_Generations; gen0 += Genome_Block_Len) {
+            if (first) {
+                lastgen = gen0;
+                first = false;
+            }
+            unsigned int nl = Genome_Block_Len;
+            if ((long long int)N_Generations - gen0 < Genome_Block_Len) {
+                nl = (unsigned int)((long long int)N_Generations - gen0);
+            }
+            for (unsigned int l = 0; l < nl; ++l) {
+                random_genome (genome, &rds[t]);
+                block.set (l, genome);
+            }
+            evaluate_fitness_batch (block, f);
+            for (unsigned int l = 0; l < nl; ++l) {
+                unsigned long long int gen = gen0 + l;
+                fit_shards[t].add (f[l]);
+                if (f[l] == 1.0) {
+                    gen_lists[t].push_back (gen-lastgen);
+                    gen_shards[t].add ((double)(gen-lastgen));
+                    lastgen = gen;
+                }
             }
-            lastf = 0.0;
-#endif
-#ifdef RECORD_ALL_FITNESS
-        } else {
-            lastf = f;
-#endif
         }
     }
+    for (unsigned int t = 0; t < nthreads; ++t) {
+        fitnesses.merge (fit_shards[t]);
+        gen_stats.merge (gen_shards[t]);
+        generations.insert (generations.end(), gen_lists[t].begin(), gen_lists[t].end());
+    }
+#endif
 
     LOG ("Generations size: " << generations.size());
 
     // Save data to file. These data files can be graphed using the python scripts.
     ofstream fout;
     stringstream pathss;
-    pathss << "./data/null_" << FF_NAME << "_" << N_Generations << "_gens_" << pOn << ".csv";
-    fout.open (pathss.str().c_str());
+    pathss << "./data/null_" << FF_NAME << "_" << N_Generations << "_gens_" << pOn;
+    fout.open ((pathss.str() + ".csv").c_str());
     if (!fout.is_open()) {
-        cerr << "Error opening " << pathss.str() << endl;
+        cerr << "Error opening " << pathss.str() << ".csv" << endl;
         return 1;
     }
     for (unsigned int i = 0; i < generations.size(); ++i) {
-        fout << generations[i] << endl;
+        fout << generations[i] << "\n";
     }
     fout.close();
 
+    fout.open ((pathss.str() + ".json").c_str());
+    if (!fout.is_open()) {
+        cerr << "Error opening " << pathss.str() << ".json" << endl;
+        return 1;
+    }
+    fout.precision (10);
+    fout << "{\"ff\":\"" << FF_NAME << "\",\"n_genes\":" << N_Genes << ",\"fitness\":";
+    fitnesses.write_json (fout);
+    fout << ",\n\"generations\":";
+    gen_stats.write_json (fout);
+    fout << "}" << endl;
+    fout.close();
+
 #ifdef RECORD_ALL_FITNESS
     // Open file
     stringstream pathss2;
     pathss2 << "./data/null_withf_";
     pathss2 << "a" << (unsigned int)target_ant << "_p" << (unsigned int)target_pos << "_";
-    pathss2 << FF_NAME << "_" << N_Generations <<  "_fitness_" << pOn << ".csv";
+    pathss2 << FF_NAME << "_" << N_Generations <<  "_fitness_" << pOn << ".json";
     fout.open (pathss2.str().c_str());
     if (!fout.is_open()) {
         cerr << "Error opening " << pathss2.str() << endl;
         return 1;
     }
-    for (unsigned int i = 0; i < netinfo.size(); ++i) {
-        if (!netinfo[i].empty()) {
-            // Now the actual data.
-            for (unsigned int j = 0; j < netinfo[i].size(); ++j) {
-                // New genome:
-                fout << static_cast<int>(netinfo[i][j].generation) << "," << netinfo[i][j].fitness;
-                fout << "," << genome2str(netinfo[i][j].ab.genome);
-                fout << "," << netinfo[i][j].ab.getNumBasins();
-                fout << "," << netinfo[i][j].ab.meanAttractorLength();
-                fout << "," << netinfo[i][j].ab.maxAttractorLength();
-                fout << "," << netinfo[i][j].numChangedTransitions;
-                fout << "," << netinfo[i][j].deltaF;
-                fout << endl;
-            }
-        }
+    fout.precision (10);
+    fout << "{\"ff\":\"" << FF_NAME << "\",\"n_genes\":" << N_Genes
+         << ",\"linear_bins\":" << Stats_Linear_Bins << ",\"block_gens\":" << Null_Block_Gens;
+    fout << ",\n\"by_num_basins\":";
+    by_basins.write_json (fout);
+    fout << ",\n\"by_mean_limit_cycle\":";
+    by_meanlim.write_json (fout);
+    fout << ",\n\"by_max_limit_cycle\":";
+    by_maxlim.write_json (fout);
+    fout << ",\n\"blocks\":[";
+    for (unsigned int i = 0; i < blocks.size(); ++i) {
+        fout << (i ? ",\n" : "");
+        blocks[i].write_json (fout);
     }
+    fout << "]}" << endl;
     fout.close();
 #endif
 
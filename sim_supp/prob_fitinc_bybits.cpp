@@ -1,8 +1,12 @@
 /*
  * Take N_Starts randomly generated, but f>0 genomes. Mutate each one
  * N_Generations times. Determine the probability distribution of
- * mutating to a fitter genome. A value of pOn is provided on the
- * command line.
+ * mutating to a fitter genome. The number of bits to flip in each
+ * mutation is provided on the command line.
+ *
+ * The starts are shared between threads (see mutant_outcome.h), so
+ * N_Starts can be given on the command line too, and can be as large
+ * as memory allows.
  *
  * Author: S James
  * Date: November 2018.
@@ -47,6 +51,8 @@ using namespace std;
 // The fitness function used here
 #include "fitness.h"
 
+#include "mutant_outcome.h"
+
 // Perform a loop N_Generations long during which an initially
 // randomly selected genome is evolved until a maximally fit state is
 // achieved.
@@ -66,74 +72,35 @@ int main (int argc, char** argv)
     // Set pOn using the command line.
     if (argc < 2) {
         cerr << "Examines the statistics of the probability of evolving to" << endl
-             << "a higher fitness genome for " << N_Starts << " starting genomes." << endl
+             << "a higher fitness genome for nstarts (default " << N_Starts << ") starting genomes." << endl
              << "Uses the fitness function " << FF_NAME << " and a number of bits to flip " << endl
              << "(flipbits) which must be supplied." << endl << endl
-             << "Usage: " << argv[0] << " flipbits" << endl;
+             << "Usage: " << argv[0] << " flipbits [nstarts]" << endl;
         return 1;
     }
     unsigned int flipbits = (unsigned int) atoi (argv[1]);
 
-    // Holds the starting genomes
-    array<array<genosect_t, N_Genes>, N_Starts> genomes;
-
-    // For each starting genome, record the number that evolved to a
-    // fitter genome and also the number than evolve to an equally fit
-    // genome.
-    array<unsigned int, N_Starts> numFitter;
-    array<unsigned int, N_Starts> numEqual;
-    // Store the fitnesses of all the starting genomes
-    array<double, N_Starts> initialFitness;
-    // Explicitly init to 0
-    for (unsigned int g = 0; g < N_Starts; ++g) {
-        numFitter[g] = 0;
-        numEqual[g] = 0;
-        initialFitness[g] = 0.0;
+    unsigned long long int nstarts = N_Starts;
+    if (argc > 2) {
+        nstarts = strtoull (argv[2], (char**)0, 10);
     }
 
-    // Initialise genomes
-    for (unsigned int g = 0; g < N_Starts; ++g) {
-        while (initialFitness[g] == 0.0) {
-            random_genome (genomes[g]);
-            initialFitness[g] = evaluate_fitness (genomes[g]);
-        }
-    }
+    // Holds the starting genomes and, for each, the number that
+    // evolved to a fitter genome and also the number than evolve to an
+    // equally fit genome.
+    MutantOutcomeSampler sampler (nstarts, N_Generations);
+    sampler.init_starts();
 
     // Experiment with the probability of evolving fitter
-    for (unsigned int g = 0; g < N_Starts; ++g) {
-        if (g % 100 == 0) {
-            LOG ("[flipbits=" << flipbits << "] Processing genome starting point number " << g << "/" << N_Starts);
-        }
-        for (unsigned int e = 0; e < N_Generations; ++e) {
-            array<genosect_t, N_Genes> testg;
-            copy_genome (genomes[g], testg);
-            evolve_genome (testg, flipbits);
-            double newf = evaluate_fitness (testg);
-            if (newf > initialFitness[g]) {
-                // Fitness increased
-                ++numFitter[g];
-            } else if (newf == initialFitness[g]) {
-                ++numEqual[g];
-            } // else new fitness is lower than initial fitness
-        }
-    }
+    sampler.run ([flipbits](array<genosect_t, N_Genes>& g, RngData* trd) { evolve_genome (g, flipbits, trd); });
 
     cout << "Collected data; writing out..." << endl;
-    ofstream fout;
     stringstream path;
     path << "data/prob_fitinc_" << N_Generations << "_evolutions_flipbits_" << flipbits << "_" << FF_NAME << ".csv";
-    fout.open (path.str().c_str(), ios::out|ios::trunc);
-    if (!fout.is_open()) {
+    if (!sampler.write (path.str())) {
         cerr << "Failed to open " << path.str() << " for writing." << endl;
         return 1;
     }
 
-    fout << "GenomeID,Fitness,NumberEvolvingFitter,NumberEvolvingEqual,NumberEvolvingLessFit" << endl;
-    for (unsigned int g = 0; g < N_Starts; ++g) {
-        fout << genome_id(genomes[g]) << "," << initialFitness[g] << "," << numFitter[g] << "," << numEqual[g]  << "," << (N_Generations-(numFitter[g]+numEqual[g])) << endl;
-    }
-
-    fout.close();
-
     return 0;
 }
@@ -15,7 +15,6 @@
 #include <string>
 #include <sys/types.h>
 #include <unistd.h>
-#include "quine.h"
 
 using namespace std;
 
@@ -32,6 +31,8 @@ using namespace std;
 
 // Common code
 #include "lib.h"
+#include "functables.h"
+#include "genome_archive.h"
 
 #include "fitness.h"
 
@@ -53,33 +54,52 @@ int main (int argc, char** argv)
     // Initialise masks
     masks_init();
 
-    if (argc > 2) {
+    // Tabulated (or cached) complexity and canalysingness of each genosect
+    functables.init (FunctionTables::defaultPath());
+
+    if (argc > 3) {
         LOG ("Usage: " << argv[0] << " 0110100101..... (or omit string to show a random genome)");
+        LOG ("   or: " << argv[0] << " genomes.bng index (to show a genome from an archive)");
         return 1;
     }
 
-    string s("");
-    if (argc == 2) {
-        string s1(argv[1]);
-        s = s1;
-
-        unsigned int l = s.length();
-        unsigned int l_genosect = 1 << N_Ins;
-        unsigned int l_genome = N_Genes * l_genosect;
-        if (l == l_genome) {
-            LOG ("String has " << l_genome << " bit chars as required...");
-        } else {
-            LOG ("String does not have " << l_genome << " bit chars as required. Exiting.");
+    array<genosect_t, N_Genes> g;
+    if (argc == 3) {
+        try {
+            GenomeArchiveReader archive (argv[1]);
+            size_t idx = strtoul (argv[2], 0, 10);
+            if (idx >= archive.size()) {
+                LOG ("The archive holds " << archive.size() << " genomes. Exiting.");
+                return 1;
+            }
+            archive.get (idx, g);
+        } catch (const exception& e) {
+            LOG (e.what());
             return 1;
         }
     } else {
-        array<genosect_t, N_Genes> g1;
-        random_genome(g1);
-        s = genome2str (g1);
+        string s("");
+        if (argc == 2) {
+            string s1(argv[1]);
+            s = s1;
+
+            unsigned int l = s.length();
+            unsigned int l_genosect = 1 << N_Ins;
+            unsigned int l_genome = N_Genes * l_genosect;
+            if (l == l_genome) {
+                LOG ("String has " << l_genome << " bit chars as required...");
+            } else {
+                LOG ("String does not have " << l_genome << " bit chars as required. Exiting.");
+                return 1;
+            }
+        } else {
+            array<genosect_t, N_Genes> g1;
+            random_genome(g1);
+            s = genome2str (g1);
+        }
+        g = str2genome (s);
     }
 
-    array<genosect_t, N_Genes> g = str2genome (s);
-
     show_genome (g);
 
     AllBasins ab1 (g);
@@ -104,14 +124,7 @@ int main (int argc, char** argv)
 
     double cmplx = 0.0;
     for (unsigned int i = 0; i < N_Genes; ++i) {
-        Quine Q(N_Genes);
-        for (unsigned int j = 0; j<(1<<N_Genes); ++j) {
-            if ((g[i]>>j)&0x1) {
-                Q.addMinterm(j);
-            }
-        }
-        Q.go();
-        cmplx += Q.complexity();
+        cmplx += functables.complexity (g[i]);
     }
     cout << "Mean complexity: " << (cmplx/(double)N_Genes) << "/" << (1<<N_Genes) << endl;
 
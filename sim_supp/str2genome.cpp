@@ -1,12 +1,14 @@
 /*
  * Tests the "genome in Dan string format" conversion; outputs in
- * aaaa-bbbb-ccc... format.
+ * aaaa-bbbb-ccc... format. Given "-" as its argument, converts one Dan
+ * string per line from stdin to stdout.
  *
  * Author: S James
  * Date: October 2018.
  */
 
 #include <iostream>
+#include <cstdio>
 #include <vector>
 #include <set>
 #include <stdlib.h>
@@ -29,6 +31,37 @@ using namespace std;
 // Common code
 #include "lib.h"
 
+// The number of genomes converted at a time when reading stdin
+#define BATCH_GENOMES 65536
+
+/*!
+ * Convert a Dan string on each line of stdin to a genome_id on
+ * stdout. Returns non-zero if a line isn't a Dan string.
+ */
+int
+convert_stream (void)
+{
+    vector<array<genosect_t, N_Genes> > genomes (BATCH_GENOMES);
+    vector<char> out (BATCH_GENOMES * Genome_Id_Maxlen);
+    string line;
+    size_t lineno = 0;
+    bool more = true;
+    while (more) {
+        size_t n = 0;
+        while (n < BATCH_GENOMES && (more = static_cast<bool>(getline (cin, line)))) {
+            ++lineno;
+            if (line.size() != Genome_Str_Len || !chars2genome (line.data(), genomes[n])) {
+                cerr << "Line " << lineno << " is not a " << Genome_Str_Len << " bit Dan string: " << line << endl;
+                return 1;
+            }
+            ++n;
+        }
+        size_t len = genomes2ids (genomes.data(), n, out.data());
+        fwrite (out.data(), 1, len, stdout);
+    }
+    return 0;
+}
+
 int main (int argc, char** argv)
 {
     // Initialise masks
@@ -36,24 +69,32 @@ int main (int argc, char** argv)
 
     if (argc < 2) {
         LOG ("Usage: " << argv[0] << " 0110100101.....");
+        LOG ("   or: " << argv[0] << " - < dan_strings.txt");
         return 1;
     }
 
     string s(argv[1]);
+    if (s == "-") {
+        return convert_stream();
+    }
 
     unsigned int l = s.length();
-    unsigned int l_genosect = 1 << N_Ins;
-    unsigned int l_genome = N_Genes * l_genosect;
-    if (l == l_genome) {
-        DBG ("String has " << l_genome << " bit chars as required...");
+    if (l == Genome_Str_Len) {
+        DBG ("String has " << Genome_Str_Len << " bit chars as required...");
     } else {
-        LOG ("String does not have " << l_genome << " bit chars as required. Exiting.");
+        LOG ("String does not have " << Genome_Str_Len << " bit chars as required. Exiting.");
         return 1;
     }
 
-    array<genosect_t, N_Genes> g = str2genome (s);
+    array<genosect_t, N_Genes> g;
+    if (!chars2genome (s.data(), g)) {
+        LOG ("String has chars other than 1 and 0. Exiting.");
+        return 1;
+    }
 
-    cout << genome_id (g) << endl;
+    char buf[Genome_Id_Maxlen];
+    genome2id (g, buf);
+    cout << buf << endl;
 
     return 0;
 }
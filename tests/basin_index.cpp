@@ -0,0 +1,82 @@
+/*
+ * Tests AllBasins' state to basin index, find(), basinIndex() and
+ * sameAttractor(), and shared_termination(), against the basins of
+ * attraction themselves, for random genomes.
+ */
+
+#include <iostream>
+#include <vector>
+#include <set>
+#include <array>
+
+using namespace std;
+
+#ifndef N_Genes
+# define N_Genes 5
+#endif
+
+#include "lib.h"
+#include "fitness.h"
+#include "basins.h"
+
+int main()
+{
+    int rtn = 0;
+    masks_init();
+    rngDataInit (&rd);
+    zigset (&rd, DUMMYARG);
+    rd.seed = 4;
+
+    const unsigned int nstates = 1 << N_Genes;
+    unsigned int nshared = 0;
+    for (unsigned int n = 0; n < 2000 && rtn == 0; ++n) {
+        array<genosect_t, N_Genes> genome;
+        random_genome (genome, &rd);
+        AllBasins ab (genome);
+        state_t succ[1 << N_Genes];
+        for (unsigned int s = 0; s < nstates; ++s) {
+            state_t st = (state_t)s;
+            compute_next (genome, st);
+            succ[s] = st;
+        }
+
+        for (unsigned int s = 0; s < nstates && rtn == 0; ++s) {
+            const BasinOfAttraction& b = ab.find ((state_t)s);
+            int bi = ab.basinIndex ((state_t)s);
+            if (bi < 0 || &b != &ab.basins[bi] || b.nodes.count ((state_t)s) == 0) {
+                cout << "find(" << s << ") didn't give the basin containing it" << endl;
+                rtn = -1;
+            }
+        }
+
+        // Compare every pair of states with the limit cycles of their basins
+        for (unsigned int a = 0; a < nstates && rtn == 0; ++a) {
+            for (unsigned int c = 0; c < nstates; ++c) {
+                bool same = ab.find ((state_t)a).limitCycle == ab.find ((state_t)c).limitCycle;
+                bool st = shared_termination (genome, (state_t)a, (state_t)c);
+                if (ab.sameAttractor ((state_t)a, (state_t)c) != same
+                    || st != same || shared_termination_table (succ, (state_t)a, (state_t)c) != same) {
+                    cout << "States " << a << " and " << c << ": same attractor " << same
+                         << " but sameAttractor " << ab.sameAttractor ((state_t)a, (state_t)c)
+                         << ", shared_termination " << st << endl;
+                    rtn = -1;
+                    break;
+                }
+            }
+        }
+        if (shared_termination (genome, initial_ant, initial_pos)) { ++nshared; }
+    }
+
+    // An AllBasins with no genome has no basins
+    AllBasins empty;
+    if (empty.find (0).endpoint != ENDPOINT_UNKNOWN || empty.basinIndex (0) != -1 || empty.sameAttractor (0, 0)) {
+        cout << "An empty AllBasins found a basin" << endl;
+        rtn = -1;
+    }
+
+    if (rtn == 0) {
+        cout << "Basin index and shared terminations agree with the basins (" << nshared
+             << " of 2000 genomes had shared terminations)" << endl;
+    }
+    return rtn;
+}
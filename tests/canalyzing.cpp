@@ -0,0 +1,191 @@
+/*
+ * Tests the word-parallel isCanalyzing() against the original
+ * implementation, which tested the truth table a row at a time, and
+ * checks isCanalyzing_batch(), canalyzingness_batch() and
+ * canalyzingDepth(). For N_Ins <= 4 every genosect is tested; for
+ * larger N_Ins, random genosects are.
+ *
+ * Author: S James
+ * Date: October 2026.
+ */
+
+#include <iostream>
+#include <array>
+#include <vector>
+#include <bitset>
+
+using namespace std;
+
+// Number of genes in a state is set at compile time.
+#ifndef N_Genes
+# define N_Genes 4
+#endif
+
+// Common code
+#include "lib.h"
+
+/*!
+ * The original isCanalyzing(), from before it was rewritten with cofactor masks, except that it
+ * used to clear every bit of acanal_unset (with "acanal_unset.reset(i) = false"), and so it lost
+ * the inputs for which the function was canalysing when 0 whenever a later input wasn't.
+ */
+unsigned int
+isCanalyzing_rowwise (const genosect_t& gs)
+{
+    bitset<N_Ins> acanal_set;
+    bitset<N_Ins> acanal_unset;
+    array<int, N_Ins> setbitivalue;
+    array<int, N_Ins> unsetbitivalue;
+    unsigned int canal = 0;
+
+    for (unsigned int i = 0; i < N_Ins; ++i) {
+        acanal_set[i] = false;
+        acanal_unset[i] = false;
+        setbitivalue[i] = -1;
+        unsetbitivalue[i] = -1;
+    }
+
+    for (unsigned int i = 0; i < N_Ins; ++i) {
+
+        acanal_set.set(i);
+        acanal_unset.set(i);
+
+        for (unsigned int j = 0; j < (0x1 << N_Ins); ++j) {
+
+            if ((j & (1UL<<i)) == (1UL<<i)) {
+                if (setbitivalue[i] == -1) {
+                    setbitivalue[i] = (int)(1UL&(gs>>j));
+                } else {
+                    if (setbitivalue[i] != (int)(1UL&(gs>>j))) {
+                        acanal_set.reset(i);
+                    }
+                }
+            } else {
+                if (unsetbitivalue[i] == -1) {
+                    unsetbitivalue[i] = (int)(1UL&(gs>>j));
+                } else {
+                    if (unsetbitivalue[i] != (int)(1UL&(gs>>j))) {
+                        acanal_unset.reset(i);
+                    }
+                }
+            }
+        }
+    }
+
+    for (unsigned int i = 0; i < N_Ins; ++i) {
+        if (acanal_set.test(i) == true) {
+            canal++;
+        }
+        if (acanal_unset.test(i) == true) {
+            canal++;
+        }
+    }
+
+    return canal;
+}
+
+//! A random genosect, filling all 1<<N_Ins bits
+genosect_t
+random_genosect (void)
+{
+    unsigned long long int r = (static_cast<unsigned long long int>(SHR3((&rd))) << 32);
+    r |= static_cast<unsigned long long int>(SHR3((&rd)));
+    return static_cast<genosect_t>(r & Canal_Rows_Mask);
+}
+
+int main (int argc, char** argv)
+{
+    unsigned int seed = 11;
+    rngDataInit (&rd);
+    zigset (&rd, DUMMYARG);
+    rd.seed = seed;
+
+    masks_init();
+
+    int rtn = 0;
+
+    // Compare with the original, and fill a batch
+    vector<genosect_t> gs;
+#if N_Ins <= 4
+    for (unsigned int f = 0; f < (1U << (1 << N_Ins)); ++f) {
+        gs.push_back (static_cast<genosect_t>(f));
+    }
+#else
+    for (unsigned int f = 0; f < 100000; ++f) {
+        gs.push_back (random_genosect());
+    }
+    // Make sure there are some canalysing functions of each kind among them
+    for (unsigned int i = 0; i < N_Ins; ++i) {
+        gs.push_back (static_cast<genosect_t>(canal_input_masks[i] & Canal_Rows_Mask));
+        gs.push_back (static_cast<genosect_t>((canal_input_masks[i] | random_genosect()) & Canal_Rows_Mask));
+        gs.push_back (static_cast<genosect_t>(~canal_input_masks[i] & random_genosect() & Canal_Rows_Mask));
+    }
+#endif
+    vector<unsigned int> canal (gs.size());
+    isCanalyzing_batch (gs.data(), canal.data(), gs.size());
+    for (size_t k = 0; k < gs.size() && rtn == 0; ++k) {
+        unsigned int c = isCanalyzing_rowwise (gs[k]);
+        if (isCanalyzing (gs[k]) != c || canal[k] != c) {
+            cout << "isCanalyzing(0x" << hex << gs[k] << dec << ") gave " << isCanalyzing (gs[k])
+                 << " (batch: " << canal[k] << ") not " << c << endl;
+            rtn = -1;
+        }
+    }
+
+    // canalyzingness_batch() vs. canalyzingness()
+    vector<array<genosect_t, N_Genes> > genomes (1000);
+    for (size_t k = 0; k < genomes.size(); ++k) {
+        for (unsigned int i = 0; i < N_Genes; ++i) {
+            genomes[k][i] = (k % 2) ? gs[(k * N_Genes + i) % gs.size()] : random_genosect();
+        }
+    }
+    vector<unsigned int> gcanal (genomes.size());
+    canalyzingness_batch (genomes.data(), gcanal.data(), genomes.size());
+    for (size_t k = 0; k < genomes.size() && rtn == 0; ++k) {
+        if (gcanal[k] != canalyzingness (genomes[k])) {
+            cout << "canalyzingness_batch() differs from canalyzingness() for genome " << k << endl;
+            rtn = -1;
+        }
+    }
+
+    // Nested canalysing depth of some known functions
+    unsigned long long int all = Canal_Rows_Mask;
+    unsigned long long int x0 = canal_input_masks[0] & all;
+    unsigned long long int x1 = canal_input_masks[1] & all;
+    unsigned long long int x2 = canal_input_masks[2] & all;
+    unsigned long long int x3 = canal_input_masks[3] & all;
+    unsigned long long int conj = all, parity = 0;
+    for (unsigned int i = 0; i < N_Ins; ++i) {
+        conj &= canal_input_masks[i];
+        parity ^= canal_input_masks[i] & all;
+    }
+    struct { unsigned long long int f; unsigned int depth; } known[] = {
+        { 0ULL, 0 },                         // constant
+        { all, 0 },                          // constant
+        { x0, 1 },                           // one input
+        { conj, N_Ins },                     // AND of every input is nested canalysing
+        { parity, 0 },                       // XOR isn't canalysing at all
+        { x0 | (x1 & (x2 ^ x3)), 2 },        // two layers, then XOR
+        { (x0 & x1) | (~x0 & x2 & all), 0 }, // multiplexer; only x1 and x2 together canalyse
+    };
+    for (unsigned int k = 0; k < sizeof(known)/sizeof(known[0]); ++k) {
+        unsigned int d = canalyzingDepth (static_cast<genosect_t>(known[k].f));
+        if (d != known[k].depth) {
+            cout << "canalyzingDepth(0x" << hex << known[k].f << dec << ") gave " << d
+                 << " not " << known[k].depth << endl;
+            rtn = -1;
+        }
+    }
+
+    // The depth is non-zero exactly when the function is canalysing, except for constants
+    for (size_t k = 0; k < gs.size() && rtn == 0; ++k) {
+        unsigned long long int f = static_cast<unsigned long long int>(gs[k]);
+        bool constant = (f == 0ULL || f == all);
+        if (!constant && ((canalyzingDepth (gs[k]) > 0) != (isCanalyzing (gs[k]) > 0))) {
+            cout << "canalyzingDepth() and isCanalyzing() disagree for 0x" << hex << f << dec << endl;
+            rtn = -1;
+        }
+    }
+
+    return rtn;
+}
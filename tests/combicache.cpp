@@ -0,0 +1,132 @@
+/*
+ * Tests CombiCache against factorials and binomial coefficients
+ * computed directly with lmp, and its long double and log values.
+ *
+ * Author: S James
+ * Date: October 2026.
+ */
+
+#include <iostream>
+#include <sstream>
+#include <math.h>
+#include "lmp.h"
+#include "combicache.h"
+
+using namespace std;
+
+// The conversion compute_pnot0 used to use
+long double
+xint_to_double (mpz_srcptr xi)
+{
+    long double d;
+    std::stringstream ss;
+    char* str = mpz_get_str (NULL, 10, xi);
+    ss << str;
+    ss >> d;
+    free (str);
+    return d;
+}
+
+int main()
+{
+    int rtn = 0;
+    CombiCache cc;
+
+    Xint x;
+    lmp::Init (x);
+
+    // Factorials, out of order so that they are made in each of the ways
+    ulong facs[] = { 0, 1, 5, 100, 90, 700, 3000, 2999, 2000, 2001, 1 };
+    for (unsigned int i = 0; i < sizeof(facs)/sizeof(facs[0]); ++i) {
+        lmp::FacUi (x, facs[i]);
+        if (lmp::Cmp (x, cc.Factorial (facs[i])) != 0) {
+            cout << "Factorial(" << facs[i] << ") is wrong" << endl;
+            rtn = -1;
+        }
+        long double lf = CombiCache::LogFactorial (facs[i]);
+        long double lx = logl (CombiCache::ToLongDouble (x));
+        if (facs[i] < 1000 && fabsl (lf - lx) > 1e-12L * (1.0L + lx)) {
+            cout << "LogFactorial(" << facs[i] << ") = " << lf << " not " << lx << endl;
+            rtn = -1;
+        }
+    }
+
+    // Binomials, including their long double values, which must match the old stringstream conversion
+    ulong ns[] = { 4, 16, 64, 1024, 1UL<<20, 1UL<<25 };
+    for (unsigned int i = 0; i < sizeof(ns)/sizeof(ns[0]); ++i) {
+        for (ulong k = 0; k <= 70 && k <= ns[i] + 1; ++k) {
+            lmp::BinomialUiUi (x, ns[i], k);
+            if (k > ns[i]) { lmp::SetUi (x, 0); }
+            if (lmp::Cmp (x, cc.Binomial (ns[i], k)) != 0) {
+                cout << "Binomial(" << ns[i] << "," << k << ") is wrong" << endl;
+                rtn = -1;
+            }
+            if (cc.BinomialLD (ns[i], k) != xint_to_double (x)) {
+                cout << "BinomialLD(" << ns[i] << "," << k << ") = " << cc.BinomialLD (ns[i], k)
+                     << " not " << xint_to_double (x) << endl;
+                rtn = -1;
+            }
+            if (k <= ns[i]) {
+                long double lb = CombiCache::LogBinomial (ns[i], k);
+                long double lx = logl (xint_to_double (x));
+                if (fabsl (lb - lx) > 1e-9L * (1.0L + lx)) {
+                    cout << "LogBinomial(" << ns[i] << "," << k << ") = " << lb << " not " << lx << endl;
+                    rtn = -1;
+                }
+            }
+        }
+        // And from the top end
+        lmp::BinomialUiUi (x, ns[i], ns[i] - 1);
+        if (lmp::Cmp (x, cc.Binomial (ns[i], ns[i] - 1)) != 0) {
+            cout << "Binomial(" << ns[i] << "," << (ns[i] - 1) << ") is wrong" << endl;
+            rtn = -1;
+        }
+    }
+
+    // Rounding of values just above the long double precision
+    lmp::SetUi (x, 1);
+    lmp::Mul2Exp (x, x, 64);
+    for (ulong d = 0; d < 8; ++d) {
+        Xint y;
+        lmp::Init (y);
+        mpz_add_ui (y, x, d);
+        mpz_mul_2exp (y, y, 3);
+        mpz_add_ui (y, y, d);
+        if (CombiCache::ToLongDouble (y) != xint_to_double (y)) {
+            cout << "ToLongDouble() rounds 2^67+" << (d*9) << " wrongly" << endl;
+            rtn = -1;
+        }
+        lmp::Clear (y);
+    }
+
+    // h(m) from h_m, as a ratio of factorials and as a telescoping product in log space
+    ulong N = 80;
+    Xint num, den;
+    lmp::Init (num);
+    lmp::Init (den);
+    for (ulong k = 1; k < N; k += 7) {
+        long double lsum = 0.0L;
+        for (ulong m = 1; k + m <= N; ++m) {
+            lsum += log1pl (-(long double)k / (long double)(N-m+1));
+            lmp::Mul (num, cc.Factorial (N-m), cc.Factorial (N-k));
+            lmp::Mul (den, cc.Factorial (N), cc.Factorial (N-k-m));
+            long double r = CombiCache::Ratio (num, den);
+            long double h = expl (lsum);
+            if (fabsl (r - h) > 1e-12L * r) {
+                cout << "h(" << k << "," << m << ") = " << h << " in log space but " << r << " exactly" << endl;
+                rtn = -1;
+            }
+        }
+    }
+    lmp::SetUi (num, 1);
+    lmp::SetUi (den, 3);
+    if (fabsl (CombiCache::Ratio (num, den) - 1.0L/3.0L) > LDBL_EPSILON) {
+        cout << "Ratio(1,3) = " << CombiCache::Ratio (num, den) << endl;
+        rtn = -1;
+    }
+    lmp::Clear (num);
+    lmp::Clear (den);
+
+    lmp::Clear (x);
+    return rtn;
+}
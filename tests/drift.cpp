@@ -0,0 +1,139 @@
+/*
+ * Tests the drift engine in drift.h: that drift_mutate() flips each bit
+ * with probability p, that the hitting times found by drift_walkers()
+ * don't depend on the number of threads, and (for N_Genes=3, when
+ * p=0.5 makes each generation a fresh, uniformly random genome) that
+ * the mean hitting time is 2^24 / (the number of genomes with F=1).
+ */
+
+#include <iostream>
+#include <vector>
+#include <set>
+#include <algorithm>
+#include <math.h>
+
+using namespace std;
+
+#ifndef N_Genes
+# define N_Genes 3
+#endif
+
+#include "lib.h"
+#include "fitness.h"
+#include "drift.h"
+
+//! The number of bits in a genome
+#define L_Genome (N_Genes * Genosect_Width)
+
+//! Collects hitting times
+struct TimesSink
+{
+    void operator() (const vector<unsigned long long int>& t) { this->times.insert (this->times.end(), t.begin(), t.end()); }
+    vector<unsigned long long int> times;
+};
+
+//! Run nwalkers walkers from seed, returning the sorted hitting times
+vector<unsigned long long int>
+run_walkers (unsigned int seed, unsigned int nwalkers, double p, unsigned long long int gens)
+{
+    rd.seed = seed;
+    TimesSink sink;
+    drift_walkers (nwalkers, p, gens, sink);
+    sort (sink.times.begin(), sink.times.end());
+    return sink.times;
+}
+
+int main()
+{
+    int rtn = 0;
+    masks_init();
+    rngDataInit (&rd);
+    zigset (&rd, DUMMYARG);
+    rd.seed = 4;
+
+    // Each bit flips with probability p, independently of its position
+    const double ps[] = { 0.01, 0.1, 0.5, 0.9 };
+    for (unsigned int pi = 0; pi < sizeof(ps)/sizeof(ps[0]); ++pi) {
+        const double p = ps[pi];
+        const unsigned int ntrials = 20000;
+        vector<unsigned int> counts (L_Genome, 0);
+        unsigned long long int total = 0;
+        for (unsigned int n = 0; n < ntrials; ++n) {
+            array<genosect_t, N_Genes> g;
+            random_genome (g, &rd);
+            array<genosect_t, N_Genes> g0 = g;
+            unsigned int nf = drift_mutate (g, p, &rd);
+            unsigned int h = 0;
+            for (unsigned int b = 0; b < L_Genome; ++b) {
+                if (((g[b / Genosect_Width] ^ g0[b / Genosect_Width]) >> (b % Genosect_Width)) & 0x1) {
+                    ++counts[b];
+                    ++h;
+                }
+            }
+            if (h != nf) {
+                cout << "drift_mutate returned " << nf << " but flipped " << h << " bits" << endl;
+                rtn = -1;
+                break;
+            }
+            total += h;
+        }
+        // The total is binomial(ntrials * L_Genome, p)
+        double nbits = (double)ntrials * (double)L_Genome;
+        double sd = sqrt (nbits * p * (1.0 - p));
+        if (fabs ((double)total - nbits * p) > 5.0 * sd) {
+            cout << "p=" << p << ": mean flips " << (double)total/ntrials
+                 << ", expected " << p * L_Genome << endl;
+            rtn = -1;
+        }
+        double expected = (double)ntrials * p;
+        double chisq = 0.0;
+        for (unsigned int b = 0; b < L_Genome; ++b) {
+            double d = (double)counts[b] - expected;
+            chisq += d * d / (expected * (1.0 - p));
+        }
+        if (fabs (chisq - (double)L_Genome) > 5.0 * sqrt (2.0 * L_Genome)) {
+            cout << "p=" << p << ": positions are not flipped uniformly: chi squared " << chisq << endl;
+            rtn = -1;
+        }
+    }
+
+    // The hitting times for a seed don't depend on the number of threads
+    vector<unsigned long long int> t1, tn;
+#ifdef _OPENMP
+    int nthreads = omp_get_max_threads();
+    omp_set_num_threads (1);
+    t1 = run_walkers (17, 8, 0.5, 20000);
+    omp_set_num_threads (nthreads < 2 ? 4 : nthreads);
+    tn = run_walkers (17, 8, 0.5, 20000);
+    omp_set_num_threads (nthreads);
+#else
+    t1 = run_walkers (17, 8, 0.5, 20000);
+    tn = run_walkers (17, 8, 0.5, 20000);
+#endif
+    if (t1.empty() || t1 != tn) {
+        cout << "Hitting times differ between runs with 1 and several threads ("
+             << t1.size() << " and " << tn.size() << " hits)" << endl;
+        rtn = -1;
+    }
+
+#if N_Genes == 3 && !defined k_equals_n_minus_1 && defined USE_FITNESS_4
+    // 11384 of the 2^24 genomes have F=1 (found by enumeration). With p=0.5 the hitting time
+    // is geometric, mean 2^24/11384, and so also its standard deviation is about the mean.
+    const double mean_expected = 16777216.0 / 11384.0;
+    vector<unsigned long long int> th = run_walkers (5, 8, 0.5, 1000000);
+    double sum = 0.0;
+    for (size_t i = 0; i < th.size(); ++i) { sum += (double)th[i]; }
+    double mean = sum / (double)th.size();
+    double se = mean_expected / sqrt ((double)th.size());
+    if (th.size() < 1000 || fabs (mean - mean_expected) > 5.0 * se) {
+        cout << "Mean hitting time " << mean << " from " << th.size()
+             << " hits, expected " << mean_expected << endl;
+        rtn = -1;
+    }
+#endif
+
+    if (rtn == 0) {
+        cout << "Drift mutation and walkers are OK for a genome of " << L_Genome << " bits" << endl;
+    }
+    return rtn;
+}
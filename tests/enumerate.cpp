@@ -0,0 +1,88 @@
+/*
+ * Tests GenomeSpaceEnumerator against a serial, exhaustive loop over
+ * the genome space for N_Genes=3, k=n-1 (4096 genomes). Also checks
+ * that a search which is stopped and resumed from a checkpoint file
+ * gives the same result.
+ *
+ * Author: S James
+ * Date: October 2026.
+ */
+
+#include <iostream>
+#include <vector>
+#include <set>
+#include <stdlib.h>
+#include <sstream>
+#include <string>
+#include <cstdio>
+
+using namespace std;
+
+// Number of genes in a state is set at compile time.
+#define N_Genes 3
+#define k_equals_n_minus_1 1
+
+// Common code
+#include "lib.h"
+
+// The fitness function used here
+#include "fitness.h"
+#include "enumerate.h"
+
+int main (int argc, char** argv)
+{
+    // Initialise masks
+    masks_init();
+
+    int rtn = 0;
+
+    // Serial, exhaustive loop
+    unsigned long long int numfit = 0;
+    unsigned long long int numperfect = 0;
+    unsigned long long int numfit_and_canalysing = 0;
+    unsigned long long int l_genome = N_Genes * (1 << N_Ins);
+    for (unsigned long long int g = 0; g < (1ULL << l_genome); ++g) {
+        array<genosect_t, N_Genes> genome;
+        for (unsigned int i = 0; i < N_Genes; ++i) {
+            genome[i] = (g >> ((N_Genes-1-i) * (1 << N_Ins))) & ((1 << (1 << N_Ins)) - 1);
+        }
+        double f = evaluate_fitness (genome);
+        if (f > 0.0) {
+            ++numfit;
+            if (canalyzingness (genome)) { ++numfit_and_canalysing; }
+            if (f == 1.0) { ++numperfect; }
+        }
+    }
+    cout << "Serial: " << numfit << " fit, " << numperfect << " perfect" << endl;
+
+    // All in one go, with a chunk length that doesn't divide the space
+    GenomeSpaceEnumerator gse (100);
+    if (!gse.run() || gse.next != gse.size
+        || gse.numfit != numfit || gse.numperfect != numperfect
+        || gse.numfit_and_canalysing != numfit_and_canalysing) {
+        cout << "Enumerator: " << gse.numfit << " fit, " << gse.numperfect << " perfect" << endl;
+        rtn = 1;
+    }
+
+    // Stop part way through, then resume in another enumerator from the checkpoint
+    string cp("enumerate_checkpoint.txt");
+    remove (cp.c_str());
+    GenomeSpaceEnumerator gse1 (64);
+    if (gse1.run (cp, 1000) || gse1.next >= gse1.size) {
+        cout << "Enumerator didn't stop early" << endl;
+        rtn = 1;
+    }
+    GenomeSpaceEnumerator gse2 (64);
+    if (!gse2.loadCheckpoint (cp) || gse2.next != gse1.next) {
+        cout << "Failed to load checkpoint" << endl;
+        rtn = 1;
+    }
+    gse2.run (cp);
+    if (gse2.numfit != numfit || gse2.numperfect != numperfect) {
+        cout << "Resumed enumerator: " << gse2.numfit << " fit, " << gse2.numperfect << " perfect" << endl;
+        rtn = 1;
+    }
+    remove (cp.c_str());
+
+    return rtn;
+}
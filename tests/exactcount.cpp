@@ -0,0 +1,165 @@
+/*
+ * Tests the exact counting of fit genomes in exactcount.h. First,
+ * FunctionCounter::count() is compared with a brute force count over
+ * all the functions on 5 states, for every pair of sets A and B. Then
+ * exact_fitness_counts() and exact_fitness_histogram() are compared
+ * with an exhaustive evaluation of all 8^8 genomes for N_Genes=3.
+ *
+ * Author: S James
+ * Date: October 2026.
+ */
+
+#include <iostream>
+#include <vector>
+#include <set>
+#include <stdlib.h>
+#include <sstream>
+#include <string>
+#include <map>
+#include <math.h>
+
+using namespace std;
+
+// Number of genes in a state is set at compile time.
+#define N_Genes 3
+
+// Common code
+#include "lib.h"
+
+// The fitness function used here
+#include "fitness.h"
+#include "exactcount.h"
+
+/*!
+ * The set of states (as a bit mask) on the cycle reached from x under
+ * the function succ.
+ */
+unsigned int
+cycle_of (const vector<unsigned int>& succ, unsigned int x)
+{
+    unsigned int visited = 0;
+    while (!(visited & (1 << x))) {
+        visited |= (1 << x);
+        x = succ[x];
+    }
+    unsigned int cyc = 0;
+    while (!(cyc & (1 << x))) {
+        cyc |= (1 << x);
+        x = succ[x];
+    }
+    return cyc;
+}
+
+int main (int argc, char** argv)
+{
+    masks_init();
+
+    int rtn = 0;
+
+    // 1. Brute force on n states, starting states x=0 and y=1.
+    const unsigned int n = 5;
+    unsigned int nfuncs = 1;
+    for (unsigned int i = 0; i < n; ++i) { nfuncs *= n; }
+    vector<unsigned int> cx (nfuncs), cy (nfuncs);
+    vector<unsigned int> succ (n);
+    for (unsigned int fi = 0; fi < nfuncs; ++fi) {
+        unsigned int f = fi;
+        for (unsigned int s = 0; s < n; ++s) { succ[s] = f % n; f /= n; }
+        cx[fi] = cycle_of (succ, 0);
+        cy[fi] = cycle_of (succ, 1);
+    }
+
+    FunctionCounter fc (n);
+    Xint counted;
+    lmp::Init (counted);
+    unsigned int nbad = 0;
+    for (unsigned int A = 0; A < (1U << n); ++A) {
+        for (unsigned int B = 0; B < (1U << n); ++B) {
+            unsigned long int brute = 0;
+            for (unsigned int fi = 0; fi < nfuncs; ++fi) {
+                if ((cx[fi] & ~A) == 0 && (cy[fi] & ~B) == 0) { ++brute; }
+            }
+            unsigned int rest = ~0x3U;
+            unsigned int a = bitset<32>(A & rest).count();
+            unsigned int b = bitset<32>(B & rest).count();
+            unsigned int c = bitset<32>(A & B & rest).count();
+            fc.count (counted, a, b, c, A & 0x1, B & 0x1, A & 0x2, B & 0x2);
+            if (mpz_cmp_ui (counted, brute) != 0) {
+                if (nbad++ < 10) {
+                    cout << "A=" << A << " B=" << B << ": brute force " << brute
+                         << ", counted " << counted << endl;
+                }
+                rtn = 1;
+            }
+        }
+    }
+    lmp::Clear (counted);
+
+    // 2. Exhaustive evaluation of all 8^8 genomes for N_Genes=3, as transition tables.
+    unsigned long int numfit = 0;
+    unsigned long int numperfect = 0;
+    map<double, unsigned long int> brutehist;
+    const unsigned int ns = 1 << N_Genes;
+    state_t table[ns];
+    for (unsigned int s = 0; s < ns; ++s) { table[s] = 0; }
+    bool finished = false;
+    while (!finished) {
+        double f = evaluate_fitness_table (table);
+        if (f > 0.0) { ++numfit; }
+        if (f == 1.0) { ++numperfect; }
+        ++brutehist[f];
+        // Next table
+        unsigned int s = 0;
+        while (s < ns && ++table[s] == ns) { table[s++] = 0; }
+        finished = (s == ns);
+    }
+
+    Xint xnumfit, xnumperfect;
+    lmp::Init (xnumfit);
+    lmp::Init (xnumperfect);
+    exact_fitness_counts (xnumfit, xnumperfect);
+    cout << "Exhaustive: numfit " << numfit << ", numperfect " << numperfect << endl;
+    cout << "Exact count: numfit " << xnumfit << ", numperfect " << xnumperfect << endl;
+    if (mpz_cmp_ui (xnumfit, numfit) != 0 || mpz_cmp_ui (xnumperfect, numperfect) != 0) {
+        rtn = 1;
+    }
+    lmp::Clear (xnumfit);
+    lmp::Clear (xnumperfect);
+
+    // 3. The whole distribution of fitness values, for N_Genes=3. The
+    // exhaustive fitnesses are doubles, and the same value can come out
+    // differently rounded, so merge values which agree to within
+    // rounding and compare them in order of increasing fitness.
+    vector<pair<double, unsigned long int> > brute;
+    map<double, unsigned long int>::const_iterator bi;
+    for (bi = brutehist.begin(); bi != brutehist.end(); ++bi) {
+        if (!brute.empty() && fabs (bi->first - brute.back().first) < 1e-12) {
+            brute.back().second += bi->second;
+        } else {
+            brute.push_back (*bi);
+        }
+    }
+    FitnessHistogram hist;
+    exact_fitness_histogram (hist);
+    map<double, mpz_srcptr> exact;
+    map<pair<unsigned long long int, unsigned long long int>, __mpz_struct>::const_iterator hi;
+    for (hi = hist.counts.begin(); hi != hist.counts.end(); ++hi) {
+        exact[(double)hi->first.first / (double)hi->first.second] = &hi->second;
+    }
+    cout << "Exhaustive: " << brute.size() << " fitness values, exact count: "
+         << exact.size() << endl;
+    if (exact.size() != brute.size()) {
+        rtn = 1;
+    } else {
+        map<double, mpz_srcptr>::const_iterator ei = exact.begin();
+        for (unsigned int i = 0; i < brute.size(); ++i, ++ei) {
+            if (fabs (ei->first - brute[i].first) > 1e-12 || mpz_cmp_ui (ei->second, brute[i].second) != 0) {
+                cout << "F=" << ei->first << ": " << ei->second << " genomes; exhaustive F="
+                     << brute[i].first << ": " << brute[i].second << " genomes" << endl;
+                rtn = 1;
+            }
+        }
+    }
+
+    return rtn;
+}
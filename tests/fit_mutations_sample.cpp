@@ -0,0 +1,76 @@
+/*
+ * Tests the sampled count of fit mutations, num_fit_mutations_sample(),
+ * against the exhaustive num_fit_mutations(). When the number of
+ * samples is equal to the number of possible flip masks, every mask
+ * must be visited exactly once, so the results should agree exactly.
+ *
+ * Author: S James
+ * Date: October 2026.
+ */
+
+#include <iostream>
+#include <vector>
+#include <set>
+#include <stdlib.h>
+#include <sstream>
+#include <string>
+
+using namespace std;
+
+// Number of genes in a state is set at compile time.
+#define N_Genes 5
+
+// Common code
+#include "lib.h"
+
+// The fitness function used here
+#include "fitness.h"
+#include "mutation.h"
+
+int main (int argc, char** argv)
+{
+    // A fixed seed for the test.
+    unsigned int seed = 4;
+    srand (seed);
+    rngDataInit (&rd);
+    zigset (&rd, DUMMYARG);
+    rd.seed = seed;
+
+    // Initialise masks
+    masks_init();
+
+    array<genosect_t, N_Genes> genome = selected_genome();
+
+    unsigned int l_genome = N_Genes * (1 << N_Ins);
+
+    int rtn = 0;
+
+    // Hamming distance 1 and 2; l_genome and l_genome choose 2 masks respectively.
+    unsigned int nmasks[2] = { l_genome, l_genome * (l_genome-1) / 2 };
+    for (unsigned int h = 1; h <= 2; ++h) {
+        pair<unsigned int, double> exact = num_fit_mutations (genome, h);
+        pair<unsigned int, double> sampled = num_fit_mutations_sample (genome, h, nmasks[h-1]);
+        cout << "h=" << h << ": exact numfit " << exact.first << " fitness sum " << exact.second
+             << "; sampled numfit " << sampled.first << " fitness sum " << sampled.second << endl;
+        if (exact.first != sampled.first || abs(exact.second - sampled.second) > 1e-9) {
+            rtn = 1;
+        }
+    }
+
+    // A smaller sample should never report more fit genomes than it sampled
+    pair<unsigned int, double> partial = num_fit_mutations_sample (genome, 3, 1000);
+    cout << "h=3, 1000 samples: numfit " << partial.first << endl;
+    if (partial.first > 1000) {
+        rtn = 1;
+    }
+
+    // Asking for more distinct samples than there are masks is an error
+    try {
+        num_fit_mutations_sample (genome, 1, l_genome + 1);
+        rtn = 1;
+    } catch (const runtime_error& e) {
+        cout << "Expected exception: " << e.what() << endl;
+    }
+
+    return rtn;
+}
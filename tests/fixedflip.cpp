@@ -0,0 +1,119 @@
+/*
+ * Tests the fixed count mutation, evolve_genome(genome, bits_to_flip)
+ * and random_flip_mask(): that exactly that many bits flip, that every
+ * bit position is equally likely to be flipped and (where the genome is
+ * short enough to count them) that every pair of positions is equally
+ * likely.
+ */
+
+#include <iostream>
+#include <vector>
+#include <math.h>
+
+using namespace std;
+
+#ifndef N_Genes
+# define N_Genes 5
+#endif
+
+#include "lib.h"
+
+//! The number of bits in a genome
+#define L_Genome (N_Genes * Genosect_Width)
+
+/*!
+ * Is the chi-squared statistic x, with dof degrees of freedom, within
+ * 5 standard deviations of its mean?
+ */
+bool
+chisq_ok (double x, unsigned int dof)
+{
+    return fabs (x - (double)dof) < 5.0 * sqrt (2.0 * (double)dof);
+}
+
+int main()
+{
+    int rtn = 0;
+    masks_init();
+    rngDataInit (&rd);
+    zigset (&rd, DUMMYARG);
+    rd.seed = 4;
+
+    // Exactly bits_to_flip bits change, up to the whole genome
+    unsigned int ks[] = { 0, 1, 2, 3, 7, L_Genome/2, L_Genome - 1, L_Genome, L_Genome + 5 };
+    for (unsigned int ki = 0; ki < sizeof(ks)/sizeof(ks[0]); ++ki) {
+        for (unsigned int n = 0; n < 200; ++n) {
+            array<genosect_t, N_Genes> g;
+            random_genome (g, &rd);
+            array<genosect_t, N_Genes> g0 = g;
+            evolve_genome (g, ks[ki]);
+            unsigned int h = 0;
+            for (unsigned int i = 0; i < N_Genes; ++i) {
+                h += __builtin_popcountll ((unsigned long long int)(g[i] ^ g0[i]));
+            }
+            unsigned int expect = ks[ki] < L_Genome ? ks[ki] : L_Genome;
+            if (h != expect) {
+                cout << "evolve_genome(g, " << ks[ki] << ") flipped " << h << " bits" << endl;
+                rtn = -1;
+                break;
+            }
+        }
+    }
+
+    // Each position is flipped equally often
+    const unsigned int k = 3;
+    const unsigned int ntrials = 100000;
+    vector<unsigned int> counts (L_Genome, 0);
+    for (unsigned int n = 0; n < ntrials; ++n) {
+        array<genosect_t, N_Genes> mask;
+        random_flip_mask (mask, k, &rd);
+        for (unsigned int b = 0; b < L_Genome; ++b) {
+            if ((mask[b / Genosect_Width] >> (b % Genosect_Width)) & 0x1) { ++counts[b]; }
+        }
+    }
+    double expected = (double)ntrials * (double)k / (double)L_Genome;
+    double chisq = 0.0;
+    for (unsigned int b = 0; b < L_Genome; ++b) {
+        double d = (double)counts[b] - expected;
+        chisq += d * d / expected;
+    }
+    if (!chisq_ok (chisq, L_Genome - 1)) {
+        cout << "Positions are not flipped uniformly: chi squared " << chisq
+             << " with " << (L_Genome - 1) << " degrees of freedom" << endl;
+        rtn = -1;
+    }
+
+    // Each pair of positions is chosen equally often (for a short genome)
+    if (L_Genome <= 64) {
+        const unsigned int npairs = L_Genome * (L_Genome - 1) / 2;
+        const unsigned int ptrials = 400 * npairs;
+        vector<unsigned int> pcounts (L_Genome * L_Genome, 0);
+        for (unsigned int n = 0; n < ptrials; ++n) {
+            array<genosect_t, N_Genes> mask;
+            random_flip_mask (mask, 2, &rd);
+            unsigned int p[2], np = 0;
+            for (unsigned int b = 0; b < L_Genome && np < 2; ++b) {
+                if ((mask[b / Genosect_Width] >> (b % Genosect_Width)) & 0x1) { p[np++] = b; }
+            }
+            ++pcounts[p[0] * L_Genome + p[1]];
+        }
+        double pexpected = (double)ptrials / (double)npairs;
+        double pchisq = 0.0;
+        for (unsigned int a = 0; a < L_Genome; ++a) {
+            for (unsigned int b = a + 1; b < L_Genome; ++b) {
+                double d = (double)pcounts[a * L_Genome + b] - pexpected;
+                pchisq += d * d / pexpected;
+            }
+        }
+        if (!chisq_ok (pchisq, npairs - 1)) {
+            cout << "Pairs are not chosen uniformly: chi squared " << pchisq
+                 << " with " << (npairs - 1) << " degrees of freedom" << endl;
+            rtn = -1;
+        }
+    }
+
+    if (rtn == 0) {
+        cout << "Fixed count mutation is uniform for a genome of " << L_Genome << " bits" << endl;
+    }
+    return rtn;
+}
@@ -0,0 +1,157 @@
+/*
+ * Tests the function tables against Quine and isCanalyzing(). For
+ * N_Ins <= 4, the tables are generated, saved, then memory-mapped
+ * from the file and compared for every genosect, and a damaged file
+ * is checked to be regenerated. The tables are kept in a temporary
+ * directory, given by FUNCTABLES_DIR, which is made only when they are
+ * saved. For N_Ins = 5, the cache is checked
+ * with random genosects, some of them repeated.
+ *
+ * Author: S James
+ * Date: October 2026.
+ */
+
+#include <iostream>
+#include <array>
+#include <string>
+#include <cstdio>
+#include <cstdlib>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace std;
+
+// Number of genes in a state is set at compile time.
+#ifndef N_Genes
+# define N_Genes 4
+#endif
+
+// Common code
+#include "lib.h"
+#include "functables.h"
+
+int main (int argc, char** argv)
+{
+    unsigned int seed = 7;
+    rngDataInit (&rd);
+    zigset (&rd, DUMMYARG);
+    rd.seed = seed;
+
+    masks_init();
+
+    int rtn = 0;
+
+    // Keep the tables out of the user's cache directory
+    char tmpl[] = "/tmp/functablesXXXXXX";
+    if (mkdtemp (tmpl) == (char*)0) {
+        cout << "Failed to make a temporary directory" << endl;
+        return -1;
+    }
+    string tmpdir = tmpl;
+    string cachedir = tmpdir + "/cache";
+    setenv ("FUNCTABLES_DIR", cachedir.c_str(), 1);
+    string path = FunctionTables::defaultPath();
+    struct stat st;
+    if (path.find (cachedir + "/functables_k") != 0) {
+        cout << "FunctionTables::defaultPath() is " << path << ", not in FUNCTABLES_DIR" << endl;
+        rtn = -1;
+    }
+    if (stat (cachedir.c_str(), &st) == 0) {
+        cout << "FunctionTables::defaultPath() made " << cachedir << endl;
+        rtn = -1;
+    }
+
+#if N_Ins <= FUNCTABLES_MAX_INS
+
+    // Generates and saves, making the directory
+    FunctionTables ft1;
+    ft1.init (path);
+    canal_table = (const unsigned char*)0;
+    if (stat (path.c_str(), &st) != 0) {
+        cout << "FunctionTables::init() didn't save the tables to " << path << endl;
+        rtn = -1;
+    }
+
+    // Maps the saved file
+    FunctionTables ft2;
+    if (ft2.load (path) == false) {
+        cout << "Failed to load " << path << endl;
+        rtn = -1;
+    }
+
+    for (unsigned int f = 0; f < (1U << (1 << N_Ins)) && rtn == 0; ++f) {
+        genosect_t gs = static_cast<genosect_t>(f);
+        double c = function_complexity (f, N_Genes);
+        unsigned int ca = isCanalyzing (gs);
+        if (ft1.complexity (gs) != c || ft2.complexity (gs) != c) {
+            cout << "Complexity of 0x" << hex << f << dec << " is " << c << " not "
+                 << ft1.complexity (gs) << "/" << ft2.complexity (gs) << endl;
+            rtn = -1;
+        }
+        if (ft1.canalyzing (gs) != ca || ft2.canalyzing (gs) != ca) {
+            cout << "Canalysing value of 0x" << hex << f << dec << " is " << ca << endl;
+            rtn = -1;
+        }
+    }
+
+    // canalyzingness() should give the same with and without the table
+    functables.init (path);
+    const unsigned char* tbl = canal_table;
+    if (tbl == (const unsigned char*)0) {
+        cout << "FunctionTables::init() didn't set canal_table" << endl;
+        rtn = -1;
+    }
+    array<genosect_t, N_Genes> genome;
+    for (unsigned int i = 0; i < 1000 && rtn == 0; ++i) {
+        random_genome (genome);
+        canal_table = (const unsigned char*)0;
+        unsigned int c0 = canalyzingness (genome);
+        canal_table = tbl;
+        if (canalyzingness (genome) != c0) {
+            cout << "canalyzingness() differs when using the table" << endl;
+            rtn = -1;
+        }
+    }
+
+    // A truncated file should be regenerated and overwritten by init()
+    FILE* fp = fopen (path.c_str(), "wb");
+    fputs ("BNFUNCT", fp);
+    fclose (fp);
+    FunctionTables ft3;
+    ft3.init (path);
+    canal_table = (const unsigned char*)0;
+    FunctionTables ft4;
+    bool reloaded = false;
+    try {
+        reloaded = ft4.load (path);
+    } catch (const exception& e) {
+        cout << e.what() << endl;
+    }
+    if (!reloaded || ft3.complexity (0x6) != function_complexity (0x6, N_Genes)
+        || ft4.complexity (0x6) != function_complexity (0x6, N_Genes)) {
+        cout << "FunctionTables::init() didn't regenerate a truncated " << path << endl;
+        rtn = -1;
+    }
+
+    remove (path.c_str());
+#else
+    functables.init (path);
+    array<genosect_t, N_Genes> genome;
+    for (unsigned int i = 0; i < 2000 && rtn == 0; ++i) {
+        // Every other genome repeats the last, so that the cache is hit
+        if (i % 2 == 0) { random_genome (genome); }
+        for (unsigned int j = 0; j < N_Genes; ++j) {
+            double c = function_complexity (genome[j], N_Genes);
+            if (functables.complexity (genome[j]) != c) {
+                cout << "Complexity of 0x" << hex << genome[j] << dec << " is " << c << " not "
+                     << functables.complexity (genome[j]) << endl;
+                rtn = -1;
+            }
+        }
+    }
+#endif
+
+    rmdir (cachedir.c_str());
+    rmdir (tmpdir.c_str());
+    return rtn;
+}
@@ -0,0 +1,109 @@
+/*
+ * Tests the development of blocks of genomes in lockstep:
+ * compute_next_batch() against compute_next() for every state of
+ * every lane, and evaluate_fitness_batch() (and for FF4,
+ * evaluate_one_batch()) against evaluate_fitness() for blocks of 8 and
+ * 16 random genomes, among them genomes whose lanes finish at very
+ * different times.
+ */
+
+#include <iostream>
+#include <array>
+
+using namespace std;
+
+#ifndef N_Genes
+# define N_Genes 5
+#endif
+
+#include "lib.h"
+#include "fitness.h"
+
+template <unsigned int L>
+int test_block (unsigned int nblocks)
+{
+    int rtn = 0;
+    GenomeBlock<L> block;
+    array<genosect_t, N_Genes> genomes[L];
+    for (unsigned int b = 0; b < nblocks && rtn == 0; ++b) {
+        for (unsigned int l = 0; l < L; ++l) {
+            // Some lanes all zeros or all ones, so that the lanes stop at different times
+            if (b % 5 == 0 && l == 1) {
+                zero_genome (genomes[l]);
+            } else if (b % 5 == 0 && l == 2) {
+                for (unsigned int i = 0; i < N_Genes; ++i) { genomes[l][i] = genosect_mask; }
+            } else {
+                random_genome (genomes[l], &rd);
+            }
+            block.set (l, genomes[l]);
+        }
+
+        array<genosect_t, N_Genes> back;
+        block.get (L - 1, back);
+        if (back != genomes[L - 1]) {
+            cout << "GenomeBlock::get() doesn't return the genome that was set" << endl;
+            rtn = -1;
+        }
+
+        // Every state in every lane, starting with different states in each lane
+        for (unsigned int s = 0; s < (1 << N_Genes) && rtn == 0; ++s) {
+            unsigned int states[L];
+            for (unsigned int l = 0; l < L; ++l) { states[l] = (s + l) & state_mask; }
+            compute_next_batch (block, states);
+            for (unsigned int l = 0; l < L; ++l) {
+                state_t st = (state_t)((s + l) & state_mask);
+                compute_next (genomes[l], st);
+                if (states[l] != (unsigned int)st) {
+                    cout << "compute_next_batch() gives " << states[l] << " in lane " << l
+                         << " not " << (unsigned int)st << endl;
+                    rtn = -1;
+                    break;
+                }
+            }
+        }
+
+#ifdef USE_FITNESS_4
+        double sc[L];
+        evaluate_one_batch (block, initial_ant, target_ant, sc);
+        for (unsigned int l = 0; l < L; ++l) {
+            if (sc[l] != evaluate_one (genomes[l], initial_ant, target_ant)) {
+                cout << "evaluate_one_batch() gives " << sc[l] << " in lane " << l << " not "
+                     << evaluate_one (genomes[l], initial_ant, target_ant) << endl;
+                rtn = -1;
+                break;
+            }
+        }
+#endif
+
+        double f[L];
+        evaluate_fitness_batch (block, f);
+        for (unsigned int l = 0; l < L; ++l) {
+            double ef = evaluate_fitness (genomes[l]);
+            if (f[l] != ef) {
+                cout << "evaluate_fitness_batch() gives " << f[l] << " in lane " << l
+                     << " not " << ef << endl;
+                rtn = -1;
+                break;
+            }
+        }
+    }
+    return rtn;
+}
+
+int main()
+{
+    int rtn = 0;
+    masks_init();
+    rngDataInit (&rd);
+    zigset (&rd, DUMMYARG);
+    rd.seed = 7;
+
+    rtn |= test_block<8> (400);
+    rtn |= test_block<16> (200);
+
+    if (rtn == 0) {
+        cout << "Blocks of genomes for N_Genes=" << N_Genes << ", N_Ins=" << N_Ins
+             << " develop as single genomes" << endl;
+    }
+    return rtn;
+}
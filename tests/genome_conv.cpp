@@ -0,0 +1,202 @@
+/*
+ * Tests the allocation-free genome conversions (Dan string, genome_id
+ * and packed forms) against the original stringstream implementations,
+ * and checks that random genomes survive the round trip through each
+ * form, singly and in batches.
+ */
+
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <stdlib.h>
+
+using namespace std;
+
+#ifndef N_Genes
+# define N_Genes 5
+#endif
+
+// Common code
+#include "lib.h"
+
+//! The original genome2str()
+string
+ref_genome2str (const array<genosect_t, N_Genes>& genome)
+{
+    stringstream rtn;
+    for (unsigned int i = 0; i < N_Genes; ++i) {
+        for (unsigned long long int j = 0; j < (1 << N_Ins); ++j) {
+            genosect_t mask = GENOSECT_ONE << j;
+            rtn << ((genome[i]&mask) >> j);
+        }
+    }
+    return rtn.str();
+}
+
+//! The original genome_id()
+string
+ref_genome_id (const array<genosect_t, N_Genes>& genome)
+{
+    stringstream ss;
+    ss << hex;
+    for (unsigned int i = 0; i<N_Genes; ++i) {
+        if (i > 0) { ss << "-"; }
+        ss << (genome[i] & genosect_mask);
+    }
+    return ss.str();
+}
+
+//! A genome with random bits in every significant position
+array<genosect_t, N_Genes>
+random_full_genome (void)
+{
+    array<genosect_t, N_Genes> g;
+    for (unsigned int i = 0; i < N_Genes; ++i) {
+        genosect_t r = 0;
+        for (unsigned int j = 0; j < Genosect_Width; ++j) {
+            if (rand() & 0x1) { r |= GENOSECT_ONE << j; }
+        }
+        // Sometimes leave some high bits clear, to exercise the id's leading zeros
+        if (rand() % 4 == 0) { r >>= rand() % Genosect_Width; }
+        g[i] = r & Genosect_Width_Mask;
+    }
+    return g;
+}
+
+int main()
+{
+    int rtn = 0;
+    masks_init();
+    srand (42);
+
+    if (genosect_mask != Genosect_Width_Mask) {
+        cout << "Genosect_Width_Mask differs from genosect_mask" << endl;
+        rtn = -1;
+    }
+
+    const unsigned int ngenomes = 2000;
+    vector<array<genosect_t, N_Genes> > genomes;
+    // The extremes, then random genomes
+    array<genosect_t, N_Genes> g;
+    for (unsigned int i = 0; i < N_Genes; ++i) { g[i] = 0; }
+    genomes.push_back (g);
+    for (unsigned int i = 0; i < N_Genes; ++i) { g[i] = Genosect_Width_Mask; }
+    genomes.push_back (g);
+    while (genomes.size() < ngenomes) {
+        genomes.push_back (random_full_genome());
+    }
+
+    char sbuf[Genome_Str_Len];
+    char ibuf[Genome_Id_Maxlen];
+    unsigned char pbuf[Genome_Packed_Len];
+    for (unsigned int n = 0; n < ngenomes && rtn == 0; ++n) {
+        const array<genosect_t, N_Genes>& gn = genomes[n];
+        array<genosect_t, N_Genes> back;
+
+        // Dan string
+        genome2chars (gn, sbuf);
+        string s(sbuf, Genome_Str_Len);
+        if (s != ref_genome2str (gn) || genome2str (gn) != s) {
+            cout << "genome2chars gives " << s << " not " << ref_genome2str (gn) << endl;
+            rtn = -1;
+        }
+        if (!chars2genome (sbuf, back) || back != gn || str2genome (s) != gn) {
+            cout << "Dan string " << s << " doesn't convert back" << endl;
+            rtn = -1;
+        }
+
+        // genome_id
+        unsigned int l = genome2id (gn, ibuf);
+        string id(ibuf);
+        if (id.size() != l || id != ref_genome_id (gn) || genome_id (gn) != id) {
+            cout << "genome2id gives " << id << " not " << ref_genome_id (gn) << endl;
+            rtn = -1;
+        }
+        if (!id2genome (ibuf, l, back) || back != gn) {
+            cout << "genome_id " << id << " doesn't convert back" << endl;
+            rtn = -1;
+        }
+
+        // Packed; bit k must be char k of the Dan string
+        genome2packed (gn, pbuf);
+        for (unsigned int k = 0; k < Genome_Str_Len; ++k) {
+            if (((pbuf[k/8] >> (k%8)) & 0x1) != (unsigned int)(s[k] - '0')) {
+                cout << "Packed bit " << k << " differs from the Dan string " << s << endl;
+                rtn = -1;
+                break;
+            }
+        }
+        packed2genome (pbuf, back);
+        if (back != gn) {
+            cout << "Packed genome " << s << " doesn't convert back" << endl;
+            rtn = -1;
+        }
+    }
+
+    // Batches
+    vector<char> text (ngenomes * (Genome_Str_Len + 1));
+    genomes2chars (genomes.data(), ngenomes, text.data());
+    vector<array<genosect_t, N_Genes> > back (ngenomes);
+    if (chars2genomes (text.data(), ngenomes, back.data()) != ngenomes || back != genomes) {
+        cout << "Batch Dan strings don't convert back" << endl;
+        rtn = -1;
+    }
+    string lines;
+    for (unsigned int n = 0; n < ngenomes; ++n) { lines += ref_genome2str (genomes[n]) + "\n"; }
+    if (lines != string (text.data(), text.size())) {
+        cout << "Batch Dan strings differ from single conversions" << endl;
+        rtn = -1;
+    }
+
+    vector<char> ids (ngenomes * Genome_Id_Maxlen);
+    size_t idlen = genomes2ids (genomes.data(), ngenomes, ids.data());
+    string idlines;
+    for (unsigned int n = 0; n < ngenomes; ++n) { idlines += ref_genome_id (genomes[n]) + "\n"; }
+    if (idlines != string (ids.data(), idlen)) {
+        cout << "Batch genome_ids differ from single conversions" << endl;
+        rtn = -1;
+    }
+
+    vector<unsigned char> packed (ngenomes * Genome_Packed_Len);
+    genomes2packed (genomes.data(), ngenomes, packed.data());
+    for (unsigned int n = 0; n < ngenomes; ++n) { back[n][0] = ~back[n][0]; }
+    packed2genomes (packed.data(), ngenomes, back.data());
+    if (back != genomes) {
+        cout << "Batch packed genomes don't convert back" << endl;
+        rtn = -1;
+    }
+
+    // Bad input is rejected
+    text[5] = '2';
+    if (chars2genomes (text.data(), ngenomes, back.data()) != 0) {
+        cout << "chars2genomes() accepted a '2'" << endl;
+        rtn = -1;
+    }
+    text[5] = '0';
+    text[Genome_Str_Len + 1 + 3] = ' ';
+    if (chars2genomes (text.data(), ngenomes, back.data()) != 1) {
+        cout << "chars2genomes() didn't stop at the second genome" << endl;
+        rtn = -1;
+    }
+    const char* bad_ids[] = { "", "1", "1--2", "x-1-1-1-1-1-1", "1-1-1-1-1-1-1-1-1-1-1" };
+    for (unsigned int b = 0; b < sizeof(bad_ids)/sizeof(bad_ids[0]); ++b) {
+        if (id2genome (bad_ids[b], strlen (bad_ids[b]), g)) {
+            cout << "id2genome() accepted " << bad_ids[b] << endl;
+            rtn = -1;
+        }
+    }
+    // One hex digit too many for a genosect
+    string toolong (Genosect_Width/4 + 1, '1');
+    string longid = toolong;
+    for (unsigned int i = 1; i < N_Genes; ++i) { longid += "-0"; }
+    if (id2genome (longid.c_str(), longid.size(), g)) {
+        cout << "id2genome() accepted " << longid << endl;
+        rtn = -1;
+    }
+
+    if (rtn == 0) {
+        cout << "Genome conversions for N_Genes=" << N_Genes << ", N_Ins=" << N_Ins << " are correct" << endl;
+    }
+    return rtn;
+}
@@ -1,5 +1,6 @@
 /*
- * Tests the hamming distance code - the genome one.
+ * Tests the hamming distance code - the genome one, including a
+ * difference in the top bit of a genosect (bit 63 for N_Genes=6).
  *
  * Author: S James
  * Date: October 2018.
@@ -21,7 +22,9 @@ using namespace std;
 // #define DEBUG2 1
 
 // Number of genes in a state is set at compile time.
-#define N_Genes 5
+#ifndef N_Genes
+# define N_Genes 5
+#endif
 
 // Common code
 #include "lib.h"
@@ -31,6 +34,8 @@ int main (int argc, char** argv)
     // Initialise masks
     masks_init();
 
+    int rtn = 1;
+#if N_Genes == 5
     array<genosect_t, N_Genes> g1 = selected_genome();
     array<genosect_t, N_Genes> g2 = selected_genome();
     g2[0] += 1;
@@ -40,9 +45,25 @@ int main (int argc, char** argv)
 
     cout << "Hamming dist: " << h1 << endl;
 
-    int rtn = 1;
     if (h1 == 0x9) {
         rtn = 0;
     }
+#else
+    rtn = 0;
+#endif
+
+    // Flip the lowest and highest bits of some genosects, and every bit of another
+    array<genosect_t, N_Genes> g3;
+    random_genome (g3);
+    array<genosect_t, N_Genes> g4 = g3;
+    bitflip_genome (g4, 0, 0);
+    bitflip_genome (g4, 1, Genosect_Width - 1);
+    bitflip_genome (g4, N_Genes - 1, Genosect_Width - 1);
+    g4[2] ^= genosect_mask;
+    unsigned int h2 = compute_hamming (g3, g4);
+    cout << "Hamming dist with top bits: " << h2 << endl;
+    if (h2 != 3 + Genosect_Width) {
+        rtn = 1;
+    }
     return rtn;
 }
@@ -0,0 +1,82 @@
+/*
+ * Tests the hypercube layers, transitions and path counts of
+ * hypercube.h against brute force: the layers by scanning every node,
+ * the transitions by comparing every pair of nodes in adjacent layers
+ * and the number of paths to a node with h set bits against h!.
+ */
+
+#include <iostream>
+#include <vector>
+#include <utility>
+
+using namespace std;
+
+#include "hypercube.h"
+
+int main()
+{
+    int rtn = 0;
+
+    for (unsigned int n = 1; n <= 10 && rtn == 0; ++n) {
+        vector<node_t> prev_layer;
+        for (unsigned int k = 0; k <= n; ++k) {
+            vector<node_t> expect, got;
+            for (node_t i = 0; i < ((node_t)1 << n); ++i) {
+                if ((unsigned int)__builtin_popcount (i) == k) { expect.push_back (i); }
+            }
+            hypercube_layer (n, k, [&got](node_t nd) { got.push_back (nd); });
+            if (got != expect) {
+                cout << "Layer " << k << " of n=" << n << " is wrong" << endl;
+                rtn = -1;
+            }
+
+            vector<pair<node_t, node_t> > texpect, tgot;
+            for (node_t from : prev_layer) {
+                for (node_t to : expect) {
+                    if (__builtin_popcount (from ^ to) == 1) { texpect.push_back (make_pair (from, to)); }
+                }
+            }
+            hypercube_transitions (n, k, [&tgot](node_t from, node_t to) { tgot.push_back (make_pair (from, to)); });
+            if (tgot != texpect) {
+                cout << "Transitions into layer " << k << " of n=" << n << " are wrong" << endl;
+                rtn = -1;
+            }
+            prev_layer = expect;
+        }
+    }
+
+    // There are h! paths to a node with h set bits, whichever bits they are
+    pathcount_t factorial = 1;
+    for (unsigned int h = 1; h <= 20; ++h) {
+        factorial *= h;
+        node_t targets[] = { (node_t)((1ULL << h) - 1), (node_t)(((1ULL << h) - 1) << (31 - h)) };
+        for (node_t target : targets) {
+            vector<pathcount_t> layer_paths;
+            pathcount_t np = hypercube_count_paths (target, &layer_paths);
+            if (np != factorial) {
+                cout << "Counted " << pathcount_str (np) << " paths to " << target
+                     << ", expected " << pathcount_str (factorial) << endl;
+                rtn = -1;
+            }
+            // Into layer k, C(h,k) nodes each with k! paths
+            pathcount_t lp = 1;
+            for (unsigned int k = 1; k <= h; ++k) {
+                lp = lp * (h - k + 1);
+                if (layer_paths[k] != lp) {
+                    cout << "Paths into layer " << k << " for h=" << h << ": " << pathcount_str (layer_paths[k])
+                         << ", expected " << pathcount_str (lp) << endl;
+                    rtn = -1;
+                }
+            }
+        }
+    }
+    if (pathcount_str (factorial) != "2432902008176640000") {
+        cout << "pathcount_str(20!) gave " << pathcount_str (factorial) << endl;
+        rtn = -1;
+    }
+
+    if (rtn == 0) {
+        cout << "Hypercube layers, transitions and path counts are correct" << endl;
+    }
+    return rtn;
+}
@@ -0,0 +1,96 @@
+/*
+ * Tests the mutant-outcome sampler of mutant_outcome.h: that the
+ * GenomePool gives back what was stored, that every start has F>0,
+ * that a mutation which changes nothing gives only equally fit mutants
+ * and that the counts of real mutations add up.
+ */
+
+#include <iostream>
+#include <vector>
+#include <set>
+#include <array>
+
+using namespace std;
+
+#ifndef N_Genes
+# define N_Genes 5
+#endif
+
+#include "lib.h"
+#include "fitness.h"
+#include "mutant_outcome.h"
+
+int main()
+{
+    int rtn = 0;
+    masks_init();
+    rngDataInit (&rd);
+    zigset (&rd, DUMMYARG);
+    rd.seed = 4;
+    pOn = 0.05;
+
+    // The pool round trips
+    const size_t npool = 1000;
+    GenomePool pool (npool);
+    vector<array<genosect_t, N_Genes> > gs (npool);
+    for (size_t s = 0; s < npool; ++s) {
+        random_genome (gs[s], &rd);
+        pool.store (s, gs[s]);
+    }
+    for (size_t s = 0; s < npool; ++s) {
+        array<genosect_t, N_Genes> g;
+        pool.load (s, g);
+        if (g != gs[s]) {
+            cout << "GenomePool returned the wrong genome for " << s << endl;
+            rtn = -1;
+            break;
+        }
+    }
+
+    const size_t nstarts = 200;
+    const unsigned long long int nmutants = 100;
+    MutantOutcomeSampler sampler (nstarts, nmutants);
+    sampler.progress_every = 0;
+    sampler.init_starts();
+    for (size_t s = 0; s < nstarts; ++s) {
+        array<genosect_t, N_Genes> g;
+        sampler.starts.load (s, g);
+        if (sampler.initialFitness[s] <= 0.0 || evaluate_fitness (g) != sampler.initialFitness[s]) {
+            cout << "Start " << s << " has fitness " << sampler.initialFitness[s] << endl;
+            rtn = -1;
+            break;
+        }
+    }
+
+    // An unchanged genome is always equally fit
+    sampler.run ([](array<genosect_t, N_Genes>&, RngData*) {});
+    for (size_t s = 0; s < nstarts; ++s) {
+        if (sampler.numEqual[s] != nmutants || sampler.numFitter[s] != 0) {
+            cout << "Unmutated start " << s << ": " << sampler.numFitter[s] << " fitter, "
+                 << sampler.numEqual[s] << " equal" << endl;
+            rtn = -1;
+            break;
+        }
+    }
+
+    // Real mutations make some fitter and some less fit, and the counts add up
+    sampler.run ([](array<genosect_t, N_Genes>& g, RngData* trd) { evolve_genome (g, 3, trd); });
+    unsigned long long int fitter = 0, lessfit = 0;
+    for (size_t s = 0; s < nstarts; ++s) {
+        if (sampler.numFitter[s] + sampler.numEqual[s] > nmutants) {
+            cout << "Start " << s << " has more outcomes than mutants" << endl;
+            rtn = -1;
+        }
+        fitter += sampler.numFitter[s];
+        lessfit += nmutants - sampler.numFitter[s] - sampler.numEqual[s];
+    }
+    if (fitter == 0 || lessfit == 0) {
+        cout << "Mutation gave " << fitter << " fitter and " << lessfit << " less fit genomes" << endl;
+        rtn = -1;
+    }
+
+    if (rtn == 0) {
+        cout << "The mutant outcome sampler is OK" << endl;
+    }
+    return rtn;
+}
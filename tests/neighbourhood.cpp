@@ -0,0 +1,108 @@
+/*
+ * Tests neighbourhood_sweep() against evaluating each mutant, one at
+ * a time, with evaluate_fitness(). Checks Hamming distances 1 and 2
+ * for the selected genome (where there is one for N_Genes) and for
+ * some random, fit genomes.
+ *
+ * Author: S James
+ * Date: October 2026.
+ */
+
+#include <iostream>
+#include <vector>
+#include <set>
+#include <stdlib.h>
+#include <sstream>
+#include <string>
+
+using namespace std;
+
+// Number of genes in a state is set at compile time.
+#ifndef N_Genes
+# define N_Genes 5
+#endif
+
+// Common code
+#include "lib.h"
+
+// The fitness function used here
+#include "fitness.h"
+#include "neighbourhood.h"
+
+/*!
+ * Compare the sweep with a serial evaluation for genome at Hamming
+ * distance h. Return the number of mismatches.
+ */
+unsigned int
+check_sweep (const array<genosect_t, N_Genes>& genome, unsigned int h)
+{
+    unsigned int l_genome = N_Genes * (1 << N_Ins);
+    vector<double> f = neighbourhood_sweep (genome, h);
+
+    int combo[N_Genes * (1<<N_Ins)];
+    for (unsigned int i = 0; i < h; ++i) { combo[i] = i; }
+
+    unsigned int mismatches = 0;
+    size_t m = 0;
+    bool finished = false;
+    while (!finished) {
+        array<genosect_t, N_Genes> mutant = genome;
+        for (unsigned int j = 0; j < h; ++j) {
+            bitflip_genome (mutant, combo[j] / (1<<N_Ins), combo[j] % (1<<N_Ins));
+        }
+        double fs = evaluate_fitness (mutant);
+        if (m >= f.size() || f[m] != fs) {
+            ++mismatches;
+        }
+        ++m;
+        finished = !next_combination (combo, h, l_genome);
+    }
+    if (m != f.size()) {
+        ++mismatches;
+    }
+    return mismatches;
+}
+
+int main (int argc, char** argv)
+{
+    // A fixed seed for the test.
+    unsigned int seed = 7;
+    srand (seed);
+    rngDataInit (&rd);
+    zigset (&rd, DUMMYARG);
+    rd.seed = seed;
+
+    // Initialise masks
+    masks_init();
+
+    vector<array<genosect_t, N_Genes> > genomes;
+#if N_Genes == 5 || N_Genes == 6
+    genomes.push_back (selected_genome());
+#endif
+    while (genomes.size() < 6) {
+        array<genosect_t, N_Genes> g = random_genome();
+        if (evaluate_fitness (g) > 0.0 || genomes.size() == 5) {
+            genomes.push_back (g);
+        }
+    }
+
+    int rtn = 0;
+    for (unsigned int i = 0; i < genomes.size(); ++i) {
+        for (unsigned int h = 1; h <= 2; ++h) {
+            unsigned int mm = check_sweep (genomes[i], h);
+            if (mm > 0) {
+                cout << "Genome " << genome2str (genomes[i]) << " h=" << h << ": "
+                     << mm << " mismatches" << endl;
+                rtn = 1;
+            }
+        }
+    }
+
+    // h=0 gives just the fitness of the genome itself
+    vector<double> f0 = neighbourhood_sweep (genomes[0], 0);
+    if (f0.size() != 1 || f0[0] != evaluate_fitness (genomes[0])) {
+        rtn = 1;
+    }
+
+    return rtn;
+}
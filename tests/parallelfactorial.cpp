@@ -0,0 +1,42 @@
+/*
+ * Tests the thread pool PrimeSwing::ParallelFactorial against
+ * mpz_fac_ui, for n either side of the thresholds in the algorithm
+ * and for some large n.
+ *
+ * Author: S James
+ * Date: October 2026.
+ */
+
+#include <iostream>
+#include "lmp.h"
+#include "primeswing.h"
+
+using namespace std;
+
+int main()
+{
+    int rtn = 0;
+
+    Xint ref, res;
+    lmp::Init (ref);
+    lmp::Init (res);
+
+    ulong ns[] = { 0, 1, 2, 19, 20, 21, 32, 33, 64, 65, 100, 1000, 4097, 12345, 100000, 300000 };
+    for (unsigned int i = 0; i < sizeof(ns)/sizeof(ns[0]); ++i) {
+        lmp::FacUi (ref, ns[i]);
+        PrimeSwing::ParallelFactorial (res, ns[i]);
+        if (lmp::Cmp (res, ref) != 0) {
+            cout << "ParallelFactorial(" << ns[i] << ") is wrong" << endl;
+            rtn = -1;
+        }
+        PrimeSwing::Factorial (res, ns[i]);
+        if (lmp::Cmp (res, ref) != 0) {
+            cout << "Factorial(" << ns[i] << ") is wrong" << endl;
+            rtn = -1;
+        }
+    }
+
+    lmp::Clear (ref);
+    lmp::Clear (res);
+    return rtn;
+}
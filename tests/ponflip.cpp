@@ -0,0 +1,120 @@
+/*
+ * Tests the mutation with probability pOn per bit, evolve_genome()
+ * and flip_genome_bits(), which jump from one flipped bit to the next:
+ * that the number of bits flipped has the binomial mean and variance,
+ * that every bit position is flipped equally often (including the
+ * first and last) and that p=0 and p=1 flip none and all of the bits.
+ */
+
+#include <iostream>
+#include <vector>
+#include <math.h>
+
+using namespace std;
+
+#ifndef N_Genes
+# define N_Genes 5
+#endif
+
+#include "lib.h"
+
+//! The number of bits in a genome
+#define L_Genome (N_Genes * Genosect_Width)
+
+/*!
+ * Is the chi-squared statistic x, with dof degrees of freedom, within
+ * 5 standard deviations of its mean?
+ */
+bool
+chisq_ok (double x, unsigned int dof)
+{
+    return fabs (x - (double)dof) < 5.0 * sqrt (2.0 * (double)dof);
+}
+
+//! The number of bits which differ between g and g0
+unsigned int
+flipped (const array<genosect_t, N_Genes>& g, const array<genosect_t, N_Genes>& g0)
+{
+    unsigned int h = 0;
+    for (unsigned int b = 0; b < L_Genome; ++b) {
+        h += genosect_bit (g[b / Genosect_Width], b % Genosect_Width)
+            ^ genosect_bit (g0[b / Genosect_Width], b % Genosect_Width);
+    }
+    return h;
+}
+
+int main()
+{
+    int rtn = 0;
+    masks_init();
+    rngDataInit (&rd);
+    zigset (&rd, DUMMYARG);
+    rd.seed = 9;
+
+    // p=0 flips nothing and p=1 flips everything
+    array<genosect_t, N_Genes> g, g0;
+    random_genome (g, &rd);
+    g0 = g;
+    if (flip_genome_bits (g, 0.0, &rd) != 0 || flipped (g, g0) != 0) {
+        cout << "flip_genome_bits() with p=0 flipped some bits" << endl;
+        rtn = -1;
+    }
+    if (flip_genome_bits (g, 1.0, &rd) != L_Genome || flipped (g, g0) != L_Genome) {
+        cout << "flip_genome_bits() with p=1 didn't flip every bit" << endl;
+        rtn = -1;
+    }
+
+    // The flip count is binomial and every position is flipped equally often
+    double ps[] = { 0.01, 0.05, 0.5 };
+    for (unsigned int pi = 0; pi < sizeof(ps)/sizeof(ps[0]); ++pi) {
+        pOn = ps[pi];
+        const unsigned int ntrials = 20000;
+        vector<unsigned int> counts (L_Genome, 0);
+        double sum = 0.0, sumsq = 0.0;
+        for (unsigned int n = 0; n < ntrials; ++n) {
+            random_genome (g, &rd);
+            g0 = g;
+            evolve_genome (g, &rd);
+            unsigned int h = 0;
+            for (unsigned int b = 0; b < L_Genome; ++b) {
+                if (genosect_bit (g[b / Genosect_Width], b % Genosect_Width)
+                    != genosect_bit (g0[b / Genosect_Width], b % Genosect_Width)) {
+                    ++counts[b];
+                    ++h;
+                }
+            }
+            sum += h;
+            sumsq += (double)h * h;
+        }
+        double p = pOn;
+        double mean = sum / ntrials;
+        double var = sumsq / ntrials - mean * mean;
+        double emean = L_Genome * p;
+        double evar = L_Genome * p * (1.0 - p);
+        // The standard error of the mean is sqrt(evar/ntrials); that of the variance is about
+        // evar*sqrt(2/ntrials)
+        if (fabs (mean - emean) > 5.0 * sqrt (evar / ntrials)
+            || fabs (var - evar) > 5.0 * evar * sqrt (2.0 / ntrials) + 5.0 * sqrt (evar / ntrials)) {
+            cout << "pOn=" << p << ": mean " << mean << " (expected " << emean << "), variance "
+                 << var << " (expected " << evar << ")" << endl;
+            rtn = -1;
+        }
+        double expected = (double)ntrials * p;
+        double chisq = 0.0;
+        for (unsigned int b = 0; b < L_Genome; ++b) {
+            double d = (double)counts[b] - expected;
+            chisq += d * d / (expected * (1.0 - p));
+        }
+        if (!chisq_ok (chisq, L_Genome)) {
+            cout << "pOn=" << p << ": positions are not flipped uniformly: chi squared " << chisq
+                 << " with " << L_Genome << " degrees of freedom" << endl;
+            rtn = -1;
+        }
+    }
+
+    if (rtn == 0) {
+        cout << "Mutation with probability pOn is binomial and uniform for a genome of "
+             << L_Genome << " bits" << endl;
+    }
+    return rtn;
+}
@@ -0,0 +1,72 @@
+/*
+ * Check that the bitset Quine-McCluskey implementation in quine.h
+ * gives the same complexity as the original, string-labelled one, for
+ * random functions of 3, 4 and 5 variables.
+ */
+
+#include <iostream>
+#include <ctime>
+#include "quine.h"
+#include "quine_strings.h"
+
+using namespace std;
+
+// xorshift64, so that the test doesn't depend on lib.h
+unsigned long long int rng_state = 0x2545f4914f6cdd1dULL;
+unsigned long long int next_rand (void)
+{
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 7;
+    rng_state ^= rng_state << 17;
+    return rng_state;
+}
+
+int main()
+{
+    int rtn = 0;
+
+    unsigned int ntrials[3] = { 256, 4000, 1000 };
+    for (int vars = 3; vars <= 5; ++vars) {
+        unsigned long long int allmin = (1ULL << (1 << vars)) - 1ULL;
+        double t_strings = 0.0, t_bits = 0.0;
+        for (unsigned int i = 0; i < ntrials[vars-3]; ++i) {
+            // For 3 variables, try every function (but the empty one, which the old code can't do)
+            unsigned long long int fn = (vars == 3) ? i : (next_rand() & allmin);
+            if (fn == 0) { continue; }
+
+            clock_t t0 = clock();
+            StringQuine SQ(vars);
+            for (int j = 0; j < (1 << vars); ++j) {
+                if ((fn >> j) & 0x1) { SQ.addMinterm (j); }
+            }
+            SQ.go();
+            double c_strings = SQ.complexity();
+            clock_t t1 = clock();
+            Quine Q(vars);
+            Q.setFunction (fn);
+            Q.go();
+            double c_bits = Q.complexity();
+            clock_t t2 = clock();
+            t_strings += (double)(t1 - t0);
+            t_bits += (double)(t2 - t1);
+
+            if (c_strings != c_bits) {
+                cout << "vars=" << vars << " fn=0x" << hex << fn << dec << ": complexity "
+                     << c_bits << " should be " << c_strings << endl;
+                cout << "  " << Q.min() << endl << "  " << SQ.min() << endl;
+                rtn = -1;
+            }
+        }
+        cout << vars << " variables: string implementation " << (t_strings / CLOCKS_PER_SEC)
+             << " s, bitset implementation " << (t_bits / CLOCKS_PER_SEC) << " s" << endl;
+    }
+
+    // Some functions of 6 variables: constant 1, parity and a single minterm
+    if (function_complexity (~0ULL, 6) != 1.0/64.0) { rtn = -1; }
+    if (function_complexity (0x6996966996696996ULL, 6) != 32.0/64.0) { rtn = -1; }
+    if (function_complexity (0x1ULL << 37, 6) != 1.0/64.0) { rtn = -1; }
+    // and the empty function
+    if (function_complexity (0x0ULL, 4) != 0.0) { rtn = -1; }
+
+    return rtn;
+}
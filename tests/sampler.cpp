@@ -0,0 +1,129 @@
+/*
+ * Tests the confidence intervals in sampler.h against known values,
+ * then checks that FitnessSampler's intervals, with and without
+ * stratification, contain the exact proportions of fit, perfect and
+ * fit-and-canalysing genomes for N_Genes=3 (from exactfits3 and
+ * proprandom -n 3), that stratified batches smaller than the number
+ * of strata add up to max_samples, and that a finely stratified run for
+ * the rare F=1 genomes doesn't stop before an unstratified interval
+ * from the same number of samples would be as narrow.
+ *
+ * Author: S James
+ * Date: October 2026.
+ */
+
+#include <iostream>
+#include <vector>
+#include <set>
+#include <stdlib.h>
+#include <sstream>
+#include <string>
+
+using namespace std;
+
+// Number of genes in a state is set at compile time.
+#define N_Genes 3
+
+// Common code
+#include "lib.h"
+
+// The fitness function used here
+#include "fitness.h"
+#include "sampler.h"
+
+//! Exact numbers of fit and perfect genomes out of 8^8 for N_Genes=3
+#define EXACT_NUMFIT     4387020.0
+#define EXACT_NUMPERFECT 11384.0
+#define EXACT_NUMFIT_CANAL 3557590.0
+#define N_GENOMES        16777216.0
+
+bool
+close_to (double a, double b, double tol)
+{
+    return fabs (a - b) < tol;
+}
+
+int main (int argc, char** argv)
+{
+    // A fixed seed for the test.
+    unsigned int seed = 11;
+    srand (seed);
+    rngDataInit (&rd);
+    zigset (&rd, DUMMYARG);
+    rd.seed = seed;
+
+    masks_init();
+
+    int rtn = 0;
+
+    // Known intervals for 5 successes in 10 trials, 95%
+    double lo = 0.0, hi = 0.0;
+    wilson_interval (5, 10, 1.959964, lo, hi);
+    cout << "Wilson 5/10: [" << lo << "," << hi << "]" << endl;
+    if (!close_to (lo, 0.236593, 1e-5) || !close_to (hi, 0.763407, 1e-5)) { rtn = 1; }
+    clopper_pearson_interval (5, 10, 1.959964, lo, hi);
+    cout << "Clopper-Pearson 5/10: [" << lo << "," << hi << "]" << endl;
+    if (!close_to (lo, 0.187086, 1e-5) || !close_to (hi, 0.812914, 1e-5)) { rtn = 1; }
+    clopper_pearson_interval (0, 20, 1.959964, lo, hi);
+    cout << "Clopper-Pearson 0/20: [" << lo << "," << hi << "]" << endl;
+    if (lo != 0.0 || !close_to (hi, 0.168433, 1e-5)) { rtn = 1; }
+
+    double pfit = EXACT_NUMFIT / N_GENOMES;
+    double pperfect = EXACT_NUMPERFECT / N_GENOMES;
+    double pfitcanal = EXACT_NUMFIT_CANAL / N_GENOMES;
+
+    for (unsigned int nstrata = 1; nstrata <= 8; nstrata *= 8) {
+        FitnessSampler fs (nstrata);
+        fs.precision = 0.1;
+        fs.z = 3.29; // 99.9%
+        fs.interval = (nstrata == 1) ? CI_WILSON : CI_CLOPPER_PEARSON;
+        fs.max_samples = 20000000ULL;
+        fs.count_canalysing = true;
+        bool converged = fs.run();
+        ProportionEstimate ef = fs.fit();
+        ProportionEstimate ep = fs.perfect();
+        ProportionEstimate efc = fs.fitCanalysing();
+        cout << nstrata << " strata, " << fs.samples() << " samples: P(F>0)=" << ef.p
+             << " [" << ef.lo << "," << ef.hi << "] (exact " << pfit << "), P(F=1)=" << ep.p
+             << " [" << ep.lo << "," << ep.hi << "] (exact " << pperfect << "), P(F>0, canalysing)="
+             << efc.p << " [" << efc.lo << "," << efc.hi << "] (exact " << pfitcanal << ")" << endl;
+        if (!converged || ep.relPrecision() > 0.1
+            || pfit < ef.lo || pfit > ef.hi || pperfect < ep.lo || pperfect > ep.hi
+            || pfitcanal < efc.lo || pfitcanal > efc.hi) {
+            rtn = 1;
+        }
+    }
+
+    // Batches of 5 between 8 strata: the first batch samples every stratum, the later ones are
+    // of 5, and the last is cut to land on max_samples
+    FitnessSampler fs8 (8);
+    fs8.batch = 5;
+    fs8.max_samples = 1001;
+    fs8.run();
+    cout << "8 strata, batches of 5: " << fs8.samples() << " samples of 1001" << endl;
+    if (fs8.samples() != 1001) { rtn = 1; }
+
+    // Many strata, in most of which no F=1 genome is found. Those strata must still count
+    // towards the variance, so that the run goes on at least until the unstratified interval
+    // for the same estimate and number of samples is as narrow as the target.
+    for (unsigned int seed_i = 0; seed_i < 4; ++seed_i) {
+        rd.seed = 100 + seed_i;
+        FitnessSampler fsn (25);
+        fsn.precision = 0.2;
+        fsn.batch = 1 << 12;
+        fsn.run();
+        ProportionEstimate ep = fsn.perfect();
+        double n = (double)fsn.samples();
+        ProportionEstimate eu = ep;
+        wilson_interval (ep.p * n, n, fsn.z, eu.lo, eu.hi);
+        cout << "25 strata, " << fsn.samples() << " samples: P(F=1)=" << ep.p << " [" << ep.lo << ","
+             << ep.hi << "], unstratified [" << eu.lo << "," << eu.hi << "]" << endl;
+        if (eu.relPrecision() > fsn.precision) {
+            cout << "The stratified run stopped with a relative precision of " << eu.relPrecision()
+                 << " for an unstratified interval" << endl;
+            rtn = 1;
+        }
+    }
+
+    return rtn;
+}
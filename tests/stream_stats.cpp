@@ -0,0 +1,119 @@
+/*
+ * Tests the streaming summaries of stream_stats.h: that the log
+ * histogram bins values correctly, that 0 and 1 are counted exactly,
+ * that the quantile sketch's quantiles are within its relative accuracy
+ * of the exact quantiles, and that merging shards gives the same
+ * summary as adding every value to one.
+ */
+
+#include <iostream>
+#include <vector>
+#include <algorithm>
+#include <math.h>
+
+using namespace std;
+
+#define N_Genes 5 // required for lib.h but unused
+#include "lib.h"
+#include "stream_stats.h"
+
+int main()
+{
+    int rtn = 0;
+    rngDataInit (&rd);
+    zigset (&rd, DUMMYARG);
+    rd.seed = 4;
+
+    // Fitness-like values: some 0, some 1, the rest spread over 1e-11 to 1
+    const unsigned int nvals = 200000;
+    const unsigned int nshards = 7;
+    vector<double> vals;
+    StreamStats all;
+    vector<StreamStats> shards (nshards);
+    unsigned long long int nzero = 0, none = 0;
+    for (unsigned int i = 0; i < nvals; ++i) {
+        double u = randDouble();
+        double x;
+        if (u < 0.3) {
+            x = 0.0;
+            ++nzero;
+        } else if (u < 0.32) {
+            x = 1.0;
+            ++none;
+        } else {
+            x = pow (10.0, -11.0 * randDouble());
+        }
+        vals.push_back (x);
+        all.add (x);
+        shards[i % nshards].add (x);
+    }
+
+    if (all.n != nvals || all.n_zero != nzero || all.n_one != none) {
+        cout << "Counts wrong: n=" << all.n << " n_zero=" << all.n_zero << " n_one=" << all.n_one << endl;
+        rtn = -1;
+    }
+
+    // Each histogram bin holds exactly the values between its edges
+    const LogHistogram& h = all.hist;
+    unsigned long long int binned = 0;
+    for (size_t b = 0; b < h.counts.size(); ++b) {
+        double lo = h.edge (b), hi = h.edge (b + 1);
+        unsigned long long int c = 0;
+        for (double x : vals) {
+            // Leave values within rounding of an edge out of the comparison
+            if (x > lo * (1.0 + 1e-12) && x < hi * (1.0 - 1e-12)) { ++c; }
+        }
+        if (c > h.counts[b] || h.counts[b] > c + 2) {
+            cout << "Bin " << b << " [" << lo << "," << hi << ") holds " << h.counts[b] << ", expected " << c << endl;
+            rtn = -1;
+            break;
+        }
+        binned += h.counts[b];
+    }
+    if (binned + h.n_nonpositive + h.n_under + h.n_over != nvals || h.n_nonpositive != nzero || h.n_over != none) {
+        cout << "Histogram totals wrong" << endl;
+        rtn = -1;
+    }
+
+    // Quantiles are within the sketch's relative accuracy
+    vector<double> sorted = vals;
+    sort (sorted.begin(), sorted.end());
+    const double qs[] = { 0.0, 0.1, 0.29, 0.31, 0.5, 0.77, 0.9, 0.99, 1.0 };
+    for (double q : qs) {
+        double exact = sorted[(size_t)floor (q * (nvals - 1))];
+        double est = all.sketch.quantile (q);
+        if (fabs (est - exact) > all.sketch.accuracy * exact * (1.0 + 1e-9)) {
+            cout << "Quantile " << q << ": sketch " << est << ", exact " << exact << endl;
+            rtn = -1;
+        }
+    }
+
+    // Merging the shards gives the same summary
+    StreamStats merged = shards[0];
+    for (unsigned int s = 1; s < nshards; ++s) {
+        merged.merge (shards[s]);
+    }
+    if (merged.n != all.n || merged.n_zero != all.n_zero || merged.n_one != all.n_one
+        || merged.hist.counts != all.hist.counts || merged.sketch.buckets != all.sketch.buckets
+        || merged.sketch.offset != all.sketch.offset || merged.min != all.min || merged.max != all.max
+        || fabs (merged.mean() - all.mean()) > 1e-12) {
+        cout << "Merged shards differ from the whole" << endl;
+        rtn = -1;
+    }
+
+    // Keyed histograms merge by adding
+    KeyedHistogram k1 (4), k2 (4);
+    k1.add (0, 0.0);
+    k1.add (3, 1.0);
+    k2.add (9, 0.505);
+    k1.merge (k2);
+    if (k1.counts[0][0] != 1 || k1.counts[3][Stats_Linear_Bins-1] != 1 || k1.counts[3][50] != 1) {
+        cout << "KeyedHistogram wrong" << endl;
+        rtn = -1;
+    }
+
+    if (rtn == 0) {
+        cout << "Streaming summaries are correct" << endl;
+    }
+    return rtn;
+}
@@ -14,6 +14,7 @@
 #include <fstream>
 #include <string>
 #include <iterator>
+#include <unistd.h>
 
 using namespace std;
 
@@ -30,6 +31,29 @@ using namespace std;
 #include "lib.h"
 
 #include "fitness.h"
+#include "genome_archive.h"
+
+/*!
+ * A file made with mkstemp() under /tmp, which is removed when this goes
+ * out of scope, however the test ends.
+ */
+struct TempFile
+{
+    TempFile (const char* stem)
+    {
+        string tmpl = string("/tmp/") + stem + "XXXXXX";
+        vector<char> buf (tmpl.begin(), tmpl.end());
+        buf.push_back ('\0');
+        int fd = mkstemp (buf.data());
+        if (fd < 0) {
+            throw runtime_error ("Failed to make a temporary file for " + tmpl);
+        }
+        close (fd);
+        this->path = buf.data();
+    }
+    ~TempFile() { unlink (this->path.c_str()); }
+    string path;
+};
 
 int main (int argc, char** argv)
 {
@@ -53,6 +77,11 @@ int main (int argc, char** argv)
     unsigned int l_genosect = 1 << N_Ins;
     unsigned int l_genome = N_Genes * l_genosect;
 
+    // The genomes are also written to a genome archive, which is read back at the end
+    TempFile archive_file ("thousand_genomes.bng.");
+    GenomeArchiveWriter archive_out (archive_file.path, true);
+    vector<double> fexpts;
+
     string s("");
     unsigned int count = 0;
     double max_fdiff = 0.0;
@@ -67,9 +96,11 @@ int main (int argc, char** argv)
         }
 
         array<genosect_t, N_Genes> g = str2genome (s);
+        archive_out.append (g);
         double f = evaluate_fitness (g);
         double fexpt = 0.0;
         fin.read((char*)&fexpt, sizeof(double));
+        fexpts.push_back (fexpt);
         cout.precision(12);
         cout << "Computed fitness: " << f << " and expected (from file): " << fexpt << endl;
         double fdiff = abs(f - fexpt);
@@ -82,5 +113,30 @@ int main (int argc, char** argv)
         ++count;
     }
     cout << "Max fitness difference was " << max_fdiff << endl;
+
+    // Now the same genomes from the archive, in reverse order to check random access. The
+    // writer and reader are moved first, which should hand over the open file and the mapping.
+    GenomeArchiveWriter moved_out (std::move (archive_out));
+    moved_out.close();
+    GenomeArchiveReader first_in (archive_file.path);
+    GenomeArchiveReader archive_in;
+    archive_in = std::move (first_in);
+    if (first_in.size() != 0) {
+        cerr << "A moved-from genome archive reader still holds " << first_in.size() << " genomes" << endl;
+        return 1;
+    }
+    if (archive_in.size() != count) {
+        cerr << "The genome archive holds " << archive_in.size() << " genomes, not " << count << endl;
+        return 1;
+    }
+    for (unsigned int i = count; i > 0; --i) {
+        array<genosect_t, N_Genes> g = archive_in.get (i-1);
+        double f = evaluate_fitness (g);
+        if (abs(f - fexpts[i-1]) > 0.000000000000001) {
+            cerr << "Failed on genome number " << (i-1) << " from the archive" << endl;
+            return 1;
+        }
+    }
+    cout << "The " << count << " genomes from the archive have the expected fitnesses" << endl;
     return 0;
 }
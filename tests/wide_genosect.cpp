@@ -0,0 +1,181 @@
+/*
+ * Tests the wide genosects of N_Genes=8 to 10 (and N_Genes=7 with k=n): the
+ * WideGenosect operators against a bitset, compute_next() against the
+ * shift and mask form of the integer genosects, evaluate_fitness()
+ * against the transition table form and the original std::set cycle
+ * detector, the basins of attraction of all 2^N_Genes states and the flip
+ * rate of evolve_genome().
+ */
+
+#include <iostream>
+#include <vector>
+#include <set>
+#include <array>
+#include <bitset>
+#include <math.h>
+
+using namespace std;
+
+#ifndef N_Genes
+# define N_Genes 8
+#endif
+
+#include "lib.h"
+#include "fitness.h"
+#include "basins.h"
+
+//! gs as a bitset
+bitset<Genosect_Width> tobits (const genosect_t& gs)
+{
+    bitset<Genosect_Width> b;
+    for (unsigned int j = 0; j < Genosect_Width; ++j) { b[j] = genosect_bit (gs, j); }
+    return b;
+}
+
+//! compute_next() as written for the integer genosects, using the WideGenosect operators
+void ref_compute_next (const array<genosect_t, N_Genes>& genome, state_t& state)
+{
+    array<state_t, N_Genes> inputs;
+    compute_next_common (state, inputs);
+    state = 0x0;
+    for (unsigned int i = 0; i < N_Genes; ++i) {
+        genosect_t inpit = (GENOSECT_ONE << inputs[i]);
+        if (genome[i] & inpit) {
+            state |= (0x1 << (N_Ins-(i+ExtraOffset)));
+        }
+    }
+}
+
+//! The original evaluate_one(), which found the limit cycle with sets of states
+double ref_evaluate_one (array<genosect_t, N_Genes>& genome, state_t state, state_t target)
+{
+    set<state_t> visited;
+    visited.insert (state);
+    for (;;) {
+        state_t state_last = state;
+        ref_compute_next (genome, state);
+        if (visited.count (state)) {
+            if (state == state_last) {
+                return (state == target) ? 1.0 : 0.0;
+            }
+            set<state_t> lc;
+            while (lc.count (state) == 0) {
+                lc.insert (state);
+                ref_compute_next (genome, state);
+            }
+            array<double, N_Genes> sc;
+            for (unsigned int j = 0; j < N_Genes; ++j) { sc[j] = 0.0; }
+            for (state_t s : lc) {
+                state_t a = (s ^ ~target) & state_mask;
+                for (unsigned int j = 0; j < N_Genes; ++j) { sc[j] += (a >> j) & 0x1; }
+            }
+            double score = pow(static_cast<double>(lc.size()), -N_Genes);
+            for (unsigned int j = 0; j < N_Genes; ++j) { score *= sc[j]; }
+            return score;
+        }
+        visited.insert (state);
+    }
+}
+
+int main()
+{
+    int rtn = 0;
+    masks_init();
+    rngDataInit (&rd);
+    zigset (&rd, DUMMYARG);
+    rd.seed = 4;
+
+    // The operators agree with a bitset of the same width
+    for (unsigned int n = 0; n < 2000 && rtn == 0; ++n) {
+        genosect_t a, b;
+        random_genosect (a, &rd);
+        random_genosect (b, &rd);
+        unsigned int sh = SHR3((&rd)) % (Genosect_Width + 1);
+        bitset<Genosect_Width> ba = tobits (a), bb = tobits (b);
+        if (tobits (a & b) != (ba & bb) || tobits (a | b) != (ba | bb) || tobits (a ^ b) != (ba ^ bb)
+            || tobits (~a) != ~ba || tobits (a << sh) != (ba << sh) || tobits (a >> sh) != (ba >> sh)
+            || (a == b) != (ba == bb) || genosect_popcount (a) != ba.count()
+            || (a < b) != (ba.to_string() < bb.to_string()) || bool(a) != ba.any()) {
+            cout << "WideGenosect operators differ from bitset for " << a << ", " << b << ", shift " << sh << endl;
+            rtn = -1;
+        }
+        genosect_t f = a;
+        genosect_flip (f, sh % Genosect_Width);
+        if (tobits (f) != tobits (a).flip (sh % Genosect_Width)) {
+            cout << "genosect_flip() flipped the wrong bit" << endl;
+            rtn = -1;
+        }
+    }
+
+    const unsigned int nstates = 1 << N_Genes;
+    unsigned int nfit = 0;
+    for (unsigned int n = 0; n < 300 && rtn == 0; ++n) {
+        array<genosect_t, N_Genes> genome;
+        random_genome (genome, &rd);
+
+        state_t succ[1 << N_Genes];
+        for (unsigned int s = 0; s < nstates; ++s) {
+            state_t st = (state_t)s, rst = (state_t)s;
+            compute_next (genome, st);
+            ref_compute_next (genome, rst);
+            if (st != rst) {
+                cout << "compute_next(" << s << ") gives " << (unsigned int)st << " not " << (unsigned int)rst << endl;
+                rtn = -1;
+                break;
+            }
+            succ[s] = st;
+        }
+
+        double f = evaluate_fitness (genome);
+        double rf = ref_evaluate_one (genome, initial_ant, target_ant) * ref_evaluate_one (genome, initial_pos, target_pos);
+        if (f != rf || f != evaluate_fitness_table (succ)) {
+            cout << "Fitness " << f << " differs from the reference " << rf << " or the table's "
+                 << evaluate_fitness_table (succ) << endl;
+            rtn = -1;
+        }
+        if (f > 0.0) { ++nfit; }
+
+        // Every state, including the top bit alone, is in exactly one basin
+        if (n < 20) {
+            AllBasins ab (genome);
+            size_t nnodes = 0;
+            for (auto& b : ab.basins) { nnodes += b.nodes.size(); }
+            if (nnodes != nstates || ab.transitions.size() != nstates) {
+                cout << "The basins hold " << nnodes << " states and " << ab.transitions.size()
+                     << " transitions, not " << nstates << endl;
+                rtn = -1;
+            }
+            for (unsigned int s = 0; s < nstates; ++s) {
+                if (ab.find ((state_t)s).nodes.count ((state_t)s) == 0) {
+                    cout << "State " << s << " is in no basin" << endl;
+                    rtn = -1;
+                    break;
+                }
+            }
+        }
+    }
+
+    // evolve_genome() flips each bit with probability pOn
+    pOn = 0.01;
+    unsigned long long int flips = 0;
+    const unsigned int nevolve = 2000;
+    for (unsigned int n = 0; n < nevolve; ++n) {
+        array<genosect_t, N_Genes> g, g0;
+        random_genome (g, &rd);
+        g0 = g;
+        evolve_genome (g, &rd);
+        flips += compute_hamming (g, g0);
+    }
+    const double nbits = (double)nevolve * N_Genes * Genosect_Width;
+    const double expected = nbits * pOn;
+    if (fabs ((double)flips - expected) > 5.0 * sqrt (expected * (1.0 - pOn))) {
+        cout << flips << " bits flipped, expected " << expected << endl;
+        rtn = -1;
+    }
+
+    if (rtn == 0) {
+        cout << "Wide genosects for N_Genes=" << N_Genes << ", N_Ins=" << N_Ins << " are correct ("
+             << nfit << " of 300 random genomes had F>0)" << endl;
+    }
+    return rtn;
+}